@@ -224,6 +224,18 @@ set (CORECRYPTO_SRCS
     ccmode/src/ccmode_factory_siv_hmac_encrypt.c
     ccaes/src/ccaes_xts_decrypt_mode.c
     ccaes/src/ccaes_xts_encrypt_mode.c
+    ccaes/src/bitslice/ccaes_bitslice.c
+    ccaes/src/bitslice/ccaes_bitslice_ecb_encrypt_mode.c
+    ccaes/src/bitslice/ccaes_bitslice_ecb_decrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_ecb_encrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_ecb_decrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_cbc_encrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_cbc_decrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_ctr_crypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_xts_encrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_xts_decrypt_mode.c
+    ccaes/src/aesni/ccaes_aesni_vaes.c
+    ccaes/src/aesni/ccaes_aesni_gcm.c
     ccsrp/src/ccsrp_generate_K_from_S.c
     ccdh/src/ccdh_init_gp_with_order.c
     ccblowfish/src/ccblowfish_constructed_modes.c
@@ -286,6 +298,7 @@ set (CORECRYPTO_SRCS
     ccdh/src/ccdh_ramp_gp_exponent.c
     ccvrf/src/ccvrf_codec.c
     ccscrypt/src/ccscrypt.c
+    ccscrypt/src/ccscrypt_sse2.c
     ccder/src/ccder_decode_eckey.c
     ccder/src/ccder_sizeof_integer.c
     ccder/src/ccder_sizeof_len.c
@@ -417,6 +430,8 @@ set (CORECRYPTO_SRCS
     cchmac/src/cchmac_final.c
     ccn/src/ccn_addmul1.c
     cchmac/src/cchmac_init.c
+    cchmac/src/cchmac_init_prepared.c
+    cchmac/src/cchmac_key_prepare.c
     ccaes/src/intel/ccaes_intel_cbc_encrypt_mode.c
     ccaes/src/arm64/ccm-encrypt.s
     ccecies/src/ccecies_pub_key_size.c
@@ -457,6 +472,7 @@ set (CORECRYPTO_SRCS
     ccmode/src/ccmode_gcm_encrypt.c
     ccmode/src/ccmode_gcm_finalize.c
     ccmode/src/ccmode_gcm_gf_mult.c
+    ccmode/src/ccmode_gcm_ghash_clmul.c
     ccrng/src/ccrng_sequence.c
     ccn/src/ccn_cmpn.c
     ccn/src/intel/ccn_shift_right.s
@@ -661,11 +677,13 @@ set (CORECRYPTO_SRCS
     ccecies/src/ccecies_decrypt_gcm_from_shared_secret.c
     cccmac/src/cccmac_generate_subkey.c
     ccsha1/src/ccsha1.c
+    ccsha1/src/ccsha1_avx2.c
     ccsha1/src/ccsha1_eay.c
     ccn/src/ccn_invmod.c
     ccsha1/src/ccsha1_initial_state.c
     ccmode/src/ccmode_xts_key_sched.c
     ccsha1/src/ccsha1_ltc.c
+    ccsha1/src/ccsha1_shani.c
     ccsha1/src/ccsha1_vng_arm.c
     ccsha2/src/ccsha512_256_ltc_di.c
     ccspake/src/ccspake_cp256.c
@@ -680,6 +698,8 @@ set (CORECRYPTO_SRCS
     ccec25519/src/cced25519_make_key_pair.c
     ccaes/src/arm64/ghash-arm64.s
     ccsha2/src/ccsha224_ltc_di.c
+    ccsha2/src/ccsha224_avx2_di.c
+    ccsha2/src/ccsha224_shani_di.c
     acceleratecrypto/Source/sha512/arm64/sha512_compress_arm64hw.s
     acceleratecrypto/Source/sha1/arm64/sha1_compress_arm64.s
     ccsha2/src/ccsha224_vng_arm_di.c
@@ -692,8 +712,17 @@ set (CORECRYPTO_SRCS
     ccsha2/src/ccsha256_ltc_compress.c
     ccdh/src/ccdh_lookup_gp.c
     ccsha2/src/ccsha256_ltc_di.c
+    ccsha2/src/ccsha256_avx2_compress.c
+    ccsha2/src/ccsha256_avx2_di.c
+    ccsha2/src/ccsha256_shani_compress.c
+    ccsha2/src/ccsha256_shani_di.c
+    ccsha2/src/ccsha2_multi_avx.c
+    ccsha2/src/ccdigest_multi.c
     ccsha2/src/ccsha256_vng_armv7neon_compress.s
     ccmode/src/ccgcm_one_shot.c
+    ccmode/src/ccgcm_one_shot_parallel.c
+    ccmode/src/ccgcm_iov.c
+    ccmode/src/ccgcm_batch.c
     acceleratecrypto/Source/aes/arm/decrypt.s
     ccsha2/src/ccsha256_vng_arm_di.c
     cch2c/src/cch2c.c
@@ -746,6 +775,7 @@ set (CORECRYPTO_SRCS
     ccwrap/src/ccwrap_auth_decrypt_withiv.c
     acceleratecrypto/Source/aes/arm64/encrypt.s
     ccmode/src/ccgcm_inc_iv.c
+    ccmode/src/ccgcm_aad_snapshot.c
     ccmode/src/ccmode_factory_gcm_encrypt.c
     ccz/src/ccz_lsl.c
     ccnistkdf/src/ccnistkdf_ctr_cmac.c
@@ -774,6 +804,8 @@ set (CORECRYPTO_SRCS
     ccwrap/src/ccwrap_auth_encrypt_withiv.c
     ccz/src/ccz_read_uint.c
     cc/src/cc_clear.c
+    cc/src/cc_iovec_crypt.c
+    cc/src/cc_iovec_nbytes.c
     ccn/src/ccn_cond_add.c
     acceleratecrypto/Source/sha512/intel/sha512_compress_avx1.s
     ccsha2/src/ccsha256_vng_intel_avx1_compress.s
@@ -814,6 +846,7 @@ set (CORECRYPTO_SRCS
     ccaes/src/arm64/cfb-decrypt-arm64.s
     ccec/src/ccec_generate_scalar_pka.c
     cczp/src/cczp_mm.c
+    cczp/src/cczp_mm_adx.c
     cczp/src/cczp_mul.c
     ccn/src/arm/ccn_mulmod_256-arm64.s
     cczp/src/cczp_power.c
@@ -873,6 +906,7 @@ set (CORECRYPTO_SRCS
     ccrng/src/ccrng_ecfips_test.c
     ccmode/src/ccmode_ccm_init.c
     acceleratecrypto/Source/sha512/intel/sha512_compress.c
+    ccchacha20poly1305/src/ccchacha20_avx.c
     ccchacha20poly1305/src/ccchacha20poly1305.c
     ccaes/src/arm/ccm-encrypt-armv7.s
     ccaes/src/ios_mux/ccaes_ios_mux_ctr_crypt_mode.c
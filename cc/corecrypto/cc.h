@@ -139,6 +139,53 @@ void cc_xor(size_t size, void *r, const void *s, const void *t) {
     }
 }
 
+/*!
+ @struct cc_iovec
+ @abstract One fragment of a scatter-gather buffer.
+ @field base Start of the fragment
+ @field nbytes Length of the fragment in bytes
+ @discussion Functions taking an array of fragments process them in order,
+ as if they were a single contiguous buffer. Zero-length fragments are
+ allowed.
+ */
+struct cc_iovec {
+    void *base;
+    size_t nbytes;
+};
+
+/*!
+ @struct cc_const_iovec
+ @abstract One fragment of a scatter-gather buffer that is only read.
+ @field base Start of the fragment
+ @field nbytes Length of the fragment in bytes
+ @discussion The read-only counterpart of struct cc_iovec, for input
+ fragments.
+ */
+struct cc_const_iovec {
+    const void *base;
+    size_t nbytes;
+};
+
+/*!
+ @brief cc_iovec_nbytes(niov, iov, nbytes) computes the total length of a scatter-gather buffer.
+ @param niov   number of fragments
+ @param iov    fragments
+ @param nbytes total length in bytes, on success
+ @return CCERR_OK, or CCERR_OVERFLOW if the total does not fit in a size_t.
+ */
+CC_NONNULL((3))
+int cc_iovec_nbytes(size_t niov, const struct cc_iovec *iov, size_t *nbytes);
+
+/*!
+ @brief cc_const_iovec_nbytes(niov, iov, nbytes) is cc_iovec_nbytes for read-only fragments.
+ @param niov   number of fragments
+ @param iov    fragments
+ @param nbytes total length in bytes, on success
+ @return CCERR_OK, or CCERR_OVERFLOW if the total does not fit in a size_t.
+ */
+CC_NONNULL((3))
+int cc_const_iovec_nbytes(size_t niov, const struct cc_const_iovec *iov, size_t *nbytes);
+
 /*!
  @brief cc_cmp_safe(num, pt1, pt2) compares two array ptr1 and ptr2 of num bytes.
  @discussion The execution time/cycles is independent of the data and therefore guarantees no leak about the data. However, the execution time depends on num.
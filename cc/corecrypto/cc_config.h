@@ -321,6 +321,12 @@
 #define CCEC25519_CURVE25519_64BIT 0
 #endif
 
+#if (CCN_UNIT_SIZE == 8) && !( defined(_MSC_VER) && defined(__clang__))
+#define CCPOLY1305_64BIT 1
+#else
+#define CCPOLY1305_64BIT 0
+#endif
+
 //- functions implemented in assembly ------------------------------------------
 //this the list of corecrypto clients that use assembly and the clang compiler
 #if !(CC_DARWIN || CC_KERNEL || CC_USE_L4 || CC_IBOOT || CC_RTKIT || CC_RTKITROM || CC_USE_SEPROM || CC_USE_S3) && !defined(_WIN32) && CORECRYPTO_DEBUG
@@ -342,7 +348,26 @@
  #endif
 #endif
 
-#define CC_CACHE_DESCRIPTORS CC_KERNEL
+// Environments where corecrypto may use POSIX threads.
+#if CC_KERNEL || CC_USE_L4 || CC_RTKIT || CC_RTKITROM || CC_USE_SEPROM || CC_USE_S3 || \
+    CC_BASEBAND || CC_EFI || CC_IBOOT || defined(_WIN32)
+#define CC_PTHREADS 0
+#else
+#define CC_PTHREADS 1
+#endif
+
+// Environments with threads serialize the first use of a descriptor with
+// pthread_once(); elsewhere CC_DESCRIPTOR_ONCE() uses C11 atomics.
+#define CC_DESCRIPTORS_PTHREAD_ONCE CC_PTHREADS
+
+// Mode descriptors built at runtime (e.g. ccaes_gcm_encrypt_mode()) are
+// built on first use and then cached; see CC_DESCRIPTOR_ONCE(). Toolchains
+// with neither pthreads nor C11 atomics rebuild them on every call.
+#if CC_DESCRIPTORS_PTHREAD_ONCE || (defined(__STDC_VERSION__) && !defined(__STDC_NO_ATOMICS__))
+#define CC_CACHE_DESCRIPTORS 1
+#else
+#define CC_CACHE_DESCRIPTORS 0
+#endif
 
 //-(1) ARM V7
 #if defined(_ARM_ARCH_7) && __clang__ && CC_USE_ASM
@@ -506,6 +531,72 @@
 
 #endif
 
+// AES-NI through compiler intrinsics, for x86_64 Linux builds where the
+// Intel assembly is disabled. Selected at runtime with CC_HAS_AESNI().
+#if defined(__x86_64__) && CC_LINUX && !CC_KERNEL && !CCAES_INTEL_ASM
+ #define CCAES_AESNI_INTRINSICS 1
+#else
+ #define CCAES_AESNI_INTRINSICS 0
+#endif
+
+// x86_64 code built with GCC or clang outside of the kernel, EFI and iBoot,
+// where the SIMD kernels below can use compiler intrinsics, target
+// attributes and GNU inline assembly, and save vector registers freely.
+#if defined(__x86_64__) && defined(__GNUC__) && !CC_KERNEL && !CC_EFI && !CC_IBOOT
+ #define CC_X86_64_USERSPACE_SIMD 1
+#else
+ #define CC_X86_64_USERSPACE_SIMD 0
+#endif
+
+// AVX2 and AVX-512 ChaCha20 kernels and the AVX2 Poly1305 kernel through
+// compiler intrinsics. Selected at runtime with CC_HAS_AVX2() and CC_HAS_AVX512F().
+#if CC_X86_64_USERSPACE_SIMD
+ #define CCCHACHA20_AVX_INTRINSICS 1
+#else
+ #define CCCHACHA20_AVX_INTRINSICS 0
+#endif
+
+// SHA-1 and SHA-256 compression with the SHA extensions (SHA-NI) through
+// compiler intrinsics. Selected at runtime with CC_HAS_SHA_NI().
+#if CC_X86_64_USERSPACE_SIMD
+ #define CCSHA_SHANI_INTRINSICS 1
+#else
+ #define CCSHA_SHANI_INTRINSICS 0
+#endif
+
+// SHA-1 and SHA-256 compression with the message schedule of two blocks in
+// AVX2 registers, for hosts without SHA-NI where the Intel assembly is not
+// built. Selected at runtime with CC_HAS_AVX2().
+#if CC_X86_64_USERSPACE_SIMD && !CCSHA1_VNG_INTEL && !CCSHA2_VNG_INTEL
+ #define CCSHA_AVX2_INTRINSICS 1
+#else
+ #define CCSHA_AVX2_INTRINSICS 0
+#endif
+
+// Multi-buffer SHA-256 and SHA-512 kernels for ccdigest_multi() through
+// compiler intrinsics. Selected at runtime with CC_HAS_AVX2() and CC_HAS_AVX512F().
+#if CC_X86_64_USERSPACE_SIMD
+ #define CCSHA2_MULTI_INTRINSICS 1
+#else
+ #define CCSHA2_MULTI_INTRINSICS 0
+#endif
+
+// SSE2 scrypt ROMix through compiler intrinsics. SSE2 is part of x86_64, so
+// there is no runtime check.
+#if CC_X86_64_USERSPACE_SIMD
+ #define CCSCRYPT_SSE2_INTRINSICS 1
+#else
+ #define CCSCRYPT_SSE2_INTRINSICS 0
+#endif
+
+// Montgomery multiplication and squaring with MULX/ADCX/ADOX in GNU inline
+// assembly. Selected at runtime with CC_HAS_BMI2() and CC_HAS_ADX().
+#if CC_X86_64_USERSPACE_SIMD
+ #define CCZP_MM_ADX_ASM 1
+#else
+ #define CCZP_MM_ADX_ASM 0
+#endif
+
 #define CC_INLINE static inline
 
 #ifdef __GNUC__
@@ -9,8 +9,66 @@
  * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
  */
 
+#ifndef _CORECRYPTO_CC_INTERNAL_H_
+#define _CORECRYPTO_CC_INTERNAL_H_
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <corecrypto/cc_priv.h>
 
 extern bool cc_rdrand(uint64_t *rand);
+
+#if CC_DESCRIPTORS_PTHREAD_ONCE
+#include <pthread.h>
+#elif CC_CACHE_DESCRIPTORS
+#include <stdatomic.h>
+#endif
+
+/* Run _init_, a void (void) function filling in a static descriptor,
+ the first time this is reached. Later calls, including concurrent ones,
+ see the fully built descriptor and don't write to it again.
+
+ Without pthreads, the first caller moves the state from 0 to 1 with a
+ compare-and-swap, builds the descriptor and publishes it by storing 2
+ with release semantics. Concurrent callers spin until they observe 2
+ with an acquire load. */
+#if !CC_CACHE_DESCRIPTORS
+#define CC_DESCRIPTOR_ONCE(_init_) _init_()
+#elif CC_DESCRIPTORS_PTHREAD_ONCE
+#define CC_DESCRIPTOR_ONCE(_init_)                                  \
+    do {                                                            \
+        static pthread_once_t _init_##_once = PTHREAD_ONCE_INIT;    \
+        pthread_once(&_init_##_once, _init_);                       \
+    } while (0)
+#else
+#define CC_DESCRIPTOR_ONCE(_init_)                                                      \
+    do {                                                                                \
+        static _Atomic(int) _init_##_state = 0;                                         \
+        if (atomic_load_explicit(&_init_##_state, memory_order_acquire) != 2) {         \
+            int _init_##_expected = 0;                                                  \
+            if (atomic_compare_exchange_strong_explicit(&_init_##_state,                \
+                                                        &_init_##_expected, 1,          \
+                                                        memory_order_acquire,           \
+                                                        memory_order_acquire)) {        \
+                _init_();                                                               \
+                atomic_store_explicit(&_init_##_state, 2, memory_order_release);        \
+            } else {                                                                    \
+                while (atomic_load_explicit(&_init_##_state, memory_order_acquire) != 2) { \
+                }                                                                       \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+#endif
+
+/* Process nbytes of in into out. Used by cc_iovec_crypt(). */
+typedef int (*cc_iovec_crypt_fn)(void *crypt_ctx, size_t nbytes, const void *in, void *out);
+
+/* Walk the input and output fragments in step, handing each run that is
+ contiguous on both sides to crypt. Partial blocks at fragment boundaries
+ are left to crypt_ctx to carry. Returns CCERR_OVERFLOW or CCERR_PARAMETER
+ if the totals overflow or differ, or the first nonzero result of crypt. */
+int cc_iovec_crypt(size_t in_niov, const struct cc_const_iovec *in,
+                   size_t out_niov, const struct cc_iovec *out,
+                   cc_iovec_crypt_fn crypt, void *crypt_ctx);
+
+#endif /* _CORECRYPTO_CC_INTERNAL_H_ */
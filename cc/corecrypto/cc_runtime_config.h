@@ -20,30 +20,43 @@
     #include <i386/cpuid.h>
     #define CC_HAS_RDRAND() ((cpuid_features() & CPUID_FEATURE_RDRAND) != 0)
     #define CC_HAS_AESNI() ((cpuid_features() & CPUID_FEATURE_AES) != 0)
+    #define CC_HAS_PCLMUL() ((cpuid_features() & CPUID_FEATURE_PCLMULQDQ) != 0)
     #define CC_HAS_SupplementalSSE3() ((cpuid_features() & CPUID_FEATURE_SSSE3) != 0)
     #define CC_HAS_AVX1() ((cpuid_features() & CPUID_FEATURE_AVX1_0) != 0)
     #define CC_HAS_AVX2() ((cpuid_info()->cpuid_leaf7_features & CPUID_LEAF7_FEATURE_AVX2) != 0)
     #define CC_HAS_AVX512_AND_IN_KERNEL()    ((cpuid_info()->cpuid_leaf7_features & CPUID_LEAF7_FEATURE_AVX512F) !=0)
+    #define CC_HAS_AVX512F() CC_HAS_AVX512_AND_IN_KERNEL()
+    #define CC_HAS_AVX512_VAES() 0
     #define CC_HAS_BMI2() ((cpuid_info()->cpuid_leaf7_features & CPUID_LEAF7_FEATURE_BMI2) != 0)
     #define CC_HAS_ADX() ((cpuid_info()->cpuid_leaf7_features & CPUID_LEAF7_FEATURE_ADX) != 0)
+    #define CC_HAS_SHA_NI() 0
 
 #elif CC_DARWIN && CC_INTERNAL_SDK
     #include <System/i386/cpu_capabilities.h>
     #define CC_HAS_RDRAND() (_get_cpu_capabilities() & kHasRDRAND)
     #define CC_HAS_AESNI() (_get_cpu_capabilities() & kHasAES)
+    #define CC_HAS_PCLMUL() (_get_cpu_capabilities() & kHasAES) // All AES-NI capable Macs have PCLMULQDQ
     #define CC_HAS_SupplementalSSE3() (_get_cpu_capabilities() & kHasSupplementalSSE3)
     #define CC_HAS_AVX1() (_get_cpu_capabilities() & kHasAVX1_0)
     #define CC_HAS_AVX2() (_get_cpu_capabilities() & kHasAVX2_0)
     #define CC_HAS_AVX512_AND_IN_KERNEL() 0
+    #define CC_HAS_AVX512F() (_get_cpu_capabilities() & kHasAVX512F)
+    #define CC_HAS_AVX512_VAES() 0
     #define CC_HAS_BMI2() (_get_cpu_capabilities() & kHasBMI2)
     #define CC_HAS_ADX() (_get_cpu_capabilities() & kHasADX)
+    #define CC_HAS_SHA_NI() 0
 
 #else
     #define CC_HAS_AESNI() __builtin_cpu_supports("aes")
+    #define CC_HAS_PCLMUL() __builtin_cpu_supports("pclmul")
     #define CC_HAS_SupplementalSSE3() __builtin_cpu_supports("ssse3")
     #define CC_HAS_AVX1() __builtin_cpu_supports("avx")
     #define CC_HAS_AVX2() __builtin_cpu_supports("avx2")
     #define CC_HAS_AVX512_AND_IN_KERNEL() 0
+    #define CC_HAS_AVX512F() __builtin_cpu_supports("avx512f")
+    // 512-bit VAES and VPCLMULQDQ, with the AVX-512 state enabled by the OS
+    #define CC_HAS_AVX512_VAES() (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && \
+                                  __builtin_cpu_supports("vaes") && __builtin_cpu_supports("vpclmulqdq"))
     #define CC_HAS_BMI2() __builtin_cpu_supports("bmi2")
 #if CC_LINUX || !CC_INTERNAL_SDK
     #include <cpuid.h>
@@ -63,11 +76,20 @@
         return ebx & bit_ADX;
     }
 
+    CC_INLINE bool _cpu_supports_sha()
+    {
+        unsigned int eax, ebx, ecx, edx;
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        return ebx & bit_SHA;
+    }
+
     #define CC_HAS_RDRAND() _cpu_supports_rdrand()
     #define CC_HAS_ADX() _cpu_supports_adx()
+    #define CC_HAS_SHA_NI() _cpu_supports_sha()
 #else
     #define CC_HAS_RDRAND() 0
     #define CC_HAS_ADX() 0
+    #define CC_HAS_SHA_NI() 0
 #endif
 
 #endif
@@ -298,6 +298,28 @@ HEAVISIDE_STEP_Tests(void)
     ok(err + (64+32+16+8)-nb_test==0, "CC HEAVISIDE_STEP test failed");
 }
 
+static void
+iovec_nbytes_Tests(void)
+{
+    struct cc_iovec iov[3] = { { NULL, 5 }, { NULL, 0 }, { NULL, 11 } };
+    size_t nbytes = 1;
+
+    ok(cc_iovec_nbytes(0, iov, &nbytes) == CCERR_OK && nbytes == 0, "No fragments");
+    ok(cc_iovec_nbytes(3, iov, &nbytes) == CCERR_OK && nbytes == 16, "Three fragments");
+
+    iov[0].nbytes = SIZE_MAX - 11;
+    ok(cc_iovec_nbytes(3, iov, &nbytes) == CCERR_OK && nbytes == SIZE_MAX, "Total of SIZE_MAX");
+
+    iov[1].nbytes = 1;
+    ok(cc_iovec_nbytes(3, iov, &nbytes) == CCERR_OVERFLOW, "Overflow");
+
+    struct cc_const_iovec in[2] = { { "abc", 3 }, { NULL, SIZE_MAX - 3 } };
+    ok(cc_const_iovec_nbytes(2, in, &nbytes) == CCERR_OK && nbytes == SIZE_MAX, "Read-only total of SIZE_MAX");
+
+    in[1].nbytes += 1;
+    ok(cc_const_iovec_nbytes(2, in, &nbytes) == CCERR_OVERFLOW, "Read-only overflow");
+}
+
 static void
 cmp_secure_functionalTests(void) {
 #define ARRAY_SIZE 10
@@ -544,7 +566,7 @@ memcmp_secure_securityTests(void) {
 
 int cc_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 {
-    int num_tests = 36 + kPlan_ccSecurityTestNb;
+    int num_tests = 42 + kPlan_ccSecurityTestNb;
     num_tests += 292 + 2 * CLZ_RANDOM_TESTS; // clz_tests
     num_tests += 292 + 2 * CTZ_RANDOM_TESTS; // ctz_tests
     num_tests += 294 + 2 * FFS_RANDOM_TESTS; // ffs_tests
@@ -577,6 +599,9 @@ int cc_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     if(verbose) diag("Rotate test");
     Rotate_Tests();
 
+    if(verbose) diag("Scatter-gather length test");
+    iovec_nbytes_Tests();
+
     if(verbose) diag("Secure comparison test");
     cmp_secure_functionalTests();
 
@@ -0,0 +1,57 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/cc_priv.h>
+#include <corecrypto/cc_macros.h>
+#include "cc_internal.h"
+
+int cc_iovec_crypt(size_t in_niov, const struct cc_const_iovec *in,
+                   size_t out_niov, const struct cc_iovec *out,
+                   cc_iovec_crypt_fn crypt, void *crypt_ctx)
+{
+    size_t in_nbytes, out_nbytes;
+    size_t i = 0, in_offset = 0;
+    size_t j = 0, out_offset = 0;
+    int rc;
+
+    rc = cc_const_iovec_nbytes(in_niov, in, &in_nbytes);
+    cc_require(rc == CCERR_OK, errOut);
+    rc = cc_iovec_nbytes(out_niov, out, &out_nbytes);
+    cc_require(rc == CCERR_OK, errOut);
+    rc = CCERR_PARAMETER;
+    cc_require(in_nbytes == out_nbytes, errOut);
+
+    while (i < in_niov && j < out_niov) {
+        size_t n = CC_MIN(in[i].nbytes - in_offset, out[j].nbytes - out_offset);
+
+        if (n > 0) {
+            rc = crypt(crypt_ctx, n, (const uint8_t *)in[i].base + in_offset, (uint8_t *)out[j].base + out_offset);
+            cc_require(rc == 0, errOut);
+        }
+
+        in_offset += n;
+        out_offset += n;
+
+        if (in_offset == in[i].nbytes) {
+            i++;
+            in_offset = 0;
+        }
+        if (out_offset == out[j].nbytes) {
+            j++;
+            out_offset = 0;
+        }
+    }
+
+    rc = CCERR_OK;
+
+errOut:
+    return rc;
+}
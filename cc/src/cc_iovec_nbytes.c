@@ -0,0 +1,40 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/cc_priv.h>
+
+int cc_iovec_nbytes(size_t niov, const struct cc_iovec *iov, size_t *nbytes)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < niov; i++) {
+        if (cc_add_overflow(total, iov[i].nbytes, &total)) {
+            return CCERR_OVERFLOW;
+        }
+    }
+
+    *nbytes = total;
+    return CCERR_OK;
+}
+
+int cc_const_iovec_nbytes(size_t niov, const struct cc_const_iovec *iov, size_t *nbytes)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < niov; i++) {
+        if (cc_add_overflow(total, iov[i].nbytes, &total)) {
+            return CCERR_OVERFLOW;
+        }
+    }
+
+    *nbytes = total;
+    return CCERR_OK;
+}
@@ -25,6 +25,9 @@
 extern const struct ccmode_ecb ccaes_ltc_ecb_decrypt_mode;
 extern const struct ccmode_ecb ccaes_ltc_ecb_encrypt_mode;
 
+extern const struct ccmode_ecb ccaes_bitslice_ecb_decrypt_mode;
+extern const struct ccmode_ecb ccaes_bitslice_ecb_encrypt_mode;
+
 extern const struct ccmode_cbc ccaes_gladman_cbc_encrypt_mode;
 extern const struct ccmode_cbc ccaes_gladman_cbc_decrypt_mode;
 
@@ -81,6 +84,19 @@ extern const struct ccmode_xts ccaes_intel_xts_decrypt_opt_mode;
 extern const struct ccmode_xts ccaes_intel_xts_decrypt_aesni_mode;
 #endif
 
+#if CCAES_AESNI_INTRINSICS
+extern const struct ccmode_ecb ccaes_aesni_ecb_encrypt_mode;
+extern const struct ccmode_ecb ccaes_aesni_ecb_decrypt_mode;
+
+extern const struct ccmode_cbc ccaes_aesni_cbc_encrypt_mode;
+extern const struct ccmode_cbc ccaes_aesni_cbc_decrypt_mode;
+
+extern const struct ccmode_ctr ccaes_aesni_ctr_crypt_mode;
+
+extern const struct ccmode_xts ccaes_aesni_xts_encrypt_mode;
+extern const struct ccmode_xts ccaes_aesni_xts_decrypt_mode;
+#endif
+
 #if CC_USE_L4
 extern const struct ccmode_cbc ccaes_skg_cbc_encrypt_mode;
 extern const struct ccmode_cbc ccaes_skg_cbc_decrypt_mode;
@@ -533,6 +533,11 @@ static void testAES_ECB_LTC(void)
     ecb("ltc", &ccaes_ltc_ecb_encrypt_mode, &ccaes_ltc_ecb_decrypt_mode);
 }
 
+static void testAES_ECB_BITSLICE(void)
+{
+    ecb("bitslice", &ccaes_bitslice_ecb_encrypt_mode, &ccaes_bitslice_ecb_decrypt_mode);
+}
+
 
 #if CCAES_INTEL_ASM
 static void testAES_ECB_INTEL_Opt(void)
@@ -697,6 +702,7 @@ void aes_validation_test(void)
     testAES_GCM_Factory();
     testAES_ECB();
     testAES_ECB_LTC();
+    testAES_ECB_BITSLICE();
     testAES_XTS();
     testAES_XTS_Factory();
     testAES_CCM();
@@ -24,7 +24,7 @@ entryPoint(ccaes_modes_tests,"ccaes mode")
 #else
 #include "crypto_test_modes.h"
 
-static int kTestTestCount = 118461 /* base */
+static int kTestTestCount = 125682 /* base */
 #if     CCAES_INTEL_ASM
         + 50993;
 #elif   CCAES_MUX
@@ -57,11 +57,19 @@ int ccaes_modes_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     ccmode_factory_xts_encrypt(&ccaes_generic_ltc_xts_encrypt_mode, &ccaes_ltc_ecb_encrypt_mode,  &ccaes_ltc_ecb_encrypt_mode);
     ccmode_factory_xts_decrypt(&ccaes_generic_ltc_xts_decrypt_mode, &ccaes_ltc_ecb_decrypt_mode,  &ccaes_ltc_ecb_encrypt_mode);
 
+    struct ccmode_ctr ccaes_bitslice_ctr_crypt_mode;
+    ccmode_factory_ctr_crypt(&ccaes_bitslice_ctr_crypt_mode, &ccaes_bitslice_ecb_encrypt_mode);
+
     static struct ccmode_gcm ccaes_generic_ltc_gcm_encrypt_mode;
     static struct ccmode_gcm ccaes_generic_ltc_gcm_decrypt_mode;
     ccmode_factory_gcm_encrypt(&ccaes_generic_ltc_gcm_encrypt_mode, &ccaes_ltc_ecb_encrypt_mode);
     ccmode_factory_gcm_decrypt(&ccaes_generic_ltc_gcm_decrypt_mode, &ccaes_ltc_ecb_encrypt_mode);
 
+    static struct ccmode_gcm ccaes_bitslice_gcm_encrypt_mode;
+    static struct ccmode_gcm ccaes_bitslice_gcm_decrypt_mode;
+    ccmode_factory_gcm_encrypt(&ccaes_bitslice_gcm_encrypt_mode, &ccaes_bitslice_ecb_encrypt_mode);
+    ccmode_factory_gcm_decrypt(&ccaes_bitslice_gcm_decrypt_mode, &ccaes_bitslice_ecb_encrypt_mode);
+
     static struct ccmode_ccm ccaes_generic_ltc_ccm_encrypt_mode;
     static struct ccmode_ccm ccaes_generic_ltc_ccm_decrypt_mode;
     ccmode_factory_ccm_encrypt(&ccaes_generic_ltc_ccm_encrypt_mode, &ccaes_ltc_ecb_encrypt_mode);
@@ -75,6 +83,12 @@ int ccaes_modes_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 #if CCAES_INTEL_ASM
     if(CC_HAS_AESNI()) kTestTestCount+=69;
 #endif
+#if CCAES_AESNI_INTRINSICS
+    if(CC_HAS_AESNI()) kTestTestCount+=115;
+#endif
+#if !CCMODE_GCM_VNG_SPEEDUP
+    kTestTestCount+=2; // GHASH table check in each test_gcm() call
+#endif
 #if CCAES_MUX
     if (ccaes_ios_hardware_enabled(CCAES_HW_CTR)) kTestTestCount+=46;
     if (ccaes_ios_hardware_enabled(CCAES_HW_CBC)) kTestTestCount+=49;
@@ -101,6 +115,10 @@ int ccaes_modes_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     ok(test_hmac_mode((ciphermode_t)ccaes_siv_hmac_sha256_encrypt_mode(), (ciphermode_t)ccaes_siv_hmac_sha256_decrypt_mode(), cc_cipherAES, cc_ModeSIV_HMAC, cc_digestSHA256) == 1, "Generic AES-SIV-HMAC");
     ok(test_mode((ciphermode_t)ccaes_siv_encrypt_mode(), (ciphermode_t)ccaes_siv_decrypt_mode(), cc_cipherAES, cc_ModeSIV) == 1, "Generic AES-SIV");
     ok(test_mode((ciphermode_t) &ccaes_ltc_ecb_encrypt_mode, (ciphermode_t) &ccaes_ltc_ecb_decrypt_mode, cc_cipherAES, cc_ModeECB) == 1, "Standard LTC AES for ECB");
+    ok(test_mode((ciphermode_t) &ccaes_bitslice_ecb_encrypt_mode, (ciphermode_t) &ccaes_bitslice_ecb_decrypt_mode, cc_cipherAES, cc_ModeECB) == 1, "Bitsliced AES for ECB");
+    test_ctr("Bitsliced AES-CTR", &ccaes_bitslice_ctr_crypt_mode, &ccaes_bitslice_ctr_crypt_mode, aes_ctr_vectors);
+    ok(test_mode((ciphermode_t) (const struct ccmode_gcm *) &ccaes_bitslice_gcm_encrypt_mode,
+                 (ciphermode_t) (const struct ccmode_gcm *) &ccaes_bitslice_gcm_decrypt_mode, cc_cipherAES, cc_ModeGCM) == 1, "Bitsliced AES-GCM");
     ok(test_mode((ciphermode_t) &ccaes_gladman_cbc_encrypt_mode, (ciphermode_t) &ccaes_gladman_cbc_decrypt_mode, cc_cipherAES, cc_ModeCBC) == 1, "Standard LTC AES for CBC");
 #if 0 // CCAES_ARM_ASM
     ok(test_mode((ciphermode_t) &ccaes_arm_ecb_encrypt_mode, (ciphermode_t) &ccaes_arm_ecb_decrypt_mode, cc_cipherAES, cc_ModeECB) == 1, "arm VNG AES for ECB");
@@ -117,6 +135,15 @@ int ccaes_modes_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
         ok(test_mode((ciphermode_t) &ccaes_intel_xts_encrypt_aesni_mode, (ciphermode_t) &ccaes_intel_xts_decrypt_aesni_mode, cc_cipherAES, cc_ModeXTS) == 1, "Intel AES-NI AES-XTS");
         ok(test_xts(&ccaes_intel_xts_encrypt_aesni_mode, &ccaes_intel_xts_decrypt_aesni_mode), "Intel AES-NI AES-XTS Extended testing");
     }
+#endif
+#if CCAES_AESNI_INTRINSICS
+    if(CC_HAS_AESNI()) {
+        test_ctr("AES-NI intrinsics AES-CTR", &ccaes_aesni_ctr_crypt_mode, &ccaes_aesni_ctr_crypt_mode, aes_ctr_vectors);
+        ok(test_mode((ciphermode_t) &ccaes_aesni_ecb_encrypt_mode, (ciphermode_t) &ccaes_aesni_ecb_decrypt_mode, cc_cipherAES, cc_ModeECB) == 1, "AES-NI intrinsics AES-ECB");
+        ok(test_mode((ciphermode_t) &ccaes_aesni_cbc_encrypt_mode, (ciphermode_t) &ccaes_aesni_cbc_decrypt_mode, cc_cipherAES, cc_ModeCBC) == 1, "AES-NI intrinsics AES-CBC");
+        ok(test_mode((ciphermode_t) &ccaes_aesni_xts_encrypt_mode, (ciphermode_t) &ccaes_aesni_xts_decrypt_mode, cc_cipherAES, cc_ModeXTS) == 1, "AES-NI intrinsics AES-XTS");
+        ok(test_xts(&ccaes_aesni_xts_encrypt_mode, &ccaes_aesni_xts_decrypt_mode), "AES-NI intrinsics AES-XTS Extended testing");
+    }
 #endif
     ok(test_mode((ciphermode_t) ccaes_ecb_encrypt_mode(), (ciphermode_t) ccaes_ecb_decrypt_mode(), cc_cipherAES, cc_ModeECB) == 1, "Default AES-ECB");
     ok(test_mode((ciphermode_t) ccaes_cbc_encrypt_mode(), (ciphermode_t) ccaes_cbc_decrypt_mode(), cc_cipherAES, cc_ModeCBC) == 1, "Default AES-CBC");
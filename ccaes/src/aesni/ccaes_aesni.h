@@ -0,0 +1,161 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#ifndef _CORECRYPTO_CCAES_AESNI_H_
+#define _CORECRYPTO_CCAES_AESNI_H_
+
+#include <corecrypto/ccaes.h>
+#include "ccmode_internal.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+#include <immintrin.h>
+#include <corecrypto/cc_runtime_config.h>
+
+#include "../ltc/ccaes_ltc_common.h"
+
+/* AES-NI implementation using compiler intrinsics, for builds where the
+ * assembly in ccaes/src/intel is not available (e.g. Linux without
+ * CC_LINUX_ASM). Callers must check CC_HAS_AESNI() before using any of
+ * the modes below.
+ *
+ * The key schedule is stored in the LTC layout (ltc_rijndael_keysched),
+ * so keys expanded here are interchangeable with ccaes_ltc_ecb_*_mode. */
+
+#define CCAES_AESNI_TARGET __attribute__((target("aes,sse2")))
+
+/* Number of blocks processed in parallel to hide the AESENC latency. */
+#define CCAES_AESNI_NBLOCKS 8
+
+#define CCAES_AESNI_MAX_NROUNDS 14
+
+/* Round keys are read in place from the LTC key schedule, so that no copy
+ * of the key material is left on the stack. */
+typedef struct {
+    const __m128i *rk;
+    unsigned nrounds;
+} ccaes_aesni_roundkeys;
+
+CC_INLINE
+void ccaes_aesni_load_enc(const ccecb_ctx *ctx, ccaes_aesni_roundkeys *k)
+{
+    const ltc_rijndael_keysched *ks = (const ltc_rijndael_keysched *)ctx;
+    k->nrounds = ks->enc.rn / CCAES_BLOCK_SIZE;
+    k->rk = (const __m128i *)ks->enc.ks;
+}
+
+CC_INLINE
+void ccaes_aesni_load_dec(const ccecb_ctx *ctx, ccaes_aesni_roundkeys *k)
+{
+    const ltc_rijndael_keysched *ks = (const ltc_rijndael_keysched *)ctx;
+    k->nrounds = ks->dec.rn / CCAES_BLOCK_SIZE;
+    k->rk = (const __m128i *)ks->dec.ks;
+}
+
+CC_INLINE CCAES_AESNI_TARGET
+__m128i ccaes_aesni_rk(const ccaes_aesni_roundkeys *k, unsigned i)
+{
+    return _mm_loadu_si128(k->rk + i);
+}
+
+CC_INLINE CCAES_AESNI_TARGET
+__m128i ccaes_aesni_encrypt1(const ccaes_aesni_roundkeys *k, __m128i b)
+{
+    b = _mm_xor_si128(b, ccaes_aesni_rk(k, 0));
+    for (unsigned r = 1; r < k->nrounds; r++) {
+        b = _mm_aesenc_si128(b, ccaes_aesni_rk(k, r));
+    }
+    return _mm_aesenclast_si128(b, ccaes_aesni_rk(k, k->nrounds));
+}
+
+CC_INLINE CCAES_AESNI_TARGET
+__m128i ccaes_aesni_decrypt1(const ccaes_aesni_roundkeys *k, __m128i b)
+{
+    b = _mm_xor_si128(b, ccaes_aesni_rk(k, 0));
+    for (unsigned r = 1; r < k->nrounds; r++) {
+        b = _mm_aesdec_si128(b, ccaes_aesni_rk(k, r));
+    }
+    return _mm_aesdeclast_si128(b, ccaes_aesni_rk(k, k->nrounds));
+}
+
+CC_INLINE CCAES_AESNI_TARGET
+void ccaes_aesni_encrypt8(const ccaes_aesni_roundkeys *k, __m128i b[CCAES_AESNI_NBLOCKS])
+{
+    for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+        b[i] = _mm_xor_si128(b[i], ccaes_aesni_rk(k, 0));
+    }
+    for (unsigned r = 1; r < k->nrounds; r++) {
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            b[i] = _mm_aesenc_si128(b[i], ccaes_aesni_rk(k, r));
+        }
+    }
+    for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+        b[i] = _mm_aesenclast_si128(b[i], ccaes_aesni_rk(k, k->nrounds));
+    }
+}
+
+CC_INLINE CCAES_AESNI_TARGET
+void ccaes_aesni_decrypt8(const ccaes_aesni_roundkeys *k, __m128i b[CCAES_AESNI_NBLOCKS])
+{
+    for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+        b[i] = _mm_xor_si128(b[i], ccaes_aesni_rk(k, 0));
+    }
+    for (unsigned r = 1; r < k->nrounds; r++) {
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            b[i] = _mm_aesdec_si128(b[i], ccaes_aesni_rk(k, r));
+        }
+    }
+    for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+        b[i] = _mm_aesdeclast_si128(b[i], ccaes_aesni_rk(k, k->nrounds));
+    }
+}
+
+/* Multiply an XTS tweak by alpha in GF(2^128). */
+CC_INLINE CCAES_AESNI_TARGET
+__m128i ccaes_aesni_xts_mult_alpha(__m128i t)
+{
+    __m128i carry = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), 0x93);
+    carry = _mm_and_si128(carry, _mm_set_epi32(1, 1, 1, 0x87));
+    return _mm_xor_si128(_mm_slli_epi32(t, 1), carry);
+}
+
+/* Wide kernels using 512-bit VAES, 16 blocks per iteration. Only call
+ * these when CC_HAS_AVX512_VAES(); nblocks must be a multiple of
+ * CCAES_VAES_NBLOCKS. The round keys are those loaded by
+ * ccaes_aesni_load_enc() or ccaes_aesni_load_dec(). */
+
+#define CCAES_VAES_NBLOCKS 16
+
+void ccaes_vaes_ecb_encrypt(const ccaes_aesni_roundkeys *k, size_t nblocks, const void *in, void *out);
+void ccaes_vaes_ecb_decrypt(const ccaes_aesni_roundkeys *k, size_t nblocks, const void *in, void *out);
+
+/* CTR over nblocks blocks whose counters are ctr_hi || (ctr_lo + i), with
+ * ctr_hi the first 8 bytes of the counter block as stored in memory and
+ * ctr_lo the native value of its big endian low half. */
+void ccaes_vaes_ctr_crypt(const ccaes_aesni_roundkeys *k, uint64_t ctr_hi, uint64_t ctr_lo,
+                          size_t nblocks, const void *in, void *out);
+
+/* GCM text over nblocks blocks: block i is XORed with E(Y + i), where only
+ * the last (big endian) word of Y is incremented, and the ciphertext is
+ * folded into the GHASH accumulator X. Y is advanced by nblocks. Htable
+ * must hold the powers of H computed by ccmode_gcm_init_clmul(). */
+struct _ccmode_gcm_htable;
+void ccaes_vaes_gcm_crypt(const ccaes_aesni_roundkeys *k, const struct _ccmode_gcm_htable *Htable,
+                          uint8_t *X, uint8_t *Y, size_t nblocks, const void *in, void *out, bool encrypt);
+
+/* Build the GCM descriptors over ccaes_ecb_encrypt_mode(), using the VAES
+ * bulk path for whole blocks when CC_HAS_AVX512_VAES(). */
+void ccaes_aesni_factory_gcm_encrypt(struct ccmode_gcm *gcm);
+void ccaes_aesni_factory_gcm_decrypt(struct ccmode_gcm *gcm);
+
+#endif /* CCAES_AESNI_INTRINSICS */
+
+#endif /* _CORECRYPTO_CCAES_AESNI_H_ */
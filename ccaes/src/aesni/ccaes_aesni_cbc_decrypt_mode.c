@@ -0,0 +1,69 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include "ccaes_aesni.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+static CCAES_AESNI_TARGET
+int ccaes_aesni_cbc_decrypt(const cccbc_ctx *key, cccbc_iv *iv, size_t nblocks, const void *in, void *out)
+{
+    const __m128i *c = in;
+    __m128i *p = out;
+    ccaes_aesni_roundkeys k;
+    __m128i b[CCAES_AESNI_NBLOCKS];
+    __m128i ct[CCAES_AESNI_NBLOCKS];
+
+    if (nblocks == 0) {
+        return 0;
+    }
+
+    ccaes_aesni_load_dec(ccmode_cbc_key_ecb_key(key), &k);
+
+    __m128i prev = _mm_loadu_si128((const __m128i *)iv);
+
+    // Ciphertext blocks are kept in registers before the output is written,
+    // so in-place decryption (in == out) is supported.
+    while (nblocks >= CCAES_AESNI_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            b[i] = ct[i] = _mm_loadu_si128(c + i);
+        }
+        ccaes_aesni_decrypt8(&k, b);
+        _mm_storeu_si128(p, _mm_xor_si128(b[0], prev));
+        for (unsigned i = 1; i < CCAES_AESNI_NBLOCKS; i++) {
+            _mm_storeu_si128(p + i, _mm_xor_si128(b[i], ct[i - 1]));
+        }
+        prev = ct[CCAES_AESNI_NBLOCKS - 1];
+        c += CCAES_AESNI_NBLOCKS;
+        p += CCAES_AESNI_NBLOCKS;
+        nblocks -= CCAES_AESNI_NBLOCKS;
+    }
+
+    while (nblocks--) {
+        __m128i x = _mm_loadu_si128(c++);
+        _mm_storeu_si128(p++, _mm_xor_si128(ccaes_aesni_decrypt1(&k, x), prev));
+        prev = x;
+    }
+    _mm_storeu_si128((__m128i *)iv, prev);
+
+    return 0;
+}
+
+const struct ccmode_cbc ccaes_aesni_cbc_decrypt_mode = {
+    .size = ccn_sizeof_size(sizeof(struct _ccmode_cbc_key)) + ccn_sizeof_size(CCAES_BLOCK_SIZE) +
+            ccn_sizeof_size(sizeof(ltc_rijndael_keysched)),
+    .block_size = CCAES_BLOCK_SIZE,
+    .init = ccmode_cbc_init,
+    .cbc = ccaes_aesni_cbc_decrypt,
+    .custom = &ccaes_aesni_ecb_decrypt_mode,
+};
+
+#endif /* CCAES_AESNI_INTRINSICS */
@@ -0,0 +1,49 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include "ccaes_aesni.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+static CCAES_AESNI_TARGET
+int ccaes_aesni_cbc_encrypt(const cccbc_ctx *key, cccbc_iv *iv, size_t nblocks, const void *in, void *out)
+{
+    const __m128i *p = in;
+    __m128i *c = out;
+    ccaes_aesni_roundkeys k;
+
+    if (nblocks == 0) {
+        return 0;
+    }
+
+    ccaes_aesni_load_enc(ccmode_cbc_key_ecb_key(key), &k);
+
+    // CBC encryption is inherently serial.
+    __m128i b = _mm_loadu_si128((const __m128i *)iv);
+    while (nblocks--) {
+        b = ccaes_aesni_encrypt1(&k, _mm_xor_si128(b, _mm_loadu_si128(p++)));
+        _mm_storeu_si128(c++, b);
+    }
+    _mm_storeu_si128((__m128i *)iv, b);
+
+    return 0;
+}
+
+const struct ccmode_cbc ccaes_aesni_cbc_encrypt_mode = {
+    .size = ccn_sizeof_size(sizeof(struct _ccmode_cbc_key)) + ccn_sizeof_size(CCAES_BLOCK_SIZE) +
+            ccn_sizeof_size(sizeof(ltc_rijndael_keysched)),
+    .block_size = CCAES_BLOCK_SIZE,
+    .init = ccmode_cbc_init,
+    .cbc = ccaes_aesni_cbc_encrypt,
+    .custom = &ccaes_aesni_ecb_encrypt_mode,
+};
+
+#endif /* CCAES_AESNI_INTRINSICS */
@@ -0,0 +1,123 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/cc_priv.h>
+#include "ccaes_aesni.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+/* Build the counter block for ctr + i. As in ccmode_ctr_crypt(), only the
+ * low 64 bits of the big endian counter are incremented. */
+CC_INLINE CCAES_AESNI_TARGET
+__m128i ccaes_aesni_ctr_block(__m128i hi, uint64_t ctr, uint64_t i)
+{
+    return _mm_unpacklo_epi64(hi, _mm_cvtsi64_si128((long long)CC_BSWAP64(ctr + i)));
+}
+
+static CCAES_AESNI_TARGET
+int ccaes_aesni_ctr_crypt(ccctr_ctx *key, size_t nbytes, const void *in, void *out)
+{
+    uint8_t *ctr = (uint8_t *)CCMODE_CTR_KEY_CTR(key);
+    uint8_t *pad = (uint8_t *)CCMODE_CTR_KEY_PAD(key);
+    size_t pad_offset = CCMODE_CTR_KEY_PAD_OFFSET(key);
+    const uint8_t *in_bytes = in;
+    uint8_t *out_bytes = out;
+    ccaes_aesni_roundkeys k;
+    __m128i b[CCAES_AESNI_NBLOCKS];
+    uint64_t ctr_lo;
+    size_t n;
+
+    // Consume what is left of the current pad.
+    if (pad_offset < CCAES_BLOCK_SIZE) {
+        n = CC_MIN(nbytes, CCAES_BLOCK_SIZE - pad_offset);
+        cc_xor(n, out_bytes, in_bytes, pad + pad_offset);
+        nbytes -= n;
+        in_bytes += n;
+        out_bytes += n;
+        pad_offset += n;
+    }
+
+    if (nbytes == 0) {
+        CCMODE_CTR_KEY_PAD_OFFSET(key) = pad_offset;
+        return 0;
+    }
+
+    ccaes_aesni_load_enc(CCMODE_CTR_KEY_ECB_KEY(key), &k);
+
+    __m128i hi = _mm_loadl_epi64((const __m128i *)ctr);
+    CC_LOAD64_BE(ctr_lo, ctr + 8);
+
+    if (nbytes >= CCAES_VAES_NBLOCKS * CCAES_BLOCK_SIZE && CC_HAS_AVX512_VAES()) {
+        size_t nblocks = nbytes / CCAES_BLOCK_SIZE;
+        uint64_t ctr_hi;
+
+        nblocks -= nblocks % CCAES_VAES_NBLOCKS;
+        cc_memcpy(&ctr_hi, ctr, sizeof(ctr_hi));
+        ccaes_vaes_ctr_crypt(&k, ctr_hi, ctr_lo, nblocks, in_bytes, out_bytes);
+
+        ctr_lo += nblocks;
+        nbytes -= nblocks * CCAES_BLOCK_SIZE;
+        in_bytes += nblocks * CCAES_BLOCK_SIZE;
+        out_bytes += nblocks * CCAES_BLOCK_SIZE;
+    }
+
+    while (nbytes >= CCAES_AESNI_NBLOCKS * CCAES_BLOCK_SIZE) {
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            b[i] = ccaes_aesni_ctr_block(hi, ctr_lo, i);
+        }
+        ccaes_aesni_encrypt8(&k, b);
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            __m128i x = _mm_loadu_si128((const __m128i *)in_bytes + i);
+            _mm_storeu_si128((__m128i *)out_bytes + i, _mm_xor_si128(x, b[i]));
+        }
+        ctr_lo += CCAES_AESNI_NBLOCKS;
+        nbytes -= CCAES_AESNI_NBLOCKS * CCAES_BLOCK_SIZE;
+        in_bytes += CCAES_AESNI_NBLOCKS * CCAES_BLOCK_SIZE;
+        out_bytes += CCAES_AESNI_NBLOCKS * CCAES_BLOCK_SIZE;
+    }
+
+    while (nbytes >= CCAES_BLOCK_SIZE) {
+        __m128i x = _mm_loadu_si128((const __m128i *)in_bytes);
+        x = _mm_xor_si128(x, ccaes_aesni_encrypt1(&k, ccaes_aesni_ctr_block(hi, ctr_lo, 0)));
+        _mm_storeu_si128((__m128i *)out_bytes, x);
+        ctr_lo++;
+        nbytes -= CCAES_BLOCK_SIZE;
+        in_bytes += CCAES_BLOCK_SIZE;
+        out_bytes += CCAES_BLOCK_SIZE;
+    }
+
+    // Keep the keystream of a trailing partial block for the next call.
+    if (nbytes) {
+        _mm_storeu_si128((__m128i *)pad, ccaes_aesni_encrypt1(&k, ccaes_aesni_ctr_block(hi, ctr_lo, 0)));
+        ctr_lo++;
+        cc_xor(nbytes, out_bytes, in_bytes, pad);
+        pad_offset = nbytes;
+    }
+
+    CC_STORE64_BE(ctr_lo, ctr + 8);
+    CCMODE_CTR_KEY_PAD_OFFSET(key) = pad_offset;
+
+    cc_clear(sizeof(b), b);
+    return 0;
+}
+
+const struct ccmode_ctr ccaes_aesni_ctr_crypt_mode = {
+    .size = ccn_sizeof_size(sizeof(struct _ccmode_ctr_key)) + 2 * ccn_sizeof_size(CCAES_BLOCK_SIZE) +
+            ccn_sizeof_size(sizeof(ltc_rijndael_keysched)),
+    .block_size = 1,
+    .ecb_block_size = CCAES_BLOCK_SIZE,
+    .init = ccmode_ctr_init,
+    .setctr = ccmode_ctr_setctr,
+    .ctr = ccaes_aesni_ctr_crypt,
+    .custom = &ccaes_aesni_ecb_encrypt_mode,
+};
+
+#endif /* CCAES_AESNI_INTRINSICS */
@@ -0,0 +1,62 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include "ccaes_aesni.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+static CCAES_AESNI_TARGET
+int ccaes_aesni_ecb_encrypt(const ccecb_ctx *key, size_t nblocks, const void *in, void *out)
+{
+    const __m128i *p = in;
+    __m128i *c = out;
+    ccaes_aesni_roundkeys k;
+    __m128i b[CCAES_AESNI_NBLOCKS];
+
+    ccaes_aesni_load_enc(key, &k);
+
+    if (nblocks >= CCAES_VAES_NBLOCKS && CC_HAS_AVX512_VAES()) {
+        size_t n = nblocks - nblocks % CCAES_VAES_NBLOCKS;
+        ccaes_vaes_ecb_encrypt(&k, n, p, c);
+        p += n;
+        c += n;
+        nblocks -= n;
+    }
+
+    while (nblocks >= CCAES_AESNI_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            b[i] = _mm_loadu_si128(p + i);
+        }
+        ccaes_aesni_encrypt8(&k, b);
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            _mm_storeu_si128(c + i, b[i]);
+        }
+        p += CCAES_AESNI_NBLOCKS;
+        c += CCAES_AESNI_NBLOCKS;
+        nblocks -= CCAES_AESNI_NBLOCKS;
+    }
+
+    while (nblocks--) {
+        _mm_storeu_si128(c++, ccaes_aesni_encrypt1(&k, _mm_loadu_si128(p++)));
+    }
+
+    return 0;
+}
+
+const struct ccmode_ecb ccaes_aesni_ecb_encrypt_mode = {
+    .size = sizeof(ltc_rijndael_keysched),
+    .block_size = CCAES_BLOCK_SIZE,
+    .init = ccaes_ecb_encrypt_init,
+    .ecb = ccaes_aesni_ecb_encrypt,
+    .roundkey = ccaes_ecb_encrypt_roundkey,
+};
+
+#endif /* CCAES_AESNI_INTRINSICS */
@@ -0,0 +1,109 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/cc_priv.h>
+#include "ccaes_aesni.h"
+#include "ccmode_gcm_tables.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+#if CCMODE_GCM_CLMUL
+
+
+/* Process as many whole 16-block runs as possible with the wide kernel and
+ * return the number of bytes consumed. Anything else, including error
+ * reporting, is left to ccmode_gcm_encrypt/decrypt. */
+static size_t ccaes_vaes_gcm_bulk(ccgcm_ctx *key, size_t nbytes, const uint8_t *in, uint8_t *out, bool encrypt)
+{
+    struct _ccmode_gcm_key *ctx = _CCMODE_GCM_KEY(key);
+    ccaes_aesni_roundkeys k;
+    size_t n;
+
+    // The round keys are read straight from the ECB key, so this only
+    // applies when GCM was built over the AES-NI ECB.
+    if (nbytes < CCAES_VAES_NBLOCKS * CCGCM_BLOCK_NBYTES || ctx->ecb != &ccaes_aesni_ecb_encrypt_mode ||
+        !CCMODE_GCM_CLMUL_ENABLED()) {
+        return 0;
+    }
+
+    ccmode_gcm_aad_finalize(key);
+    if (ctx->state != CCMODE_GCM_STATE_TEXT || ctx->text_nbytes % CCGCM_BLOCK_NBYTES != 0 ||
+        UINT64_MAX - ctx->text_nbytes < nbytes || ctx->text_nbytes + nbytes > CCGCM_TEXT_MAX_NBYTES) {
+        return 0;
+    }
+
+    // With no partial block pending, the pad is E(Y) and the next block
+    // uses counter Y.
+    n = nbytes - nbytes % (CCAES_VAES_NBLOCKS * CCGCM_BLOCK_NBYTES);
+    ccaes_aesni_load_enc(CCMODE_GCM_KEY_ECB_KEY(key), &k);
+    ccaes_vaes_gcm_crypt(&k, CCMODE_GCM_KEY_Htable(key), CCMODE_GCM_KEY_X(key), CCMODE_GCM_KEY_Y(key),
+                         n / CCGCM_BLOCK_NBYTES, in, out, encrypt);
+
+    ctx->text_nbytes += n;
+    ctx->ecb->ecb(CCMODE_GCM_KEY_ECB_KEY(key), 1, CCMODE_GCM_KEY_Y(key), CCMODE_GCM_KEY_PAD(key));
+
+    return n;
+}
+static int ccaes_vaes_gcm(ccgcm_ctx *key, size_t nbytes, const uint8_t *in, uint8_t *out, bool encrypt)
+{
+    int (*crypt)(ccgcm_ctx *, size_t, const void *, void *) = encrypt ? ccmode_gcm_encrypt : ccmode_gcm_decrypt;
+    size_t n = CC_MIN(nbytes, (CCGCM_BLOCK_NBYTES - _CCMODE_GCM_KEY(key)->text_nbytes % CCGCM_BLOCK_NBYTES) % CCGCM_BLOCK_NBYTES);
+    int rc;
+
+    // Finish a block left partial by a previous call (e.g. at a fragment
+    // boundary) so that the bulk path starts on a block boundary.
+    if (n > 0) {
+        rc = crypt(key, n, in, out);
+        if (rc) {
+            return rc;
+        }
+        nbytes -= n;
+        in += n;
+        out += n;
+    }
+
+    n = ccaes_vaes_gcm_bulk(key, nbytes, in, out, encrypt);
+    return crypt(key, nbytes - n, in + n, out + n);
+}
+
+static int ccaes_vaes_gcm_encrypt(ccgcm_ctx *key, size_t nbytes, const void *in, void *out)
+{
+    return ccaes_vaes_gcm(key, nbytes, in, out, true);
+}
+
+static int ccaes_vaes_gcm_decrypt(ccgcm_ctx *key, size_t nbytes, const void *in, void *out)
+{
+    return ccaes_vaes_gcm(key, nbytes, in, out, false);
+}
+
+#endif /* CCMODE_GCM_CLMUL */
+
+void ccaes_aesni_factory_gcm_encrypt(struct ccmode_gcm *gcm)
+{
+    ccmode_factory_gcm_encrypt(gcm, ccaes_ecb_encrypt_mode());
+#if CCMODE_GCM_CLMUL
+    if (CC_HAS_AVX512_VAES()) {
+        gcm->gcm = ccaes_vaes_gcm_encrypt;
+    }
+#endif
+}
+
+void ccaes_aesni_factory_gcm_decrypt(struct ccmode_gcm *gcm)
+{
+    ccmode_factory_gcm_decrypt(gcm, ccaes_ecb_encrypt_mode());
+#if CCMODE_GCM_CLMUL
+    if (CC_HAS_AVX512_VAES()) {
+        gcm->gcm = ccaes_vaes_gcm_decrypt;
+    }
+#endif
+}
+
+#endif /* CCAES_AESNI_INTRINSICS */
@@ -0,0 +1,214 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/cc_priv.h>
+#include "ccaes_aesni.h"
+#include "ccmode_gcm_clmul.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+#define CCAES_VAES_TARGET __attribute__((target("aes,sse2,avx512f,avx512bw,vaes")))
+
+/* Each 512-bit vector carries four blocks. */
+#define CCAES_VAES_NVEC (CCAES_VAES_NBLOCKS / 4)
+
+CC_INLINE CCAES_VAES_TARGET
+__m512i ccaes_vaes_rk(const ccaes_aesni_roundkeys *k, unsigned i)
+{
+    return _mm512_broadcast_i32x4(_mm_loadu_si128(k->rk + i));
+}
+
+CC_INLINE CCAES_VAES_TARGET
+void ccaes_vaes_encrypt16(const ccaes_aesni_roundkeys *k, __m512i b[CCAES_VAES_NVEC])
+{
+    for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+        b[i] = _mm512_xor_si512(b[i], ccaes_vaes_rk(k, 0));
+    }
+    for (unsigned r = 1; r < k->nrounds; r++) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            b[i] = _mm512_aesenc_epi128(b[i], ccaes_vaes_rk(k, r));
+        }
+    }
+    for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+        b[i] = _mm512_aesenclast_epi128(b[i], ccaes_vaes_rk(k, k->nrounds));
+    }
+}
+
+CC_INLINE CCAES_VAES_TARGET
+void ccaes_vaes_decrypt16(const ccaes_aesni_roundkeys *k, __m512i b[CCAES_VAES_NVEC])
+{
+    for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+        b[i] = _mm512_xor_si512(b[i], ccaes_vaes_rk(k, 0));
+    }
+    for (unsigned r = 1; r < k->nrounds; r++) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            b[i] = _mm512_aesdec_epi128(b[i], ccaes_vaes_rk(k, r));
+        }
+    }
+    for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+        b[i] = _mm512_aesdeclast_epi128(b[i], ccaes_vaes_rk(k, k->nrounds));
+    }
+}
+
+CCAES_VAES_TARGET
+void ccaes_vaes_ecb_encrypt(const ccaes_aesni_roundkeys *k, size_t nblocks, const void *in, void *out)
+{
+    const __m512i *p = in;
+    __m512i *c = out;
+    __m512i b[CCAES_VAES_NVEC];
+
+    cc_assert(nblocks % CCAES_VAES_NBLOCKS == 0);
+    for (; nblocks; nblocks -= CCAES_VAES_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            b[i] = _mm512_loadu_si512(p + i);
+        }
+        ccaes_vaes_encrypt16(k, b);
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            _mm512_storeu_si512(c + i, b[i]);
+        }
+        p += CCAES_VAES_NVEC;
+        c += CCAES_VAES_NVEC;
+    }
+}
+
+CCAES_VAES_TARGET
+void ccaes_vaes_ecb_decrypt(const ccaes_aesni_roundkeys *k, size_t nblocks, const void *in, void *out)
+{
+    const __m512i *p = in;
+    __m512i *c = out;
+    __m512i b[CCAES_VAES_NVEC];
+
+    cc_assert(nblocks % CCAES_VAES_NBLOCKS == 0);
+    for (; nblocks; nblocks -= CCAES_VAES_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            b[i] = _mm512_loadu_si512(p + i);
+        }
+        ccaes_vaes_decrypt16(k, b);
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            _mm512_storeu_si512(c + i, b[i]);
+        }
+        p += CCAES_VAES_NVEC;
+        c += CCAES_VAES_NVEC;
+    }
+}
+
+CCAES_VAES_TARGET
+void ccaes_vaes_ctr_crypt(const ccaes_aesni_roundkeys *k, uint64_t ctr_hi, uint64_t ctr_lo,
+                          size_t nblocks, const void *in, void *out)
+{
+    const __m512i *p = in;
+    __m512i *c = out;
+    __m512i ctr[CCAES_VAES_NVEC], b[CCAES_VAES_NVEC];
+
+    // Counters are kept with a native low half, which is byte swapped
+    // into place for each batch.
+    const __m512i bswap_lo = _mm512_broadcast_i32x4(_mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 7, 6, 5, 4, 3, 2, 1, 0));
+    const __m512i inc = _mm512_set_epi64(CCAES_VAES_NBLOCKS, 0, CCAES_VAES_NBLOCKS, 0,
+                                         CCAES_VAES_NBLOCKS, 0, CCAES_VAES_NBLOCKS, 0);
+
+    cc_assert(nblocks % CCAES_VAES_NBLOCKS == 0);
+    ctr[0] = _mm512_set_epi64((long long)(ctr_lo + 3), (long long)ctr_hi, (long long)(ctr_lo + 2), (long long)ctr_hi,
+                              (long long)(ctr_lo + 1), (long long)ctr_hi, (long long)ctr_lo, (long long)ctr_hi);
+    for (unsigned i = 1; i < CCAES_VAES_NVEC; i++) {
+        ctr[i] = _mm512_add_epi64(ctr[i - 1], _mm512_set_epi64(4, 0, 4, 0, 4, 0, 4, 0));
+    }
+
+    for (; nblocks; nblocks -= CCAES_VAES_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            b[i] = _mm512_shuffle_epi8(ctr[i], bswap_lo);
+            ctr[i] = _mm512_add_epi64(ctr[i], inc);
+        }
+        ccaes_vaes_encrypt16(k, b);
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            _mm512_storeu_si512(c + i, _mm512_xor_si512(b[i], _mm512_loadu_si512(p + i)));
+        }
+        p += CCAES_VAES_NVEC;
+        c += CCAES_VAES_NVEC;
+    }
+}
+
+#if CCMODE_GCM_CLMUL
+
+#define CCAES_VAES_GCM_TARGET __attribute__((target("aes,sse2,ssse3,pclmul,avx512f,avx512bw,vaes,vpclmulqdq")))
+
+/* Each iteration runs the AES rounds for one run of 16 blocks next to the
+ * GHASH of another, so that the two pipelines overlap. When encrypting,
+ * the ciphertext of a run is hashed during the next iteration. */
+CCAES_VAES_GCM_TARGET
+void ccaes_vaes_gcm_crypt(const ccaes_aesni_roundkeys *k, const struct _ccmode_gcm_htable *Htable,
+                          uint8_t *X, uint8_t *Y, size_t nblocks, const void *in, void *out, bool encrypt)
+{
+    const __m512i *p = in;
+    __m512i *c = out;
+    __m512i ctr[CCAES_VAES_NVEC], b[CCAES_VAES_NVEC], t[CCAES_VAES_NVEC];
+    __m512i hpow[CCAES_VAES_NVEC];
+    __m128i x = ghash_bswap(_mm_loadu_si128((const __m128i *)X));
+    bool pending = false;
+    uint32_t ctr32;
+
+    // The last word of each counter block is kept native and byte
+    // swapped into place for each run.
+    const __m512i bswap_ctr = _mm512_broadcast_i32x4(_mm_set_epi8(12, 13, 14, 15, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    const __m512i inc = _mm512_set_epi32(CCAES_VAES_NBLOCKS, 0, 0, 0, CCAES_VAES_NBLOCKS, 0, 0, 0,
+                                         CCAES_VAES_NBLOCKS, 0, 0, 0, CCAES_VAES_NBLOCKS, 0, 0, 0);
+
+    cc_static_assert(CCAES_VAES_NBLOCKS == CCMODE_GCM_CLMUL_WIDE_NBLOCKS, "VAES and GHASH runs must match");
+    cc_assert(nblocks % CCAES_VAES_NBLOCKS == 0);
+
+    ghash_load_hpow_wide(Htable, hpow);
+
+    CC_LOAD32_BE(ctr32, Y + 12);
+    ctr[0] = _mm512_broadcast_i32x4(_mm_insert_epi32(_mm_loadu_si128((const __m128i *)Y), (int)ctr32, 3));
+    ctr[0] = _mm512_add_epi32(ctr[0], _mm512_set_epi32(3, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0));
+    for (unsigned i = 1; i < CCAES_VAES_NVEC; i++) {
+        ctr[i] = _mm512_add_epi32(ctr[i - 1], _mm512_set_epi32(4, 0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0));
+    }
+    CC_STORE32_BE(ctr32 + (uint32_t)nblocks, Y + 12);
+
+    for (; nblocks; nblocks -= CCAES_VAES_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            b[i] = _mm512_shuffle_epi8(ctr[i], bswap_ctr);
+            ctr[i] = _mm512_add_epi32(ctr[i], inc);
+        }
+
+        // Decryption hashes this run's input, encryption the previous
+        // run's output.
+        if (!encrypt || pending) {
+            const __m512i *h = encrypt ? c - CCAES_VAES_NVEC : p;
+            for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+                t[i] = _mm512_loadu_si512(h + i);
+            }
+            x = ghash_fold_wide(x, hpow, t);
+        }
+
+        ccaes_vaes_encrypt16(k, b);
+
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            _mm512_storeu_si512(c + i, _mm512_xor_si512(b[i], _mm512_loadu_si512(p + i)));
+        }
+        pending = encrypt;
+
+        p += CCAES_VAES_NVEC;
+        c += CCAES_VAES_NVEC;
+    }
+
+    if (pending) {
+        for (unsigned i = 0; i < CCAES_VAES_NVEC; i++) {
+            t[i] = _mm512_loadu_si512(c - CCAES_VAES_NVEC + i);
+        }
+        x = ghash_fold_wide(x, hpow, t);
+    }
+    _mm_storeu_si128((__m128i *)X, ghash_bswap(x));
+}
+
+#endif /* CCMODE_GCM_CLMUL */
+
+#endif /* CCAES_AESNI_INTRINSICS */
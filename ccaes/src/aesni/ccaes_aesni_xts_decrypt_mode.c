@@ -0,0 +1,75 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include "ccaes_aesni.h"
+
+#if CCAES_AESNI_INTRINSICS
+
+static CCAES_AESNI_TARGET
+void *ccaes_aesni_xts_decrypt(const ccxts_ctx *ctx, ccxts_tweak *tweak, size_t nblocks, const void *in, void *out)
+{
+    size_t numBlocks = CCMODE_XTS_TWEAK_BLOCK_PROCESSED(tweak);
+    numBlocks += nblocks;
+    if (numBlocks > (1 << 20)) {
+        return NULL;
+    }
+    CCMODE_XTS_TWEAK_BLOCK_PROCESSED(tweak) = numBlocks;
+
+    cc_unit *t = CCMODE_XTS_TWEAK_VALUE(tweak);
+    const __m128i *p = in;
+    __m128i *c = out;
+    ccaes_aesni_roundkeys k;
+    __m128i b[CCAES_AESNI_NBLOCKS];
+    __m128i tw[CCAES_AESNI_NBLOCKS];
+
+    ccaes_aesni_load_dec(ccmode_xts_key_data_key(ctx), &k);
+
+    __m128i T = _mm_loadu_si128((const __m128i *)t);
+
+    while (nblocks >= CCAES_AESNI_NBLOCKS) {
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            tw[i] = T;
+            b[i] = _mm_xor_si128(_mm_loadu_si128(p + i), T);
+            T = ccaes_aesni_xts_mult_alpha(T);
+        }
+        ccaes_aesni_decrypt8(&k, b);
+        for (unsigned i = 0; i < CCAES_AESNI_NBLOCKS; i++) {
+            _mm_storeu_si128(c + i, _mm_xor_si128(b[i], tw[i]));
+        }
+        p += CCAES_AESNI_NBLOCKS;
+        c += CCAES_AESNI_NBLOCKS;
+        nblocks -= CCAES_AESNI_NBLOCKS;
+    }
+
+    while (nblocks--) {
+        __m128i x = ccaes_aesni_decrypt1(&k, _mm_xor_si128(_mm_loadu_si128(p++), T));
+        _mm_storeu_si128(c++, _mm_xor_si128(x, T));
+        T = ccaes_aesni_xts_mult_alpha(T);
+    }
+
+    _mm_storeu_si128((__m128i *)t, T);
+
+    return t;
+}
+
+const struct ccmode_xts ccaes_aesni_xts_decrypt_mode = {
+    .size = ccn_sizeof_size(sizeof(struct _ccmode_xts_key)) + 2 * ccn_sizeof_size(sizeof(ltc_rijndael_keysched)),
+    .tweak_size = ccn_sizeof_size(sizeof(struct _ccmode_xts_tweak)) + ccn_sizeof_size(CCAES_BLOCK_SIZE),
+    .block_size = CCAES_BLOCK_SIZE,
+    .init = ccmode_xts_init,
+    .key_sched = ccmode_xts_key_sched,
+    .set_tweak = ccmode_xts_set_tweak,
+    .xts = ccaes_aesni_xts_decrypt,
+    .custom = &ccaes_aesni_ecb_decrypt_mode,
+    .custom1 = &ccaes_aesni_ecb_encrypt_mode,
+};
+
+#endif /* CCAES_AESNI_INTRINSICS */
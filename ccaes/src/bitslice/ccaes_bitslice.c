@@ -0,0 +1,526 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+/*
+ * Bitsliced AES, following the "ct64" construction of BearSSL
+ * (Thomas Pornin): four blocks are spread over eight 64-bit words so
+ * that every bit of the state is processed by plain boolean operations,
+ * with no secret-dependent memory access or branch. The S-box is the
+ * Boyar-Peralta circuit.
+ */
+
+#include <corecrypto/ccaes.h>
+#include <corecrypto/cc_priv.h>
+
+#if !CC_KERNEL || !CC_USE_ASM
+
+#include "ccaes_bitslice.h"
+
+static void ccaes_bitslice_sbox(uint64_t *q)
+{
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint64_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint64_t y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    /* Top linear transformation. */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* Non-linear section. */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* Bottom linear transformation. */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/* Inverse S-box: S^-1(x) = A^-1(S(A^-1(x ^ 0x63)) ^ 0x63), where A is the
+   affine map of the forward S-box. */
+static void ccaes_bitslice_inv_affine(uint64_t *q)
+{
+    uint64_t q0, q1, q2, q3, q4, q5, q6, q7;
+
+    q0 = ~q[0];
+    q1 = ~q[1];
+    q2 = q[2];
+    q3 = q[3];
+    q4 = q[4];
+    q5 = ~q[5];
+    q6 = ~q[6];
+    q7 = q[7];
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+static void ccaes_bitslice_inv_sbox(uint64_t *q)
+{
+    ccaes_bitslice_inv_affine(q);
+    ccaes_bitslice_sbox(q);
+    ccaes_bitslice_inv_affine(q);
+}
+
+#define CCAES_BITSLICE_SWAPN(cl, ch, s, x, y)  \
+    do {                                       \
+        uint64_t _a = (x), _b = (y);           \
+        (x) = (_a & (cl)) | ((_b & (cl)) << (s)); \
+        (y) = ((_a & (ch)) >> (s)) | (_b & (ch)); \
+    } while (0)
+
+#define CCAES_BITSLICE_SWAP2(x, y) CCAES_BITSLICE_SWAPN(0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1, x, y)
+#define CCAES_BITSLICE_SWAP4(x, y) CCAES_BITSLICE_SWAPN(0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2, x, y)
+#define CCAES_BITSLICE_SWAP8(x, y) CCAES_BITSLICE_SWAPN(0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4, x, y)
+
+/* Transpose the state between the interleaved and the bitsliced layout.
+   The transform is its own inverse. */
+static void ccaes_bitslice_ortho(uint64_t *q)
+{
+    CCAES_BITSLICE_SWAP2(q[0], q[1]);
+    CCAES_BITSLICE_SWAP2(q[2], q[3]);
+    CCAES_BITSLICE_SWAP2(q[4], q[5]);
+    CCAES_BITSLICE_SWAP2(q[6], q[7]);
+
+    CCAES_BITSLICE_SWAP4(q[0], q[2]);
+    CCAES_BITSLICE_SWAP4(q[1], q[3]);
+    CCAES_BITSLICE_SWAP4(q[4], q[6]);
+    CCAES_BITSLICE_SWAP4(q[5], q[7]);
+
+    CCAES_BITSLICE_SWAP8(q[0], q[4]);
+    CCAES_BITSLICE_SWAP8(q[1], q[5]);
+    CCAES_BITSLICE_SWAP8(q[2], q[6]);
+    CCAES_BITSLICE_SWAP8(q[3], q[7]);
+}
+
+/* Spread the four 32-bit words of one block over two 64-bit words. */
+static void ccaes_bitslice_interleave_in(uint64_t *q0, uint64_t *q1, const uint32_t *w)
+{
+    uint64_t x0, x1, x2, x3;
+
+    x0 = w[0];
+    x1 = w[1];
+    x2 = w[2];
+    x3 = w[3];
+    x0 |= (x0 << 16);
+    x1 |= (x1 << 16);
+    x2 |= (x2 << 16);
+    x3 |= (x3 << 16);
+    x0 &= 0x0000FFFF0000FFFF;
+    x1 &= 0x0000FFFF0000FFFF;
+    x2 &= 0x0000FFFF0000FFFF;
+    x3 &= 0x0000FFFF0000FFFF;
+    x0 |= (x0 << 8);
+    x1 |= (x1 << 8);
+    x2 |= (x2 << 8);
+    x3 |= (x3 << 8);
+    x0 &= 0x00FF00FF00FF00FF;
+    x1 &= 0x00FF00FF00FF00FF;
+    x2 &= 0x00FF00FF00FF00FF;
+    x3 &= 0x00FF00FF00FF00FF;
+    *q0 = x0 | (x2 << 8);
+    *q1 = x1 | (x3 << 8);
+}
+
+static void ccaes_bitslice_interleave_out(uint32_t *w, uint64_t q0, uint64_t q1)
+{
+    uint64_t x0, x1, x2, x3;
+
+    x0 = q0 & 0x00FF00FF00FF00FF;
+    x1 = q1 & 0x00FF00FF00FF00FF;
+    x2 = (q0 >> 8) & 0x00FF00FF00FF00FF;
+    x3 = (q1 >> 8) & 0x00FF00FF00FF00FF;
+    x0 |= (x0 >> 8);
+    x1 |= (x1 >> 8);
+    x2 |= (x2 >> 8);
+    x3 |= (x3 >> 8);
+    x0 &= 0x0000FFFF0000FFFF;
+    x1 &= 0x0000FFFF0000FFFF;
+    x2 &= 0x0000FFFF0000FFFF;
+    x3 &= 0x0000FFFF0000FFFF;
+    w[0] = (uint32_t)x0 | (uint32_t)(x0 >> 16);
+    w[1] = (uint32_t)x1 | (uint32_t)(x1 >> 16);
+    w[2] = (uint32_t)x2 | (uint32_t)(x2 >> 16);
+    w[3] = (uint32_t)x3 | (uint32_t)(x3 >> 16);
+}
+
+static void ccaes_bitslice_add_round_key(uint64_t *q, const uint64_t *sk)
+{
+    for (int i = 0; i < 8; i++) {
+        q[i] ^= sk[i];
+    }
+}
+
+static void ccaes_bitslice_shift_rows(uint64_t *q)
+{
+    for (int i = 0; i < 8; i++) {
+        uint64_t x = q[i];
+        q[i] = (x & 0x000000000000FFFF)
+            | ((x & 0x00000000FFF00000) >> 4)
+            | ((x & 0x00000000000F0000) << 12)
+            | ((x & 0x0000FF0000000000) >> 8)
+            | ((x & 0x000000FF00000000) << 8)
+            | ((x & 0xF000000000000000) >> 12)
+            | ((x & 0x0FFF000000000000) << 4);
+    }
+}
+
+static void ccaes_bitslice_inv_shift_rows(uint64_t *q)
+{
+    for (int i = 0; i < 8; i++) {
+        uint64_t x = q[i];
+        q[i] = (x & 0x000000000000FFFF)
+            | ((x & 0x000000000FFF0000) << 4)
+            | ((x & 0x00000000F0000000) >> 12)
+            | ((x & 0x000000FF00000000) << 8)
+            | ((x & 0x0000FF0000000000) >> 8)
+            | ((x & 0x000F000000000000) << 12)
+            | ((x & 0xFFF0000000000000) >> 4);
+    }
+}
+
+CC_INLINE uint64_t ccaes_bitslice_rotr32(uint64_t x)
+{
+    return (x << 32) | (x >> 32);
+}
+
+static void ccaes_bitslice_mix_columns(uint64_t *q)
+{
+    uint64_t q0, q1, q2, q3, q4, q5, q6, q7;
+    uint64_t r0, r1, r2, r3, r4, r5, r6, r7;
+
+    q0 = q[0];
+    q1 = q[1];
+    q2 = q[2];
+    q3 = q[3];
+    q4 = q[4];
+    q5 = q[5];
+    q6 = q[6];
+    q7 = q[7];
+    r0 = (q0 >> 16) | (q0 << 48);
+    r1 = (q1 >> 16) | (q1 << 48);
+    r2 = (q2 >> 16) | (q2 << 48);
+    r3 = (q3 >> 16) | (q3 << 48);
+    r4 = (q4 >> 16) | (q4 << 48);
+    r5 = (q5 >> 16) | (q5 << 48);
+    r6 = (q6 >> 16) | (q6 << 48);
+    r7 = (q7 >> 16) | (q7 << 48);
+
+    q[0] = q7 ^ r7 ^ r0 ^ ccaes_bitslice_rotr32(q0 ^ r0);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ ccaes_bitslice_rotr32(q1 ^ r1);
+    q[2] = q1 ^ r1 ^ r2 ^ ccaes_bitslice_rotr32(q2 ^ r2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ ccaes_bitslice_rotr32(q3 ^ r3);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ ccaes_bitslice_rotr32(q4 ^ r4);
+    q[5] = q4 ^ r4 ^ r5 ^ ccaes_bitslice_rotr32(q5 ^ r5);
+    q[6] = q5 ^ r5 ^ r6 ^ ccaes_bitslice_rotr32(q6 ^ r6);
+    q[7] = q6 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q7 ^ r7);
+}
+
+static void ccaes_bitslice_inv_mix_columns(uint64_t *q)
+{
+    uint64_t q0, q1, q2, q3, q4, q5, q6, q7;
+    uint64_t r0, r1, r2, r3, r4, r5, r6, r7;
+
+    q0 = q[0];
+    q1 = q[1];
+    q2 = q[2];
+    q3 = q[3];
+    q4 = q[4];
+    q5 = q[5];
+    q6 = q[6];
+    q7 = q[7];
+    r0 = (q0 >> 16) | (q0 << 48);
+    r1 = (q1 >> 16) | (q1 << 48);
+    r2 = (q2 >> 16) | (q2 << 48);
+    r3 = (q3 >> 16) | (q3 << 48);
+    r4 = (q4 >> 16) | (q4 << 48);
+    r5 = (q5 >> 16) | (q5 << 48);
+    r6 = (q6 >> 16) | (q6 << 48);
+    r7 = (q7 >> 16) | (q7 << 48);
+
+    q[0] = q5 ^ q6 ^ q7 ^ r0 ^ r5 ^ r7 ^ ccaes_bitslice_rotr32(q0 ^ q5 ^ q6 ^ r0 ^ r5);
+    q[1] = q0 ^ q5 ^ r0 ^ r1 ^ r5 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q1 ^ q5 ^ q7 ^ r1 ^ r5 ^ r6);
+    q[2] = q0 ^ q1 ^ q6 ^ r1 ^ r2 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q0 ^ q2 ^ q6 ^ r2 ^ r6 ^ r7);
+    q[3] = q0 ^ q1 ^ q2 ^ q5 ^ q6 ^ r0 ^ r2 ^ r3 ^ r5 ^ ccaes_bitslice_rotr32(q0 ^ q1 ^ q3 ^ q5 ^ q6 ^ q7 ^ r0 ^ r3 ^ r5 ^ r7);
+    q[4] = q1 ^ q2 ^ q3 ^ q5 ^ r1 ^ r3 ^ r4 ^ r5 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q1 ^ q2 ^ q4 ^ q5 ^ q7 ^ r1 ^ r4 ^ r5 ^ r6);
+    q[5] = q2 ^ q3 ^ q4 ^ q6 ^ r2 ^ r4 ^ r5 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q2 ^ q3 ^ q5 ^ q6 ^ r2 ^ r5 ^ r6 ^ r7);
+    q[6] = q3 ^ q4 ^ q5 ^ q7 ^ r3 ^ r5 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q3 ^ q4 ^ q6 ^ q7 ^ r3 ^ r6 ^ r7);
+    q[7] = q4 ^ q5 ^ q6 ^ r4 ^ r6 ^ r7 ^ ccaes_bitslice_rotr32(q4 ^ q5 ^ q7 ^ r4 ^ r7);
+}
+
+int ccaes_bitslice_init(const struct ccmode_ecb *ecb, ccecb_ctx *key, size_t rawkey_len, const void *rawkey)
+{
+    ccaes_bitslice_keysched *ks = (ccaes_bitslice_keysched *)key;
+    uint64_t q[8];
+    int rc;
+
+    rc = ccaes_ecb_encrypt_init(ecb, key, rawkey_len, rawkey);
+    if (rc) {
+        return rc;
+    }
+
+    ks->nrounds = ks->ltc.enc.rn / CCAES_BLOCK_SIZE;
+
+    // Bitslice each round key of the (little-endian) LTC schedule, with
+    // the same key in all four lanes.
+    for (uint32_t i = 0; i <= ks->nrounds; i++) {
+        ccaes_bitslice_interleave_in(&q[0], &q[4], &ks->ltc.enc.ks[4 * i]);
+        q[1] = q[0];
+        q[2] = q[0];
+        q[3] = q[0];
+        q[5] = q[4];
+        q[6] = q[4];
+        q[7] = q[4];
+        ccaes_bitslice_ortho(q);
+        cc_memcpy(&ks->sk[8 * i], q, sizeof(q));
+    }
+
+    cc_clear(sizeof(q), q);
+    return 0;
+}
+
+static void ccaes_bitslice_load(uint64_t *q, size_t nblocks, const uint8_t *in)
+{
+    uint32_t w[4 * CCAES_BITSLICE_NBLOCKS] = { 0 };
+
+    for (size_t i = 0; i < 4 * nblocks; i++) {
+        w[i] = CC_READ_LE32(in + 4 * i);
+    }
+    for (int i = 0; i < CCAES_BITSLICE_NBLOCKS; i++) {
+        ccaes_bitslice_interleave_in(&q[i], &q[i + 4], &w[4 * i]);
+    }
+    ccaes_bitslice_ortho(q);
+
+    cc_clear(sizeof(w), w);
+}
+
+static void ccaes_bitslice_store(uint8_t *out, size_t nblocks, uint64_t *q)
+{
+    uint32_t w[4 * CCAES_BITSLICE_NBLOCKS];
+
+    ccaes_bitslice_ortho(q);
+    for (int i = 0; i < CCAES_BITSLICE_NBLOCKS; i++) {
+        ccaes_bitslice_interleave_out(&w[4 * i], q[i], q[i + 4]);
+    }
+    for (size_t i = 0; i < 4 * nblocks; i++) {
+        CC_WRITE_LE32(out + 4 * i, w[i]);
+    }
+
+    cc_clear(sizeof(w), w);
+}
+
+void ccaes_bitslice_encrypt(const ccaes_bitslice_keysched *ks, size_t nblocks, const uint8_t *in, uint8_t *out)
+{
+    const uint64_t *sk = ks->sk;
+    uint64_t q[8];
+
+    while (nblocks) {
+        size_t n = CC_MIN(nblocks, (size_t)CCAES_BITSLICE_NBLOCKS);
+
+        ccaes_bitslice_load(q, n, in);
+
+        ccaes_bitslice_add_round_key(q, sk);
+        for (uint32_t r = 1; r < ks->nrounds; r++) {
+            ccaes_bitslice_sbox(q);
+            ccaes_bitslice_shift_rows(q);
+            ccaes_bitslice_mix_columns(q);
+            ccaes_bitslice_add_round_key(q, sk + 8 * r);
+        }
+        ccaes_bitslice_sbox(q);
+        ccaes_bitslice_shift_rows(q);
+        ccaes_bitslice_add_round_key(q, sk + 8 * ks->nrounds);
+
+        ccaes_bitslice_store(out, n, q);
+
+        nblocks -= n;
+        in += n * CCAES_BLOCK_SIZE;
+        out += n * CCAES_BLOCK_SIZE;
+    }
+
+    cc_clear(sizeof(q), q);
+}
+
+void ccaes_bitslice_decrypt(const ccaes_bitslice_keysched *ks, size_t nblocks, const uint8_t *in, uint8_t *out)
+{
+    const uint64_t *sk = ks->sk;
+    uint64_t q[8];
+
+    while (nblocks) {
+        size_t n = CC_MIN(nblocks, (size_t)CCAES_BITSLICE_NBLOCKS);
+
+        ccaes_bitslice_load(q, n, in);
+
+        ccaes_bitslice_add_round_key(q, sk + 8 * ks->nrounds);
+        for (uint32_t r = ks->nrounds - 1; r > 0; r--) {
+            ccaes_bitslice_inv_shift_rows(q);
+            ccaes_bitslice_inv_sbox(q);
+            ccaes_bitslice_add_round_key(q, sk + 8 * r);
+            ccaes_bitslice_inv_mix_columns(q);
+        }
+        ccaes_bitslice_inv_shift_rows(q);
+        ccaes_bitslice_inv_sbox(q);
+        ccaes_bitslice_add_round_key(q, sk);
+
+        ccaes_bitslice_store(out, n, q);
+
+        nblocks -= n;
+        in += n * CCAES_BLOCK_SIZE;
+        out += n * CCAES_BLOCK_SIZE;
+    }
+
+    cc_clear(sizeof(q), q);
+}
+
+#endif /* !CC_KERNEL || !CC_USE_ASM */
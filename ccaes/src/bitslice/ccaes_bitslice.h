@@ -0,0 +1,42 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#ifndef _CORECRYPTO_CCAES_BITSLICE_H_
+#define _CORECRYPTO_CCAES_BITSLICE_H_
+
+#include <corecrypto/ccaes.h>
+
+#include "../ltc/ccaes_ltc_common.h"
+
+/* Constant-time bitsliced AES, four blocks at a time in 64-bit words.
+ *
+ * The context starts with an LTC key schedule, which is used for
+ * single-block calls (and keeps the context usable wherever an LTC key is
+ * expected), followed by the bitsliced encryption round keys. Decryption
+ * runs the inverse rounds over the same bitsliced round keys. */
+
+#define CCAES_BITSLICE_NBLOCKS 4
+
+/* Calls with fewer blocks than this use the LTC implementation. */
+#define CCAES_BITSLICE_MIN_NBLOCKS 2
+
+typedef struct {
+    ltc_rijndael_keysched ltc;
+    uint64_t sk[8 * 15];
+    uint32_t nrounds;
+} ccaes_bitslice_keysched;
+
+int ccaes_bitslice_init(const struct ccmode_ecb *ecb, ccecb_ctx *key, size_t rawkey_len, const void *rawkey);
+
+void ccaes_bitslice_encrypt(const ccaes_bitslice_keysched *ks, size_t nblocks, const uint8_t *in, uint8_t *out);
+void ccaes_bitslice_decrypt(const ccaes_bitslice_keysched *ks, size_t nblocks, const uint8_t *in, uint8_t *out);
+
+#endif /* _CORECRYPTO_CCAES_BITSLICE_H_ */
@@ -0,0 +1,37 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/ccaes.h>
+#include <corecrypto/cc_priv.h>
+
+#if !CC_KERNEL || !CC_USE_ASM
+
+#include "ccaes_bitslice.h"
+
+static int ccaes_bitslice_ecb_encrypt(const ccecb_ctx *key, size_t nblocks, const void *in, void *out)
+{
+    if (nblocks < CCAES_BITSLICE_MIN_NBLOCKS) {
+        return ccaes_ltc_ecb_encrypt_mode.ecb(key, nblocks, in, out);
+    }
+
+    ccaes_bitslice_encrypt((const ccaes_bitslice_keysched *)key, nblocks, in, out);
+    return 0;
+}
+
+const struct ccmode_ecb ccaes_bitslice_ecb_encrypt_mode = {
+    .size = sizeof(ccaes_bitslice_keysched),
+    .block_size = CCAES_BLOCK_SIZE,
+    .init = ccaes_bitslice_init,
+    .ecb = ccaes_bitslice_ecb_encrypt,
+    .roundkey = ccaes_ecb_encrypt_roundkey,
+};
+
+#endif
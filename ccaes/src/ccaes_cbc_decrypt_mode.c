@@ -18,6 +18,15 @@
 #error "Must use CC_READ_ONLY_LATE with CC_KERNEL=1"
 #endif
 
+#if !CCAES_INTEL_ASM && !CCAES_MUX && !CCAES_ARM_ASM && CC_SMALL_CODE
+static struct ccmode_cbc cbc_decrypt;
+
+static void cbc_decrypt_init(void)
+{
+    ccmode_factory_cbc_decrypt(&cbc_decrypt, ccaes_ecb_decrypt_mode());
+}
+#endif
+
 const struct ccmode_cbc *ccaes_cbc_decrypt_mode(void)
 {
 #if CCAES_INTEL_ASM
@@ -27,9 +36,10 @@ const struct ccmode_cbc *ccaes_cbc_decrypt_mode(void)
 #elif CCAES_ARM_ASM
     return &ccaes_arm_cbc_decrypt_mode;
 #elif CC_SMALL_CODE
-    static struct ccmode_cbc cbc;
-    ccmode_factory_cbc_decrypt(&cbc, ccaes_ecb_decrypt_mode());
-    return &cbc;
+    CC_DESCRIPTOR_ONCE(cbc_decrypt_init);
+    return &cbc_decrypt;
+#elif CCAES_AESNI_INTRINSICS
+    return (CC_HAS_AESNI() ? &ccaes_aesni_cbc_decrypt_mode : &ccaes_gladman_cbc_decrypt_mode);
 #else
     return &ccaes_gladman_cbc_decrypt_mode;
 #endif
@@ -20,6 +20,15 @@
 #error "Must use CC_READ_ONLY_LATE with CC_KERNEL=1"
 #endif
 
+#if !CCAES_INTEL_ASM && !CCAES_MUX && !CCAES_ARM_ASM && CC_SMALL_CODE
+static struct ccmode_cbc cbc_encrypt;
+
+static void cbc_encrypt_init(void)
+{
+    ccmode_factory_cbc_encrypt(&cbc_encrypt, ccaes_ecb_encrypt_mode());
+}
+#endif
+
 const struct ccmode_cbc *ccaes_cbc_encrypt_mode(void)
 {
     FIPSPOST_TRACE_EVENT;
@@ -31,9 +40,10 @@ const struct ccmode_cbc *ccaes_cbc_encrypt_mode(void)
 #elif CCAES_ARM_ASM
     return &ccaes_arm_cbc_encrypt_mode;
 #elif CC_SMALL_CODE
-    static struct ccmode_cbc cbc;
-    ccmode_factory_cbc_encrypt(&cbc, ccaes_ecb_encrypt_mode());
-    return &cbc;
+    CC_DESCRIPTOR_ONCE(cbc_encrypt_init);
+    return &cbc_encrypt;
+#elif CCAES_AESNI_INTRINSICS
+    return (CC_HAS_AESNI() ? &ccaes_aesni_cbc_encrypt_mode : &ccaes_gladman_cbc_encrypt_mode);
 #else
     return &ccaes_gladman_cbc_encrypt_mode;
 #endif
@@ -15,14 +15,17 @@
 
 static CC_READ_ONLY_LATE(struct ccmode_ccm) ccm_decrypt;
 
-const struct ccmode_ccm *ccaes_ccm_decrypt_mode(void)
+static void ccm_decrypt_init(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == ccm_decrypt.init) {
 #if CCMODE_CCM_VNG_SPEEDUP
-        ccaes_vng_ccm_decrypt_mode_setup(&ccm_decrypt);
+    ccaes_vng_ccm_decrypt_mode_setup(&ccm_decrypt);
 #else
-        ccmode_factory_ccm_decrypt(&ccm_decrypt, ccaes_ecb_encrypt_mode());
+    ccmode_factory_ccm_decrypt(&ccm_decrypt, ccaes_ecb_encrypt_mode());
 #endif
-    }
+}
+
+const struct ccmode_ccm *ccaes_ccm_decrypt_mode(void)
+{
+    CC_DESCRIPTOR_ONCE(ccm_decrypt_init);
     return &ccm_decrypt;
 }
@@ -15,14 +15,17 @@
 
 static CC_READ_ONLY_LATE(struct ccmode_ccm ccm_encrypt);
 
-const struct ccmode_ccm *ccaes_ccm_encrypt_mode(void)
+static void ccm_encrypt_init(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == ccm_encrypt.init) {
 #if CCMODE_CCM_VNG_SPEEDUP
-        ccaes_vng_ccm_encrypt_mode_setup(&ccm_encrypt);
+    ccaes_vng_ccm_encrypt_mode_setup(&ccm_encrypt);
 #else
-        ccmode_factory_ccm_encrypt(&ccm_encrypt, ccaes_ecb_encrypt_mode());
+    ccmode_factory_ccm_encrypt(&ccm_encrypt, ccaes_ecb_encrypt_mode());
 #endif
-    }
+}
+
+const struct ccmode_ccm *ccaes_ccm_encrypt_mode(void)
+{
+    CC_DESCRIPTOR_ONCE(ccm_encrypt_init);
     return &ccm_encrypt;
 }
@@ -15,6 +15,12 @@
 
 #if !CCAES_ARM_ASM
 static  CC_READ_ONLY_LATE(struct ccmode_cfb) cfb_decrypt;
+
+static void cfb_decrypt_init(void)
+{
+    const struct ccmode_ecb *ecb = ccaes_ecb_encrypt_mode();
+    ccmode_factory_cfb_decrypt(&cfb_decrypt, ecb);
+}
 #endif
 
 const struct ccmode_cfb *ccaes_cfb_decrypt_mode(void)
@@ -22,10 +28,7 @@ const struct ccmode_cfb *ccaes_cfb_decrypt_mode(void)
 #if CCAES_ARM_ASM
     return &ccaes_arm_cfb_decrypt_mode;
 #else
-    if (!CC_CACHE_DESCRIPTORS || NULL == cfb_decrypt.init) {
-        const struct ccmode_ecb *ecb = ccaes_ecb_encrypt_mode();
-        ccmode_factory_cfb_decrypt(&cfb_decrypt, ecb);
-    }
+    CC_DESCRIPTOR_ONCE(cfb_decrypt_init);
     return &cfb_decrypt;
 #endif
 }
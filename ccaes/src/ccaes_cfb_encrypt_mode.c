@@ -15,6 +15,12 @@
 
 #if !CCAES_ARM_ASM
 static CC_READ_ONLY_LATE(struct ccmode_cfb) cfb_encrypt;
+
+static void cfb_encrypt_init(void)
+{
+    const struct ccmode_ecb *ecb = ccaes_ecb_encrypt_mode();
+    ccmode_factory_cfb_encrypt(&cfb_encrypt, ecb);
+}
 #endif
 
 const struct ccmode_cfb *ccaes_cfb_encrypt_mode(void)
@@ -22,10 +28,7 @@ const struct ccmode_cfb *ccaes_cfb_encrypt_mode(void)
 #if CCAES_ARM_ASM
     return &ccaes_arm_cfb_encrypt_mode;
 #else
-    if (!CC_CACHE_DESCRIPTORS || NULL == cfb_encrypt.init) {
-        const struct ccmode_ecb *ecb = ccaes_ecb_encrypt_mode();
-        ccmode_factory_cfb_encrypt(&cfb_encrypt, ecb);
-    }
+    CC_DESCRIPTOR_ONCE(cfb_encrypt_init);
     return &cfb_encrypt;
 #endif
 }
@@ -11,20 +11,29 @@
 
 #include <corecrypto/ccaes.h>
 #include <corecrypto/ccmode_internal.h>
+#include <corecrypto/cc_runtime_config.h>
 #include "ccaes_vng_ctr.h"
 
 static CC_READ_ONLY_LATE(struct ccmode_ctr) ctr_crypt;
 
-const struct ccmode_ctr *ccaes_ctr_crypt_mode(void)
+static void ctr_crypt_init(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == ctr_crypt.init) {
 #if CCAES_MUX
-        ctr_crypt = *ccaes_ios_mux_ctr_crypt_mode();
+    ctr_crypt = *ccaes_ios_mux_ctr_crypt_mode();
 #elif CCMODE_CTR_VNG_SPEEDUP
-        ccaes_vng_ctr_crypt_mode_setup(&ctr_crypt);
+    ccaes_vng_ctr_crypt_mode_setup(&ctr_crypt);
 #else
-        ccmode_factory_ctr_crypt(&ctr_crypt, ccaes_ecb_encrypt_mode());
+    ccmode_factory_ctr_crypt(&ctr_crypt, ccaes_ecb_encrypt_mode());
 #endif
+}
+
+const struct ccmode_ctr *ccaes_ctr_crypt_mode(void)
+{
+#if CCAES_AESNI_INTRINSICS
+    if (CC_HAS_AESNI()) {
+        return &ccaes_aesni_ctr_crypt_mode;
     }
+#endif
+    CC_DESCRIPTOR_ONCE(ctr_crypt_init);
     return &ctr_crypt;
 }
@@ -18,7 +18,9 @@ const struct ccmode_ecb *ccaes_ecb_decrypt_mode(void)
     return (CC_HAS_AESNI() ? &ccaes_intel_ecb_decrypt_aesni_mode : &ccaes_intel_ecb_decrypt_opt_mode);
 #elif CCAES_ARM_ASM
     return &ccaes_arm_ecb_decrypt_mode;
+#elif CCAES_AESNI_INTRINSICS
+    return (CC_HAS_AESNI() ? &ccaes_aesni_ecb_decrypt_mode : &ccaes_bitslice_ecb_decrypt_mode);
 #else
-    return &ccaes_ltc_ecb_decrypt_mode;
+    return &ccaes_bitslice_ecb_decrypt_mode;
 #endif
 }
@@ -22,7 +22,9 @@ const struct ccmode_ecb *ccaes_ecb_encrypt_mode(void)
     return (CC_HAS_AESNI() ? &ccaes_intel_ecb_encrypt_aesni_mode : &ccaes_intel_ecb_encrypt_opt_mode);
 #elif CCAES_ARM_ASM
     return &ccaes_arm_ecb_encrypt_mode;
+#elif CCAES_AESNI_INTRINSICS
+    return (CC_HAS_AESNI() ? &ccaes_aesni_ecb_encrypt_mode : &ccaes_bitslice_ecb_encrypt_mode);
 #else
-    return &ccaes_ltc_ecb_encrypt_mode;
+    return &ccaes_bitslice_ecb_encrypt_mode;
 #endif
 }
@@ -12,17 +12,23 @@
 #include <corecrypto/ccaes.h>
 #include "ccaes_vng_gcm.h"
 #include <corecrypto/ccmode_internal.h>
+#include "aesni/ccaes_aesni.h"
 
 static CC_READ_ONLY_LATE(struct ccmode_gcm) gcm_decrypt;
 
-const struct ccmode_gcm *ccaes_gcm_decrypt_mode(void)
+static void gcm_decrypt_init(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == gcm_decrypt.init) {
 #if CCMODE_GCM_VNG_SPEEDUP
-        ccaes_vng_factory_gcm_decrypt(&gcm_decrypt);
+    ccaes_vng_factory_gcm_decrypt(&gcm_decrypt);
+#elif CCAES_AESNI_INTRINSICS
+    ccaes_aesni_factory_gcm_decrypt(&gcm_decrypt);
 #else
-        ccmode_factory_gcm_decrypt(&gcm_decrypt, ccaes_ecb_encrypt_mode());
+    ccmode_factory_gcm_decrypt(&gcm_decrypt, ccaes_ecb_encrypt_mode());
 #endif
-    }
+}
+
+const struct ccmode_gcm *ccaes_gcm_decrypt_mode(void)
+{
+    CC_DESCRIPTOR_ONCE(gcm_decrypt_init);
     return &gcm_decrypt;
 }
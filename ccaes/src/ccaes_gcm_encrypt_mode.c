@@ -12,17 +12,23 @@
 #include <corecrypto/ccaes.h>
 #include "ccaes_vng_gcm.h"
 #include <corecrypto/ccmode_internal.h>
+#include "aesni/ccaes_aesni.h"
 
 static CC_READ_ONLY_LATE(struct ccmode_gcm) gcm_encrypt;
 
-const struct ccmode_gcm *ccaes_gcm_encrypt_mode(void)
+static void gcm_encrypt_init(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == gcm_encrypt.init) {
 #if CCMODE_GCM_VNG_SPEEDUP
-        ccaes_vng_factory_gcm_encrypt(&gcm_encrypt);
+    ccaes_vng_factory_gcm_encrypt(&gcm_encrypt);
+#elif CCAES_AESNI_INTRINSICS
+    ccaes_aesni_factory_gcm_encrypt(&gcm_encrypt);
 #else
-        ccmode_factory_gcm_encrypt(&gcm_encrypt, ccaes_ecb_encrypt_mode());
+    ccmode_factory_gcm_encrypt(&gcm_encrypt, ccaes_ecb_encrypt_mode());
 #endif
-    }
+}
+
+const struct ccmode_gcm *ccaes_gcm_encrypt_mode(void)
+{
+    CC_DESCRIPTOR_ONCE(gcm_encrypt_init);
     return &gcm_encrypt;
 }
@@ -15,6 +15,12 @@
 
 #if !CCAES_ARM_ASM
 static CC_READ_ONLY_LATE(struct ccmode_ofb) ofb_crypt;
+
+static void ofb_crypt_init(void)
+{
+    const struct ccmode_ecb *ecb = ccaes_ecb_encrypt_mode();
+    ccmode_factory_ofb_crypt(&ofb_crypt, ecb);
+}
 #endif
 
 const struct ccmode_ofb *ccaes_ofb_crypt_mode(void)
@@ -22,10 +28,7 @@ const struct ccmode_ofb *ccaes_ofb_crypt_mode(void)
 #if CCAES_ARM_ASM
     return &ccaes_arm_ofb_crypt_mode;
 #else
-    if (!CC_CACHE_DESCRIPTORS || NULL == ofb_crypt.init) {
-        const struct ccmode_ecb *ecb = ccaes_ecb_encrypt_mode();
-        ccmode_factory_ofb_crypt(&ofb_crypt, ecb);
-    }
+    CC_DESCRIPTOR_ONCE(ofb_crypt_init);
     return &ofb_crypt;
 #endif
 }
@@ -15,10 +15,13 @@
 
 static CC_READ_ONLY_LATE(struct ccmode_siv) siv_decrypt;
 
+static void siv_decrypt_init(void)
+{
+    ccmode_factory_siv_decrypt(&siv_decrypt, ccaes_cbc_encrypt_mode(), ccaes_ctr_crypt_mode());
+}
+
 const struct ccmode_siv *ccaes_siv_decrypt_mode(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == siv_decrypt.init) {
-        ccmode_factory_siv_decrypt(&siv_decrypt, ccaes_cbc_encrypt_mode(), ccaes_ctr_crypt_mode());
-    }
+    CC_DESCRIPTOR_ONCE(siv_decrypt_init);
     return &siv_decrypt;
 }
@@ -15,10 +15,13 @@
 
 static CC_READ_ONLY_LATE(struct ccmode_siv) siv_encrypt;
 
+static void siv_encrypt_init(void)
+{
+    ccmode_factory_siv_encrypt(&siv_encrypt, ccaes_cbc_encrypt_mode(), ccaes_ctr_crypt_mode());
+}
+
 const struct ccmode_siv *ccaes_siv_encrypt_mode(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == siv_encrypt.init) {
-        ccmode_factory_siv_encrypt(&siv_encrypt, ccaes_cbc_encrypt_mode(), ccaes_ctr_crypt_mode());
-    }
+    CC_DESCRIPTOR_ONCE(siv_encrypt_init);
     return &siv_encrypt;
 }
@@ -15,10 +15,13 @@
 
 static struct ccmode_siv_hmac siv_hmac_decrypt;
 
+static void siv_hmac_decrypt_init(void)
+{
+    ccmode_factory_siv_hmac_decrypt(&siv_hmac_decrypt, ccsha256_di(), ccaes_ctr_crypt_mode());
+}
+
 const struct ccmode_siv_hmac *ccaes_siv_hmac_sha256_decrypt_mode(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == siv_hmac_decrypt.init) {
-        ccmode_factory_siv_hmac_decrypt(&siv_hmac_decrypt, ccsha256_di(), ccaes_ctr_crypt_mode());
-    }
+    CC_DESCRIPTOR_ONCE(siv_hmac_decrypt_init);
     return &siv_hmac_decrypt;
 }
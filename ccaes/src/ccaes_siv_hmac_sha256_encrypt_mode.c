@@ -15,10 +15,13 @@
 
 static struct ccmode_siv_hmac siv_hmac_encrypt;
 
-const struct ccmode_siv_hmac *ccaes_siv_hmac_sha256_encrypt_mode(void)
+static void siv_hmac_encrypt_init(void)
 {
-    if (!CC_CACHE_DESCRIPTORS || NULL == siv_hmac_encrypt.init) {
     ccmode_factory_siv_hmac_encrypt(&siv_hmac_encrypt, ccsha256_di(), ccaes_ctr_crypt_mode());
-    }
+}
+
+const struct ccmode_siv_hmac *ccaes_siv_hmac_sha256_encrypt_mode(void)
+{
+    CC_DESCRIPTOR_ONCE(siv_hmac_encrypt_init);
     return &siv_hmac_encrypt;
 }
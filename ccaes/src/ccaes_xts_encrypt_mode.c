@@ -17,6 +17,13 @@
 
 #if !CCAES_INTEL_ASM && !CCAES_ARM_ASM
 static CC_READ_ONLY_LATE(struct ccmode_xts) xts_encrypt;
+
+static void xts_encrypt_init(void)
+{
+    const struct ccmode_ecb *ecb_base_mode = ccaes_ecb_encrypt_mode();
+    const struct ccmode_ecb *ecb_base_encrypt_mode = ccaes_ecb_encrypt_mode();
+    ccmode_factory_xts_encrypt(&xts_encrypt, ecb_base_mode, ecb_base_encrypt_mode);
+}
 #endif
 
 const struct ccmode_xts *ccaes_xts_encrypt_mode(void)
@@ -28,11 +35,12 @@ const struct ccmode_xts *ccaes_xts_encrypt_mode(void)
 #elif CCAES_ARM_ASM
     return &ccaes_arm_xts_encrypt_mode;
 #else
-    if (!CC_CACHE_DESCRIPTORS || NULL == xts_encrypt.init) {
-        const struct ccmode_ecb *ecb_base_mode = ccaes_ecb_encrypt_mode();
-        const struct ccmode_ecb *ecb_base_encrypt_mode = ccaes_ecb_encrypt_mode();
-        ccmode_factory_xts_encrypt(&xts_encrypt, ecb_base_mode, ecb_base_encrypt_mode);
+#if CCAES_AESNI_INTRINSICS
+    if (CC_HAS_AESNI()) {
+        return &ccaes_aesni_xts_encrypt_mode;
     }
+#endif
+    CC_DESCRIPTOR_ONCE(xts_encrypt_init);
     return &xts_encrypt;
 #endif
 }
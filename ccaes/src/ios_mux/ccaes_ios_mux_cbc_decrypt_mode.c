@@ -14,6 +14,7 @@
 #if CCAES_MUX
 
 #include "ccaes_ios_mux_cbc.h"
+#include "ccmode_internal.h"
 
 const struct ccmode_cbc *small_cbc_decrypt = &ccaes_arm_cbc_decrypt_mode;
 const struct ccmode_cbc *large_cbc_decrypt = &ccaes_ios_hardware_cbc_decrypt_mode;
@@ -56,19 +57,24 @@ ccaes_ios_mux_cbc_decrypt(const cccbc_ctx *cbcctx, cccbc_iv *iv, size_t nblocks,
 }
 
 
-const struct ccmode_cbc *ccaes_ios_mux_cbc_decrypt_mode()
+static struct ccmode_cbc ccaes_ios_mux_cbc_decrypt_mode_desc;
+
+static void ccaes_ios_mux_cbc_decrypt_mode_init(void)
 {
-    static struct ccmode_cbc ccaes_ios_mux_cbc_decrypt_mode;
+    ccaes_ios_mux_cbc_decrypt_mode_desc.size = small_cbc_decrypt->size + large_cbc_decrypt->size + CCAES_BLOCK_SIZE;
+    ccaes_ios_mux_cbc_decrypt_mode_desc.block_size = CCAES_BLOCK_SIZE;
+    ccaes_ios_mux_cbc_decrypt_mode_desc.init = ccaes_ios_mux_cbc_decrypt_init;
+    ccaes_ios_mux_cbc_decrypt_mode_desc.cbc = ccaes_ios_mux_cbc_decrypt;
+    ccaes_ios_mux_cbc_decrypt_mode_desc.custom = NULL;
+}
 
+const struct ccmode_cbc *ccaes_ios_mux_cbc_decrypt_mode(void)
+{
     // Check support and performance of HW
     if (!ccaes_ios_hardware_enabled(CCAES_HW_DECRYPT|CCAES_HW_CBC)) return small_cbc_decrypt;
 
-    ccaes_ios_mux_cbc_decrypt_mode.size = small_cbc_decrypt->size + large_cbc_decrypt->size + CCAES_BLOCK_SIZE;
-    ccaes_ios_mux_cbc_decrypt_mode.block_size = CCAES_BLOCK_SIZE;
-    ccaes_ios_mux_cbc_decrypt_mode.init = ccaes_ios_mux_cbc_decrypt_init;
-    ccaes_ios_mux_cbc_decrypt_mode.cbc = ccaes_ios_mux_cbc_decrypt;
-    ccaes_ios_mux_cbc_decrypt_mode.custom = NULL;
-    return &ccaes_ios_mux_cbc_decrypt_mode;
+    CC_DESCRIPTOR_ONCE(ccaes_ios_mux_cbc_decrypt_mode_init);
+    return &ccaes_ios_mux_cbc_decrypt_mode_desc;
 }
 
 
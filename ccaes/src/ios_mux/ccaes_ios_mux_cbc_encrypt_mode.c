@@ -14,6 +14,7 @@
 #if CCAES_MUX
 
 #include "ccaes_ios_mux_cbc.h"
+#include "ccmode_internal.h"
 
 const struct ccmode_cbc *small_cbc_encrypt = &ccaes_arm_cbc_encrypt_mode;
 const struct ccmode_cbc *large_cbc_encrypt = &ccaes_ios_hardware_cbc_encrypt_mode;
@@ -56,21 +57,25 @@ ccaes_ios_mux_cbc_encrypt(const cccbc_ctx *cbcctx, cccbc_iv *iv, size_t nblocks,
 }
 
 
-const struct ccmode_cbc *ccaes_ios_mux_cbc_encrypt_mode(void)
+static struct ccmode_cbc ccaes_ios_mux_cbc_encrypt_mode_desc;
+
+static void ccaes_ios_mux_cbc_encrypt_mode_init(void)
 {
-    static struct ccmode_cbc ccaes_ios_mux_cbc_encrypt_mode;
+    ccaes_ios_mux_cbc_encrypt_mode_desc.size = small_cbc_encrypt->size + large_cbc_encrypt->size + CCAES_BLOCK_SIZE;
+    ccaes_ios_mux_cbc_encrypt_mode_desc.block_size = CCAES_BLOCK_SIZE;
+    ccaes_ios_mux_cbc_encrypt_mode_desc.init = ccaes_ios_mux_cbc_encrypt_init;
+    ccaes_ios_mux_cbc_encrypt_mode_desc.cbc = ccaes_ios_mux_cbc_encrypt;
+    ccaes_ios_mux_cbc_encrypt_mode_desc.custom = NULL;
+}
 
+const struct ccmode_cbc *ccaes_ios_mux_cbc_encrypt_mode(void)
+{
     // Check support and performance of HW
     if (!ccaes_ios_hardware_enabled(CCAES_HW_ENCRYPT|CCAES_HW_CBC)) return small_cbc_encrypt;
 
-    ccaes_ios_mux_cbc_encrypt_mode.size = small_cbc_encrypt->size + large_cbc_encrypt->size + CCAES_BLOCK_SIZE;
-    ccaes_ios_mux_cbc_encrypt_mode.block_size = CCAES_BLOCK_SIZE;
-    ccaes_ios_mux_cbc_encrypt_mode.init = ccaes_ios_mux_cbc_encrypt_init;
-    ccaes_ios_mux_cbc_encrypt_mode.cbc = ccaes_ios_mux_cbc_encrypt;
-    ccaes_ios_mux_cbc_encrypt_mode.custom = NULL;
-    return &ccaes_ios_mux_cbc_encrypt_mode;
+    CC_DESCRIPTOR_ONCE(ccaes_ios_mux_cbc_encrypt_mode_init);
+    return &ccaes_ios_mux_cbc_encrypt_mode_desc;
 }
 
 
-
 #endif /* CCAES_MUX */
@@ -15,6 +15,7 @@
 
 #include "ccaes_ios_mux_ctr.h"
 #include "ccaes_vng_ctr.h"
+#include "ccmode_internal.h"
 
 const struct ccmode_ctr *small_ctr_crypt = NULL; // Set at runtime
 const struct ccmode_ctr *large_ctr_crypt = &ccaes_ios_hardware_ctr_crypt_mode;
@@ -69,24 +70,31 @@ ccaes_ios_mux_ctr_crypt(ccctr_ctx *ctrctx, size_t nbytes, const void *in, void *
 }
 
 
+static struct ccmode_ctr ccaes_ios_mux_ctr_sw_mode;
+static struct ccmode_ctr ccaes_ios_mux_ctr_crypt_mode_desc;
+
+static void ccaes_ios_mux_ctr_crypt_mode_init(void)
+{
+    ccaes_vng_ctr_crypt_mode_setup(&ccaes_ios_mux_ctr_sw_mode);
+    small_ctr_crypt = &ccaes_ios_mux_ctr_sw_mode;
+
+    ccaes_ios_mux_ctr_crypt_mode_desc.size = small_ctr_crypt->size + large_ctr_crypt->size + CCAES_BLOCK_SIZE;
+    ccaes_ios_mux_ctr_crypt_mode_desc.block_size = 1;
+    ccaes_ios_mux_ctr_crypt_mode_desc.ecb_block_size = CCAES_BLOCK_SIZE;
+    ccaes_ios_mux_ctr_crypt_mode_desc.init = ccaes_ios_mux_crypt_init;
+    ccaes_ios_mux_ctr_crypt_mode_desc.setctr = ccmode_ctr_setctr;
+    ccaes_ios_mux_ctr_crypt_mode_desc.ctr = ccaes_ios_mux_ctr_crypt;
+    ccaes_ios_mux_ctr_crypt_mode_desc.custom = NULL;
+}
+
 const struct ccmode_ctr *ccaes_ios_mux_ctr_crypt_mode()
 {
-    static struct ccmode_ctr ccaes_ios_mux_ctr_crypt_mode;
-    static struct ccmode_ctr sw_mode;
-    ccaes_vng_ctr_crypt_mode_setup(&sw_mode);
-    small_ctr_crypt = &sw_mode;
+    CC_DESCRIPTOR_ONCE(ccaes_ios_mux_ctr_crypt_mode_init);
 
     // Check support and performance of HW
     if (!ccaes_ios_hardware_enabled(CCAES_HW_DECRYPT|CCAES_HW_CTR)) return small_ctr_crypt;
 
-    ccaes_ios_mux_ctr_crypt_mode.size = small_ctr_crypt->size + large_ctr_crypt->size + CCAES_BLOCK_SIZE;
-    ccaes_ios_mux_ctr_crypt_mode.block_size = 1;
-    ccaes_ios_mux_ctr_crypt_mode.ecb_block_size = CCAES_BLOCK_SIZE;
-    ccaes_ios_mux_ctr_crypt_mode.init = ccaes_ios_mux_crypt_init;
-    ccaes_ios_mux_ctr_crypt_mode.setctr = ccmode_ctr_setctr;
-    ccaes_ios_mux_ctr_crypt_mode.ctr = ccaes_ios_mux_ctr_crypt;
-    ccaes_ios_mux_ctr_crypt_mode.custom = NULL;
-    return &ccaes_ios_mux_ctr_crypt_mode;
+    return &ccaes_ios_mux_ctr_crypt_mode_desc;
 }
 
 
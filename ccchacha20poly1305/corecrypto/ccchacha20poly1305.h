@@ -15,6 +15,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <corecrypto/cc.h>
 
 #define CCCHACHA20_KEY_NBYTES 32
 #define CCCHACHA20_BLOCK_NBYTES 64
@@ -29,10 +30,29 @@ typedef struct {
 
 #define CCPOLY1305_TAG_NBYTES 16
 
+/* Size of the limbs of r and h. Their layout depends on the build, but the
+ size of the context does not. */
+#define CCPOLY1305_STATE_NBYTES 152
+
 typedef struct {
-	uint32_t r0, r1, r2, r3, r4;
-	uint32_t s1, s2, s3, s4;
-	uint32_t h0, h1, h2, h3, h4;
+	union {
+		struct {
+#if CCPOLY1305_64BIT
+			uint64_t r0, r1, r2;
+			uint64_t s1, s2;
+			uint64_t h0, h1, h2;
+#if CCCHACHA20_AVX_INTRINSICS
+			uint32_t rpow[4][5];	// r^4, r^3, r^2 and r in radix 2^26, computed on first use
+			bool rpow_valid;
+#endif
+#else
+			uint32_t r0, r1, r2, r3, r4;
+			uint32_t s1, s2, s3, s4;
+			uint32_t h0, h1, h2, h3, h4;
+#endif
+		};
+		uint64_t state[CCPOLY1305_STATE_NBYTES / sizeof(uint64_t)];
+	};
 	uint8_t	buf[16];
 	size_t buf_used;
 	uint8_t	key[16];
@@ -294,4 +314,114 @@ int ccchacha20poly1305_encrypt_oneshot(const struct ccchacha20poly1305_info *inf
  */
 int ccchacha20poly1305_decrypt_oneshot(const struct ccchacha20poly1305_info *info, const uint8_t *key, const uint8_t *nonce, size_t aad_nbytes, const void *aad, size_t ctext_nbytes, const void *ctext, void *ptext, const uint8_t *tag);
 
+/*!
+ @function   ccchacha20poly1305_encrypt_iov
+ @abstract   Encrypt and authenticate a scattered message.
+
+ @param      info       Descriptor for the mode
+ @param      ctx        Context for this instance
+ @param      aad_niov   Number of additional data fragments
+ @param      aad        Additional data to authenticate
+ @param      in_niov    Number of plaintext fragments
+ @param      in         Input plaintext
+ @param      out_niov   Number of ciphertext fragments
+ @param      out        Output ciphertext
+ @param      tag        Generated authentication tag
+
+ @result     0 iff successful.
+
+ @discussion Equivalent to calling @p ccchacha20poly1305_aad on each fragment of @p aad, @p ccchacha20poly1305_encrypt on the
+ plaintext and @p ccchacha20poly1305_finalize, on a context that was set up with @p ccchacha20poly1305_init and @p
+ ccchacha20poly1305_setnonce.
+
+ The fragments of @p in and @p out may be split at different offsets, but must add up to the same length. Blocks straddling
+ fragment boundaries are carried internally.
+
+ In-place processing is supported when @p out describes the same bytes as @p in.
+ */
+int ccchacha20poly1305_encrypt_iov(const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, size_t aad_niov, const struct cc_const_iovec *aad, size_t in_niov, const struct cc_const_iovec *in, size_t out_niov, const struct cc_iovec *out, uint8_t *tag);
+
+/*!
+ @function   ccchacha20poly1305_decrypt_iov
+ @abstract   Decrypt and verify a scattered message.
+
+ @param      info       Descriptor for the mode
+ @param      ctx        Context for this instance
+ @param      aad_niov   Number of additional data fragments
+ @param      aad        Additional data to authenticate
+ @param      in_niov    Number of ciphertext fragments
+ @param      in         Input ciphertext
+ @param      out_niov   Number of plaintext fragments
+ @param      out        Output plaintext
+ @param      tag        Expected authentication tag
+
+ @result     0 iff authentic and otherwise successful.
+
+ @discussion The decryption counterpart of @p ccchacha20poly1305_encrypt_iov, ending with @p ccchacha20poly1305_verify.
+
+ @warning The plaintext is written to @p out before the tag is checked. It must be discarded if authentication fails.
+ */
+int ccchacha20poly1305_decrypt_iov(const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, size_t aad_niov, const struct cc_const_iovec *aad, size_t in_niov, const struct cc_const_iovec *in, size_t out_niov, const struct cc_iovec *out, const uint8_t *tag);
+
+/*!
+ @struct     ccchacha20poly1305_record
+ @abstract   One record of a batch sealed or opened under a single key.
+
+ @field      nonce      Nonce of @p CCCHACHA20POLY1305_NONCE_NBYTES bytes
+ @field      aad_nbytes Length of the additional data in bytes
+ @field      aad        Additional data to authenticate
+ @field      nbytes     Length of the text in bytes
+ @field      in         Input text
+ @field      out        Output text, which may be the same as @p in
+ @field      tag        Authentication tag of @p CCCHACHA20POLY1305_TAG_NBYTES bytes, written by @p
+ ccchacha20poly1305_seal_batch and read by @p ccchacha20poly1305_open_batch
+ */
+struct ccchacha20poly1305_record {
+    const uint8_t *nonce;
+    size_t aad_nbytes;
+    const void *aad;
+    size_t nbytes;
+    const void *in;
+    void *out;
+    uint8_t *tag;
+};
+
+/*!
+ @function   ccchacha20poly1305_seal_batch
+ @abstract   Encrypt and authenticate many records under the same key.
+
+ @param      info       Descriptor for the mode
+ @param      key        Secret chacha20 key
+ @param      nrecords   Number of records
+ @param      records    Records to seal
+
+ @result     0 iff successful.
+
+ @discussion Each record gives the same result as @p ccchacha20poly1305_encrypt_oneshot with its own nonce. The key is loaded
+ once for the whole batch. On CPUs with AVX2, consecutive records of up to 4096 bytes are processed together: their
+ Poly1305 keys and keystream blocks share the SIMD lanes of each ChaCha20 call, and their tags are computed four records at
+ a time. Longer records are processed one at a time.
+
+ @warning The key-nonce pair must be unique per encryption.
+ */
+int ccchacha20poly1305_seal_batch(const struct ccchacha20poly1305_info *info, const uint8_t *key, size_t nrecords, const struct ccchacha20poly1305_record *records);
+
+/*!
+ @function   ccchacha20poly1305_open_batch
+ @abstract   Decrypt and verify many records under the same key.
+
+ @param      info       Descriptor for the mode
+ @param      key        Secret chacha20 key
+ @param      nrecords   Number of records
+ @param      records    Records to open
+ @param      results    Optional array of @p nrecords results, set to 0 or -1 if the record is not authentic, or to 1 for every
+                        record if the batch is rejected
+
+ @result     0 iff all records are authentic, -1 if at least one is not, 1 if a record is too long and none was processed.
+
+ @discussion The decryption counterpart of @p ccchacha20poly1305_seal_batch. Each record is authenticated before it is
+ decrypted, and the output of a record that fails authentication is cleared.
+ */
+int ccchacha20poly1305_open_batch(const struct ccchacha20poly1305_info *info, const uint8_t *key, size_t nrecords, const struct ccchacha20poly1305_record *records, int *results);
+
 #endif
@@ -18,6 +18,7 @@ entryPoint(ccchacha_test,"ccchacha test")
 #else
 #include <corecrypto/ccchacha20poly1305.h>
 #include <corecrypto/ccchacha20poly1305_priv.h>
+#include <corecrypto/cc_priv.h>
 
 static int verbose = 0;
 
@@ -80,6 +81,44 @@ static void test_chacha20(void) {
 	}
 }
 
+/* Long inputs take the wide kernels, while one block at a time always runs
+ the portable code; both must produce the same keystream. */
+static void test_chacha20_wide(void)
+{
+    static const size_t lengths[] = { 8 * 64, 16 * 64, 3 * 16 * 64 + 8 * 64 + 5 * 64 + 17 };
+    static const uint32_t counters[] = { 1, 0xfffffffa };
+    uint8_t key[CCCHACHA20_KEY_NBYTES], nonce[CCCHACHA20_NONCE_NBYTES];
+    uint8_t in[3 * 16 * 64 + 8 * 64 + 5 * 64 + 17], out[sizeof(in)], expected[sizeof(in)];
+    ccchacha20_ctx ctx;
+
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(i * 7 + 1);
+    }
+    for (size_t i = 0; i < sizeof(nonce); i++) {
+        nonce[i] = (uint8_t)(i * 13 + 5);
+    }
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(i * 31);
+    }
+
+    for (size_t c = 0; c < CC_ARRAY_LEN(counters); c++) {
+        for (size_t l = 0; l < CC_ARRAY_LEN(lengths); l++) {
+            size_t nbytes = lengths[l];
+
+            ccchacha20_init(&ctx, key);
+            ccchacha20_setnonce(&ctx, nonce);
+            ccchacha20_setcounter(&ctx, counters[c]);
+            for (size_t off = 0; off < nbytes; off += CCCHACHA20_BLOCK_NBYTES) {
+                ccchacha20_update(&ctx, CC_MIN(nbytes - off, (size_t)CCCHACHA20_BLOCK_NBYTES), in + off, expected + off);
+            }
+            ccchacha20_final(&ctx);
+
+            ccchacha20(key, nonce, counters[c], nbytes, in, out);
+            ok_memcmp(out, expected, nbytes, "Check chacha20 of %zu bytes from counter %u", nbytes, counters[c]);
+        }
+    }
+}
+
 typedef struct {
 	const char *	key;
 	const char *	input;
@@ -134,6 +173,37 @@ static void test_poly1305(void) {
 	}
 }
 
+/* Long inputs take the vector path, while 16 bytes at a time always runs the
+ scalar code. The all-ones key and message push every limb to its bound. */
+static void test_poly1305_wide(void)
+{
+    static const size_t lengths[] = { 256, 1000, 4096 + 15 };
+    uint8_t key[32], msg[4096 + 15], tag[CCPOLY1305_TAG_NBYTES], expected[CCPOLY1305_TAG_NBYTES];
+    ccpoly1305_ctx ctx;
+
+    for (int ones = 0; ones < 2; ones++) {
+        for (size_t i = 0; i < sizeof(key); i++) {
+            key[i] = ones ? 0xff : (uint8_t)(i * 11 + 3);
+        }
+        for (size_t i = 0; i < sizeof(msg); i++) {
+            msg[i] = ones ? 0xff : (uint8_t)(i * 29 + 7);
+        }
+
+        for (size_t l = 0; l < CC_ARRAY_LEN(lengths); l++) {
+            size_t nbytes = lengths[l];
+
+            ccpoly1305_init(&ctx, key);
+            for (size_t off = 0; off < nbytes; off += 16) {
+                ccpoly1305_update(&ctx, CC_MIN(nbytes - off, (size_t)16), msg + off);
+            }
+            ccpoly1305_final(&ctx, expected);
+
+            ccpoly1305(key, nbytes, msg, tag);
+            ok_memcmp(tag, expected, sizeof(tag), "Check poly1305 of %zu bytes with %s key", nbytes, ones ? "all-ones" : "patterned");
+        }
+    }
+}
+
 typedef struct {
 	const char *	key;
 	const char *	nonce;
@@ -294,14 +364,245 @@ static int test_chacha20poly1305_counter_wrap(void)
     return 1;
 }
 
+/* Split buf into fragments whose sizes cycle through sizes[], which may
+ include zero-length fragments. Returns the number of fragments used. */
+static size_t chacha20poly1305_iov_split(const uint8_t *buf, size_t nbytes, size_t nsizes, const size_t *sizes,
+                                         size_t max_niov, struct cc_const_iovec *iov)
+{
+    size_t niov = 0;
+
+    for (size_t k = 0; nbytes > 0 && niov < max_niov - 1; k++) {
+        size_t n = CC_MIN(sizes[k % nsizes], nbytes);
+        iov[niov].base = buf;
+        iov[niov].nbytes = n;
+        buf += n;
+        nbytes -= n;
+        niov++;
+    }
+
+    iov[niov].base = buf;
+    iov[niov].nbytes = nbytes;
+    return niov + 1;
+}
+
+/* Same split, for an output buffer. */
+static size_t chacha20poly1305_iov_split_out(uint8_t *buf, size_t nbytes, size_t nsizes, const size_t *sizes,
+                                             size_t max_niov, struct cc_iovec *iov)
+{
+    struct cc_const_iovec split[64];
+    size_t niov = chacha20poly1305_iov_split(buf, nbytes, nsizes, sizes, CC_MIN(max_niov, CC_ARRAY_LEN(split)), split);
+
+    for (size_t i = 0; i < niov; i++) {
+        iov[i].base = buf + ((const uint8_t *)split[i].base - buf);
+        iov[i].nbytes = split[i].nbytes;
+    }
+    return niov;
+}
+
+static void test_chacha20poly1305_iov(void)
+{
+    static const size_t in_sizes[] = { 1, 0, 7, 64, 33, 5, 128, 200 };
+    static const size_t out_sizes[] = { 13, 48, 0, 3, 129 };
+    static const size_t aad_sizes[] = { 0, 5, 11 };
+    static const size_t lengths[] = { 0, 15, 517 };
+
+    uint8_t key[CCCHACHA20_KEY_NBYTES], nonce[CCCHACHA20_NONCE_NBYTES], aad[40];
+    uint8_t pt[517], ct[517], ct_iov[517], pt_iov[517];
+    uint8_t tag[CCPOLY1305_TAG_NBYTES], tag_iov[CCPOLY1305_TAG_NBYTES];
+    struct cc_const_iovec aad_iov[8], in_iov[64];
+    struct cc_iovec out_iov[64];
+    size_t aad_niov, in_niov = 0, out_niov = 0;
+    const struct ccchacha20poly1305_info *info = ccchacha20poly1305_info();
+    ccchacha20poly1305_ctx state;
+    int err;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0x11 * i);
+    for (size_t i = 0; i < sizeof(nonce); i++) nonce[i] = (uint8_t)(0xa5 ^ i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(3 * i + 1);
+    for (size_t i = 0; i < sizeof(pt); i++) pt[i] = (uint8_t)(7 * i);
+
+    aad_niov = chacha20poly1305_iov_split(aad, sizeof(aad), CC_ARRAY_LEN(aad_sizes), aad_sizes, CC_ARRAY_LEN(aad_iov), aad_iov);
+
+    for (size_t l = 0; l < CC_ARRAY_LEN(lengths); l++) {
+        size_t nbytes = lengths[l];
+
+        ccchacha20poly1305_encrypt_oneshot(info, key, nonce, sizeof(aad), aad, nbytes, pt, ct, tag);
+
+        in_niov = chacha20poly1305_iov_split(pt, nbytes, CC_ARRAY_LEN(in_sizes), in_sizes, CC_ARRAY_LEN(in_iov), in_iov);
+        out_niov = chacha20poly1305_iov_split_out(ct_iov, nbytes, CC_ARRAY_LEN(out_sizes), out_sizes, CC_ARRAY_LEN(out_iov), out_iov);
+        ccchacha20poly1305_init(info, &state, key);
+        ccchacha20poly1305_setnonce(info, &state, nonce);
+        err = ccchacha20poly1305_encrypt_iov(info, &state, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, tag_iov);
+        ok(err == 0, "Check chacha20-poly1305 iov encrypt of %zu bytes", nbytes);
+        ok_memcmp(ct_iov, ct, nbytes, "Check chacha20-poly1305 iov ciphertext of %zu bytes", nbytes);
+        ok_memcmp(tag_iov, tag, sizeof(tag), "Check chacha20-poly1305 iov tag of %zu bytes", nbytes);
+
+        in_niov = chacha20poly1305_iov_split(ct, nbytes, CC_ARRAY_LEN(out_sizes), out_sizes, CC_ARRAY_LEN(in_iov), in_iov);
+        out_niov = chacha20poly1305_iov_split_out(pt_iov, nbytes, CC_ARRAY_LEN(in_sizes), in_sizes, CC_ARRAY_LEN(out_iov), out_iov);
+        ccchacha20poly1305_init(info, &state, key);
+        ccchacha20poly1305_setnonce(info, &state, nonce);
+        err = ccchacha20poly1305_decrypt_iov(info, &state, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, tag);
+        ok(err == 0, "Check chacha20-poly1305 iov decrypt of %zu bytes", nbytes);
+        ok_memcmp(pt_iov, pt, nbytes, "Check chacha20-poly1305 iov plaintext of %zu bytes", nbytes);
+    }
+
+    tag[0] ^= 1;
+    ccchacha20poly1305_init(info, &state, key);
+    ccchacha20poly1305_setnonce(info, &state, nonce);
+    err = ccchacha20poly1305_decrypt_iov(info, &state, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, tag);
+    isnt(err, 0, "Check chacha20-poly1305 iov decrypt rejects a bad tag");
+
+    in_iov[0].nbytes -= 1;
+    ccchacha20poly1305_init(info, &state, key);
+    ccchacha20poly1305_setnonce(info, &state, nonce);
+    err = ccchacha20poly1305_encrypt_iov(info, &state, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, tag_iov);
+    isnt(err, 0, "Check chacha20-poly1305 iov encrypt rejects mismatched lengths");
+}
+
+/* Enough records of mixed lengths to fill several groups of SIMD lanes,
+ with one record too long to join a group in the middle. */
+static void test_chacha20poly1305_batch(void)
+{
+    static const size_t lengths[] = {
+        0, 1, 15, 16, 17, 63, 64, 65, 100, 127, 128, 129, 255, 256, 300, 511, 512, 513, 1000,
+        1024, 1500, 1500, 1500, 1500, 2100, 4096, 4097, 64, 64, 64, 64, 64, 64, 64, 64, 3, 700
+    };
+    enum { nrecords = CC_ARRAY_LEN(lengths), max_nbytes = 32 * 1024, max_aad_nbytes = 40 };
+
+    static uint8_t pt[max_nbytes], ct[max_nbytes], ct_batch[max_nbytes], pt_batch[max_nbytes];
+    static const uint8_t zero[max_nbytes];
+    uint8_t key[CCCHACHA20_KEY_NBYTES], aad[max_aad_nbytes];
+    uint8_t nonce[nrecords][CCCHACHA20_NONCE_NBYTES];
+    uint8_t tag[nrecords][CCPOLY1305_TAG_NBYTES], tag_batch[nrecords][CCPOLY1305_TAG_NBYTES];
+    size_t offset[nrecords], aad_nbytes[nrecords], off = 0;
+    struct ccchacha20poly1305_record records[nrecords];
+    const struct ccchacha20poly1305_info *info = ccchacha20poly1305_info();
+    int results[nrecords];
+    int err;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0x3b * i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(5 * i + 2);
+    for (size_t i = 0; i < sizeof(pt); i++) pt[i] = (uint8_t)(11 * i + (i >> 8));
+
+    for (size_t i = 0; i < nrecords; i++) {
+        offset[i] = off;
+        off += lengths[i];
+        aad_nbytes[i] = (7 * i) % (max_aad_nbytes + 1);
+        cc_memset(nonce[i], (int)i, CCCHACHA20_NONCE_NBYTES);
+        ccchacha20poly1305_encrypt_oneshot(info, key, nonce[i], aad_nbytes[i], aad, lengths[i], pt + offset[i], ct + offset[i], tag[i]);
+        records[i] = (struct ccchacha20poly1305_record){ nonce[i], aad_nbytes[i], aad, lengths[i], pt + offset[i], ct_batch + offset[i], tag_batch[i] };
+    }
+    cc_assert(off <= max_nbytes);
+
+    err = ccchacha20poly1305_seal_batch(info, key, nrecords, records);
+    ok(err == 0, "Check chacha20-poly1305 batch seal");
+    for (size_t i = 0; i < nrecords; i++) {
+        ok_memcmp(ct_batch + offset[i], ct + offset[i], lengths[i], "Check chacha20-poly1305 batch ciphertext of record %zu", i);
+        ok_memcmp(tag_batch[i], tag[i], sizeof(tag[i]), "Check chacha20-poly1305 batch tag of record %zu", i);
+    }
+
+    // Open in place, with bad tags on records in the first and second groups.
+    cc_memcpy(pt_batch, ct, off);
+    for (size_t i = 0; i < nrecords; i++) {
+        records[i] = (struct ccchacha20poly1305_record){ nonce[i], aad_nbytes[i], aad, lengths[i], pt_batch + offset[i], pt_batch + offset[i], tag[i] };
+    }
+    tag[4][0] ^= 1;
+    tag[20][15] ^= 0x80;
+
+    err = ccchacha20poly1305_open_batch(info, key, nrecords, records, results);
+    is(err, -1, "Check chacha20-poly1305 batch open rejects a bad tag");
+    for (size_t i = 0; i < nrecords; i++) {
+        if (i == 4 || i == 20) {
+            is(results[i], -1, "Check chacha20-poly1305 batch open rejects the bad tag of record %zu", i);
+            ok_memcmp(pt_batch + offset[i], zero, lengths[i], "Check chacha20-poly1305 batch open clears record %zu", i);
+        } else {
+            is(results[i], 0, "Check chacha20-poly1305 batch open of record %zu", i);
+            ok_memcmp(pt_batch + offset[i], pt + offset[i], lengths[i], "Check chacha20-poly1305 batch plaintext of record %zu", i);
+        }
+    }
+
+    // A batch rejected as a whole still sets every result.
+    records[nrecords - 1].nbytes = CCCHACHA20POLY1305_TEXT_MAX_NBYTES + 1;
+    cc_clear(sizeof(results), results);
+    err = ccchacha20poly1305_open_batch(info, key, nrecords, records, results);
+    is(err, 1, "Check chacha20-poly1305 batch open rejects an oversized record");
+    for (size_t i = 0; i < nrecords; i++) {
+        is(results[i], 1, "Check chacha20-poly1305 batch open sets the result of record %zu", i);
+    }
+}
+
+/* Long texts go through the interleaved cipher and MAC; check them against
+ ChaCha20 and Poly1305 computed separately, for a text given in one call and
+ for one whose bulk starts off a block boundary. */
+static void test_chacha20poly1305_long(void)
+{
+    enum { nbytes = 5 * 1024 + 100, aad_nbytes = 13 };
+    static const size_t first_nbytes[] = { nbytes, 7 };
+    static const uint8_t zero[16];
+    uint8_t key[CCCHACHA20_KEY_NBYTES], nonce[CCCHACHA20_NONCE_NBYTES], aad[aad_nbytes];
+    uint8_t pt[nbytes], ct[nbytes], expected_ct[nbytes], out[nbytes];
+    uint8_t block[CCCHACHA20_BLOCK_NBYTES] = { 0 }, lengths[16];
+    uint8_t tag[CCPOLY1305_TAG_NBYTES], expected_tag[CCPOLY1305_TAG_NBYTES];
+    const struct ccchacha20poly1305_info *info = ccchacha20poly1305_info();
+    ccchacha20poly1305_ctx ctx;
+    ccpoly1305_ctx poly;
+    int err;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(7 * i + 1);
+    for (size_t i = 0; i < sizeof(nonce); i++) nonce[i] = (uint8_t)(3 * i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(9 * i + 4);
+    for (size_t i = 0; i < sizeof(pt); i++) pt[i] = (uint8_t)(13 * i + 5);
+
+    ccchacha20(key, nonce, 0, sizeof(block), block, block);
+    ccchacha20(key, nonce, 1, nbytes, pt, expected_ct);
+    ccpoly1305_init(&poly, block);
+    ccpoly1305_update(&poly, aad_nbytes, aad);
+    ccpoly1305_update(&poly, 16 - aad_nbytes % 16, zero);
+    for (size_t off = 0; off < nbytes; off += 16) {
+        ccpoly1305_update(&poly, CC_MIN(nbytes - off, (size_t)16), expected_ct + off);
+    }
+    ccpoly1305_update(&poly, 16 - nbytes % 16, zero);
+    CC_WRITE_LE64(lengths, (uint64_t)aad_nbytes);
+    CC_WRITE_LE64(lengths + 8, (uint64_t)nbytes);
+    ccpoly1305_update(&poly, sizeof(lengths), lengths);
+    ccpoly1305_final(&poly, expected_tag);
+
+    for (size_t i = 0; i < CC_ARRAY_LEN(first_nbytes); i++) {
+        size_t n = first_nbytes[i];
+
+        ccchacha20poly1305_init(info, &ctx, key);
+        ccchacha20poly1305_setnonce(info, &ctx, nonce);
+        ccchacha20poly1305_aad(info, &ctx, aad_nbytes, aad);
+        ccchacha20poly1305_encrypt(info, &ctx, n, pt, ct);
+        ccchacha20poly1305_encrypt(info, &ctx, nbytes - n, pt + n, ct + n);
+        ccchacha20poly1305_finalize(info, &ctx, tag);
+        ok_memcmp(ct, expected_ct, nbytes, "Check chacha20-poly1305 long ciphertext, first call of %zu bytes", n);
+        ok_memcmp(tag, expected_tag, sizeof(tag), "Check chacha20-poly1305 long tag, first call of %zu bytes", n);
+
+        ccchacha20poly1305_init(info, &ctx, key);
+        ccchacha20poly1305_setnonce(info, &ctx, nonce);
+        ccchacha20poly1305_aad(info, &ctx, aad_nbytes, aad);
+        ccchacha20poly1305_decrypt(info, &ctx, n, ct, out);
+        ccchacha20poly1305_decrypt(info, &ctx, nbytes - n, ct + n, out + n);
+        err = ccchacha20poly1305_verify(info, &ctx, expected_tag);
+        ok(err == 0, "Check chacha20-poly1305 long verify, first call of %zu bytes", n);
+        ok_memcmp(out, pt, nbytes, "Check chacha20-poly1305 long plaintext, first call of %zu bytes", n);
+    }
+}
+
 int ccchacha_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv) {
-	plan_tests(2197);
+	plan_tests(2422);
 
 	if(verbose) diag("Starting chacha tests\n");
 	test_chacha20();
+	test_chacha20_wide();
 	test_poly1305();
+	test_poly1305_wide();
 	test_chacha20_poly1305();
     test_chacha20poly1305_counter_wrap();
+    test_chacha20poly1305_iov();
+    test_chacha20poly1305_batch();
+    test_chacha20poly1305_long();
 	return 0;
 }
 
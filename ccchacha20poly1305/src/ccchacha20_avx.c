@@ -0,0 +1,428 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include <corecrypto/cc.h>
+#include "ccchacha20_avx.h"
+
+#if CCCHACHA20_AVX_INTRINSICS
+
+#include <immintrin.h>
+
+/* The state is held transposed: vector j holds word j of consecutive blocks,
+ * so each quarter round works on all blocks at once with no lane shuffles.
+ * The keystream is transposed back to block order before the final XOR. */
+
+#define CCCHACHA20_AVX2_TARGET __attribute__((target("avx2")))
+#define CCCHACHA20_AVX512_TARGET __attribute__((target("avx2,avx512f")))
+
+#define CCCHACHA20_DOUBLE_ROUND(QR, x)      \
+    QR(x[0], x[4], x[8], x[12]);           \
+    QR(x[1], x[5], x[9], x[13]);           \
+    QR(x[2], x[6], x[10], x[14]);          \
+    QR(x[3], x[7], x[11], x[15]);          \
+    QR(x[0], x[5], x[10], x[15]);          \
+    QR(x[1], x[6], x[11], x[12]);          \
+    QR(x[2], x[7], x[8], x[13]);           \
+    QR(x[3], x[4], x[9], x[14]);
+
+/* 32-bit rotations by 16 and 8 are byte shuffles. */
+#define CCCHACHA20_AVX2_QR(a, b, c, d)                                                 \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c);                              \
+    b = _mm256_or_si256(_mm256_slli_epi32(b, 12), _mm256_srli_epi32(b, 20));             \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot8);  \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c);                              \
+    b = _mm256_or_si256(_mm256_slli_epi32(b, 7), _mm256_srli_epi32(b, 25));
+
+#define CCCHACHA20_AVX512_QR(a, b, c, d)                                         \
+    a = _mm512_add_epi32(a, b); d = _mm512_rol_epi32(_mm512_xor_si512(d, a), 16); \
+    c = _mm512_add_epi32(c, d); b = _mm512_rol_epi32(_mm512_xor_si512(b, c), 12); \
+    a = _mm512_add_epi32(a, b); d = _mm512_rol_epi32(_mm512_xor_si512(d, a), 8);  \
+    c = _mm512_add_epi32(c, d); b = _mm512_rol_epi32(_mm512_xor_si512(b, c), 7);
+
+/* Transpose words x[0..3] so that 128-bit lane l of x[k] holds these four
+ * words of block 4 * l + k. */
+#define CCCHACHA20_TRANSPOSE4(W, x)                          \
+    do {                                                     \
+        __typeof__(x[0]) t0 = W##_unpacklo_epi32(x[0], x[1]); \
+        __typeof__(x[0]) t1 = W##_unpackhi_epi32(x[0], x[1]); \
+        __typeof__(x[0]) t2 = W##_unpacklo_epi32(x[2], x[3]); \
+        __typeof__(x[0]) t3 = W##_unpackhi_epi32(x[2], x[3]); \
+        x[0] = W##_unpacklo_epi64(t0, t2);                   \
+        x[1] = W##_unpackhi_epi64(t0, t2);                   \
+        x[2] = W##_unpacklo_epi64(t1, t3);                   \
+        x[3] = W##_unpackhi_epi64(t1, t3);                   \
+    } while (0)
+
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccchacha20_avx2_xor32(uint8_t *out, const uint8_t *in, __m256i k)
+{
+    _mm256_storeu_si256((__m256i *)out, _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)in), k));
+}
+
+/* Eight blocks whose words 12 to 15 are given per lane in w; the other
+ * words come from state. Leaves the keystream in x, transposed so that x[k]
+ * and x[k + 4] hold the first half of blocks k and k + 4, x[k + 8] and
+ * x[k + 12] the second half. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccchacha20_avx2_blocks(__m256i x[16], const uint32_t state[16], const __m256i w[4])
+{
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+    for (unsigned j = 0; j < 16; j++) {
+        x[j] = j < 12 ? _mm256_set1_epi32((int)state[j]) : w[j - 12];
+    }
+
+    for (unsigned i = 0; i < 10; i++) {
+        CCCHACHA20_DOUBLE_ROUND(CCCHACHA20_AVX2_QR, x)
+    }
+
+    for (unsigned j = 0; j < 16; j++) {
+        x[j] = _mm256_add_epi32(x[j], j < 12 ? _mm256_set1_epi32((int)state[j]) : w[j - 12]);
+    }
+    CCCHACHA20_TRANSPOSE4(_mm256, (x + 0));
+    CCCHACHA20_TRANSPOSE4(_mm256, (x + 4));
+    CCCHACHA20_TRANSPOSE4(_mm256, (x + 8));
+    CCCHACHA20_TRANSPOSE4(_mm256, (x + 12));
+}
+
+CCCHACHA20_AVX2_TARGET
+void ccchacha20_avx2_xor(uint32_t state[16], size_t nblocks, uint8_t *out, const uint8_t *in)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (; nblocks; nblocks -= CCCHACHA20_AVX2_NBLOCKS) {
+        __m256i x[16], w[4];
+
+        w[0] = _mm256_add_epi32(_mm256_set1_epi32((int)state[12]), lanes);
+        for (unsigned j = 1; j < 4; j++) {
+            w[j] = _mm256_set1_epi32((int)state[12 + j]);
+        }
+        ccchacha20_avx2_blocks(x, state, w);
+
+        for (unsigned k = 0; k < 4; k++) {
+            uint8_t *o = out + 64 * k;
+            const uint8_t *p = in + 64 * k;
+            ccchacha20_avx2_xor32(o, p, _mm256_permute2x128_si256(x[k], x[k + 4], 0x20));
+            ccchacha20_avx2_xor32(o + 32, p + 32, _mm256_permute2x128_si256(x[k + 8], x[k + 12], 0x20));
+            ccchacha20_avx2_xor32(o + 256, p + 256, _mm256_permute2x128_si256(x[k], x[k + 4], 0x31));
+            ccchacha20_avx2_xor32(o + 288, p + 288, _mm256_permute2x128_si256(x[k + 8], x[k + 12], 0x31));
+        }
+
+        state[12] += CCCHACHA20_AVX2_NBLOCKS;
+        in += CCCHACHA20_AVX2_NBLOCKS * 64;
+        out += CCCHACHA20_AVX2_NBLOCKS * 64;
+    }
+}
+
+CCCHACHA20_AVX2_TARGET
+void ccchacha20_avx2_xor_lanes(const uint32_t state[16], const uint32_t *w,
+                               uint8_t *const out[CCCHACHA20_AVX2_NBLOCKS], const uint8_t *const in[CCCHACHA20_AVX2_NBLOCKS])
+{
+    __m256i x[16], wv[4];
+
+    for (unsigned j = 0; j < 4; j++) {
+        wv[j] = _mm256_loadu_si256((const __m256i *)(w + CCCHACHA20_AVX2_NBLOCKS * j));
+    }
+    ccchacha20_avx2_blocks(x, state, wv);
+
+    for (unsigned k = 0; k < 4; k++) {
+        ccchacha20_avx2_xor32(out[k], in[k], _mm256_permute2x128_si256(x[k], x[k + 4], 0x20));
+        ccchacha20_avx2_xor32(out[k] + 32, in[k] + 32, _mm256_permute2x128_si256(x[k + 8], x[k + 12], 0x20));
+        ccchacha20_avx2_xor32(out[k + 4], in[k + 4], _mm256_permute2x128_si256(x[k], x[k + 4], 0x31));
+        ccchacha20_avx2_xor32(out[k + 4] + 32, in[k + 4] + 32, _mm256_permute2x128_si256(x[k + 8], x[k + 12], 0x31));
+    }
+}
+
+CC_INLINE CCCHACHA20_AVX512_TARGET
+void ccchacha20_avx512_xor64(uint8_t *out, const uint8_t *in, __m512i k)
+{
+    _mm512_storeu_si512((void *)out, _mm512_xor_si512(_mm512_loadu_si512((const void *)in), k));
+}
+
+/* Sixteen blocks whose words 12 to 15 are given per lane in w, as in
+ * ccchacha20_avx2_blocks(). Leaves block 4 * l + k in k[4 * l + k]. */
+CC_INLINE CCCHACHA20_AVX512_TARGET
+void ccchacha20_avx512_blocks(__m512i k[16], const uint32_t state[16], const __m512i w[4])
+{
+    __m512i x[16];
+
+    for (unsigned j = 0; j < 16; j++) {
+        x[j] = j < 12 ? _mm512_set1_epi32((int)state[j]) : w[j - 12];
+    }
+
+    for (unsigned i = 0; i < 10; i++) {
+        CCCHACHA20_DOUBLE_ROUND(CCCHACHA20_AVX512_QR, x)
+    }
+
+    for (unsigned j = 0; j < 16; j++) {
+        x[j] = _mm512_add_epi32(x[j], j < 12 ? _mm512_set1_epi32((int)state[j]) : w[j - 12]);
+    }
+    CCCHACHA20_TRANSPOSE4(_mm512, (x + 0));
+    CCCHACHA20_TRANSPOSE4(_mm512, (x + 4));
+    CCCHACHA20_TRANSPOSE4(_mm512, (x + 8));
+    CCCHACHA20_TRANSPOSE4(_mm512, (x + 12));
+
+    // Gather lane l of x[i], x[i + 4], x[i + 8] and x[i + 12] into block 4 * l + i.
+    for (unsigned i = 0; i < 4; i++) {
+        __m512i a = _mm512_shuffle_i32x4(x[i], x[i + 4], 0x88);
+        __m512i b = _mm512_shuffle_i32x4(x[i], x[i + 4], 0xdd);
+        __m512i c = _mm512_shuffle_i32x4(x[i + 8], x[i + 12], 0x88);
+        __m512i d = _mm512_shuffle_i32x4(x[i + 8], x[i + 12], 0xdd);
+        k[i] = _mm512_shuffle_i32x4(a, c, 0x88);
+        k[i + 4] = _mm512_shuffle_i32x4(b, d, 0x88);
+        k[i + 8] = _mm512_shuffle_i32x4(a, c, 0xdd);
+        k[i + 12] = _mm512_shuffle_i32x4(b, d, 0xdd);
+    }
+}
+
+CCCHACHA20_AVX512_TARGET
+void ccchacha20_avx512_xor(uint32_t state[16], size_t nblocks, uint8_t *out, const uint8_t *in)
+{
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    for (; nblocks; nblocks -= CCCHACHA20_AVX512_NBLOCKS) {
+        __m512i k[16], w[4];
+
+        w[0] = _mm512_add_epi32(_mm512_set1_epi32((int)state[12]), lanes);
+        for (unsigned j = 1; j < 4; j++) {
+            w[j] = _mm512_set1_epi32((int)state[12 + j]);
+        }
+        ccchacha20_avx512_blocks(k, state, w);
+
+        for (unsigned b = 0; b < CCCHACHA20_AVX512_NBLOCKS; b++) {
+            ccchacha20_avx512_xor64(out + 64 * b, in + 64 * b, k[b]);
+        }
+
+        state[12] += CCCHACHA20_AVX512_NBLOCKS;
+        in += CCCHACHA20_AVX512_NBLOCKS * 64;
+        out += CCCHACHA20_AVX512_NBLOCKS * 64;
+    }
+}
+
+CCCHACHA20_AVX512_TARGET
+void ccchacha20_avx512_xor_lanes(const uint32_t state[16], const uint32_t *w,
+                                 uint8_t *const out[CCCHACHA20_AVX512_NBLOCKS], const uint8_t *const in[CCCHACHA20_AVX512_NBLOCKS])
+{
+    __m512i k[16], wv[4];
+
+    for (unsigned j = 0; j < 4; j++) {
+        wv[j] = _mm512_loadu_si512((const void *)(w + CCCHACHA20_AVX512_NBLOCKS * j));
+    }
+    ccchacha20_avx512_blocks(k, state, wv);
+
+    for (unsigned b = 0; b < CCCHACHA20_AVX512_NBLOCKS; b++) {
+        ccchacha20_avx512_xor64(out[b], in[b], k[b]);
+    }
+}
+
+#if CCPOLY1305_64BIT
+
+/* Poly1305 keeps one accumulator per 64-bit lane, in 26-bit limbs so that
+ * the limb products fit the 32x32 bit lane multiplier. */
+
+/* h = h * r, where s = 5 * r, followed by a partial carry. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_mul(__m256i h[5], const __m256i r[5], const __m256i s[5])
+{
+    const __m256i m26 = _mm256_set1_epi64x(0x3ffffff);
+    __m256i t0, t1, t2, t3, t4, c;
+
+#define MUL(a, b) _mm256_mul_epu32(a, b)
+    t0 = MUL(h[0], r[0]) + MUL(h[1], s[4]) + MUL(h[2], s[3]) + MUL(h[3], s[2]) + MUL(h[4], s[1]);
+    t1 = MUL(h[0], r[1]) + MUL(h[1], r[0]) + MUL(h[2], s[4]) + MUL(h[3], s[3]) + MUL(h[4], s[2]);
+    t2 = MUL(h[0], r[2]) + MUL(h[1], r[1]) + MUL(h[2], r[0]) + MUL(h[3], s[4]) + MUL(h[4], s[3]);
+    t3 = MUL(h[0], r[3]) + MUL(h[1], r[2]) + MUL(h[2], r[1]) + MUL(h[3], r[0]) + MUL(h[4], s[4]);
+    t4 = MUL(h[0], r[4]) + MUL(h[1], r[3]) + MUL(h[2], r[2]) + MUL(h[3], r[1]) + MUL(h[4], r[0]);
+#undef MUL
+
+    c = _mm256_srli_epi64(t0, 26); t0 &= m26; t1 += c;
+    c = _mm256_srli_epi64(t1, 26); t1 &= m26; t2 += c;
+    c = _mm256_srli_epi64(t2, 26); t2 &= m26; t3 += c;
+    c = _mm256_srli_epi64(t3, 26); t3 &= m26; t4 += c;
+    c = _mm256_srli_epi64(t4, 26); t4 &= m26; t0 += c + _mm256_slli_epi64(c, 2);
+    c = _mm256_srli_epi64(t0, 26); t0 &= m26; t1 += c;
+
+    h[0] = t0; h[1] = t1; h[2] = t2; h[3] = t3; h[4] = t4;
+}
+
+/* h += four blocks, given by their low and high 64-bit halves. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_add(__m256i h[5], __m256i lo, __m256i hi)
+{
+    const __m256i m26 = _mm256_set1_epi64x(0x3ffffff);
+
+    h[0] += lo & m26;
+    h[1] += _mm256_srli_epi64(lo, 26) & m26;
+    h[2] += (_mm256_srli_epi64(lo, 52) | _mm256_slli_epi64(hi, 12)) & m26;
+    h[3] += _mm256_srli_epi64(hi, 14) & m26;
+    h[4] += _mm256_srli_epi64(hi, 40) | _mm256_set1_epi64x(1 << 24);
+}
+
+/* h += four consecutive blocks, block i going to lane i. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_add_blocks(__m256i h[5], const uint8_t *in)
+{
+    __m256i a = _mm256_loadu_si256((const __m256i *)in);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(in + 32));
+
+    ccpoly1305_avx2_add(h, _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xd8),
+                        _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xd8));
+}
+
+/* h += one block of each of four messages, in[i] going to lane i. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_add_lanes(__m256i h[5], const uint8_t *const in[4])
+{
+    __m128i b0 = _mm_loadu_si128((const __m128i *)in[0]);
+    __m128i b1 = _mm_loadu_si128((const __m128i *)in[1]);
+    __m128i b2 = _mm_loadu_si128((const __m128i *)in[2]);
+    __m128i b3 = _mm_loadu_si128((const __m128i *)in[3]);
+
+    ccpoly1305_avx2_add(h,
+                        _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi64(b0, b1)), _mm_unpacklo_epi64(b2, b3), 1),
+                        _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpackhi_epi64(b0, b1)), _mm_unpackhi_epi64(b2, b3), 1));
+}
+
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_set_r(__m256i r[5], __m256i s[5], const uint32_t r0[5], const uint32_t r1[5],
+                           const uint32_t r2[5], const uint32_t r3[5])
+{
+    for (unsigned j = 0; j < 5; j++) {
+        r[j] = _mm256_setr_epi64x(r0[j], r1[j], r2[j], r3[j]);
+        s[j] = r[j] + _mm256_slli_epi64(r[j], 2);
+    }
+}
+
+/* Load h into lane 0 and add the first four blocks. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_begin(const ccpoly1305_ctx *ctx, __m256i h[5], __m256i r[5], __m256i s[5], const uint8_t *in)
+{
+    uint32_t h26[5];
+
+    ccpoly1305_radix26(h26, ctx->h0, ctx->h1, ctx->h2);
+    for (unsigned j = 0; j < 5; j++) {
+        h[j] = _mm256_setr_epi64x(h26[j], 0, 0, 0);
+    }
+    ccpoly1305_avx2_set_r(r, s, ctx->rpow[0], ctx->rpow[0], ctx->rpow[0], ctx->rpow[0]);
+    ccpoly1305_avx2_add_blocks(h, in);
+}
+
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_blocks(__m256i h[5], const __m256i r[5], const __m256i s[5], size_t nblocks, const uint8_t *in)
+{
+    for (; nblocks; nblocks -= CCPOLY1305_AVX2_NBLOCKS) {
+        ccpoly1305_avx2_mul(h, r, s);
+        ccpoly1305_avx2_add_blocks(h, in);
+        in += CCPOLY1305_AVX2_NBLOCKS * 16;
+    }
+}
+
+/* Fold the lanes back into h. */
+CC_INLINE CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_end(ccpoly1305_ctx *ctx, __m256i h[5])
+{
+    __m256i r[5], s[5];
+    uint64_t l[5][4], sum[5];
+
+    // Lane i holds the blocks 4 - i, 8 - i, ... from the end.
+    ccpoly1305_avx2_set_r(r, s, ctx->rpow[0], ctx->rpow[1], ctx->rpow[2], ctx->rpow[3]);
+    ccpoly1305_avx2_mul(h, r, s);
+
+    for (unsigned j = 0; j < 5; j++) {
+        _mm256_storeu_si256((__m256i *)l[j], h[j]);
+        sum[j] = l[j][0] + l[j][1] + l[j][2] + l[j][3];
+    }
+
+    ccpoly1305_radix44(ctx, sum);
+}
+
+CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_update(ccpoly1305_ctx *ctx, size_t nblocks, const uint8_t *in)
+{
+    __m256i h[5], r[5], s[5];
+
+    ccpoly1305_avx2_begin(ctx, h, r, s, in);
+    ccpoly1305_avx2_blocks(h, r, s, nblocks - CCPOLY1305_AVX2_NBLOCKS, in + CCPOLY1305_AVX2_NBLOCKS * 16);
+    ccpoly1305_avx2_end(ctx, h);
+}
+
+CCCHACHA20_AVX2_TARGET
+void ccpoly1305_avx2_lanes(uint64_t h[5][4], const uint32_t r[4][5], size_t nblocks, const uint8_t *const in[4])
+{
+    __m256i hv[5], rv[5], sv[5];
+    const uint8_t *p[4] = { in[0], in[1], in[2], in[3] };
+
+    for (unsigned j = 0; j < 5; j++) {
+        hv[j] = _mm256_loadu_si256((const __m256i *)h[j]);
+    }
+    ccpoly1305_avx2_set_r(rv, sv, r[0], r[1], r[2], r[3]);
+
+    for (; nblocks; nblocks--) {
+        ccpoly1305_avx2_add_lanes(hv, p);
+        ccpoly1305_avx2_mul(hv, rv, sv);
+        for (unsigned i = 0; i < 4; i++) {
+            p[i] += 16;
+        }
+    }
+
+    for (unsigned j = 0; j < 5; j++) {
+        _mm256_storeu_si256((__m256i *)h[j], hv[j]);
+    }
+}
+
+/* One ChaCha20 kernel call per chunk, with the Poly1305 lanes kept in
+ * registers across chunks and folded only once at the end. */
+CCCHACHA20_AVX2_TARGET
+void ccchacha20poly1305_avx_crypt(uint32_t state[16], ccpoly1305_ctx *poly, size_t nbytes,
+                                  const uint8_t *in, uint8_t *out, bool encrypt)
+{
+    bool avx512 = CC_HAS_AVX512F();
+    size_t chunk_nblocks = avx512 ? CCCHACHA20_AVX512_NBLOCKS : CCCHACHA20_AVX2_NBLOCKS;
+    size_t chunk_nbytes = chunk_nblocks * CCCHACHA20_BLOCK_NBYTES;
+    const uint8_t *mac = encrypt ? out : in;
+    __m256i h[5], r[5], s[5];
+
+    for (size_t off = 0; off < nbytes; off += chunk_nbytes) {
+        if (encrypt) {
+            if (avx512) {
+                ccchacha20_avx512_xor(state, chunk_nblocks, out + off, in + off);
+            } else {
+                ccchacha20_avx2_xor(state, chunk_nblocks, out + off, in + off);
+            }
+        }
+
+        if (off == 0) {
+            ccpoly1305_avx2_begin(poly, h, r, s, mac);
+            ccpoly1305_avx2_blocks(h, r, s, chunk_nbytes / 16 - CCPOLY1305_AVX2_NBLOCKS, mac + CCPOLY1305_AVX2_NBLOCKS * 16);
+        } else {
+            ccpoly1305_avx2_blocks(h, r, s, chunk_nbytes / 16, mac + off);
+        }
+
+        if (!encrypt) {
+            if (avx512) {
+                ccchacha20_avx512_xor(state, chunk_nblocks, out + off, in + off);
+            } else {
+                ccchacha20_avx2_xor(state, chunk_nblocks, out + off, in + off);
+            }
+        }
+    }
+
+    ccpoly1305_avx2_end(poly, h);
+}
+
+#endif /* CCPOLY1305_64BIT */
+
+#endif /* CCCHACHA20_AVX_INTRINSICS */
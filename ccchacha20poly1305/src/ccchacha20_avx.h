@@ -0,0 +1,112 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#ifndef _CORECRYPTO_CCCHACHA20_AVX_H_
+#define _CORECRYPTO_CCCHACHA20_AVX_H_
+
+#include <corecrypto/cc_config.h>
+
+#if CCCHACHA20_AVX_INTRINSICS
+
+#include <corecrypto/cc_runtime_config.h>
+#include <corecrypto/ccchacha20poly1305.h>
+
+/* Wide ChaCha20 kernels computing one block per 32-bit vector lane. Callers
+ * must check CC_HAS_AVX2() or CC_HAS_AVX512F() first; nblocks must be a
+ * multiple of the kernel width. Both XOR the keystream for blocks
+ * state[12], state[12] + 1, ... into in and advance state[12] by nblocks. */
+
+#define CCCHACHA20_AVX2_NBLOCKS 8
+#define CCCHACHA20_AVX512_NBLOCKS 16
+
+void ccchacha20_avx2_xor(uint32_t state[16], size_t nblocks, uint8_t *out, const uint8_t *in);
+void ccchacha20_avx512_xor(uint32_t state[16], size_t nblocks, uint8_t *out, const uint8_t *in);
+
+/* One block per lane, each with its own counter and nonce: lane l of a
+ * kernel of width N takes word 12 + j (the counter and nonce) from
+ * w[N * j + l], the key and constants from state, and XORs the 64-byte
+ * block at in[l] into out[l]. Used to encrypt unrelated records under one
+ * key together. */
+void ccchacha20_avx2_xor_lanes(const uint32_t state[16], const uint32_t *w,
+                               uint8_t *const out[CCCHACHA20_AVX2_NBLOCKS], const uint8_t *const in[CCCHACHA20_AVX2_NBLOCKS]);
+void ccchacha20_avx512_xor_lanes(const uint32_t state[16], const uint32_t *w,
+                                 uint8_t *const out[CCCHACHA20_AVX512_NBLOCKS], const uint8_t *const in[CCCHACHA20_AVX512_NBLOCKS]);
+
+#if CCPOLY1305_64BIT
+
+/* Poly1305 over nblocks full 16-byte blocks, four at a time: lane i
+ * accumulates blocks i, i + 4, ... with r^4, and the lanes are folded back
+ * into h with r^4, r^3, r^2 and r. Only call this when CC_HAS_AVX2(), with
+ * ctx->rpow computed; nblocks must be a nonzero multiple of
+ * CCPOLY1305_AVX2_NBLOCKS. */
+
+#define CCPOLY1305_AVX2_NBLOCKS 4
+
+/* Below this, setting up the lanes costs more than it saves. */
+#define CCPOLY1305_AVX2_MIN_NBYTES 256
+
+void ccpoly1305_avx2_update(ccpoly1305_ctx *ctx, size_t nblocks, const uint8_t *in);
+
+/* Poly1305 over nblocks full 16-byte blocks of four independent messages:
+ * lane i adds the blocks at in[i] to its accumulator and multiplies by its
+ * own key r[i]. Accumulators and keys are in radix 2^26, limb j of lane i
+ * at h[j][i] and r[i][j]; h is partially carried in and out. Only call
+ * this when CC_HAS_AVX2(). */
+void ccpoly1305_avx2_lanes(uint64_t h[5][4], const uint32_t r[4][5], size_t nblocks, const uint8_t *const in[4]);
+
+/* ChaCha20-Poly1305 text over nbytes, a multiple of
+ * CCCHACHA20POLY1305_AVX_NBYTES: encrypt, then MAC the ciphertext, one
+ * ChaCha20 kernel call at a time while it is still in L1 (the reverse to
+ * decrypt). The text must start on a ChaCha20 block boundary, with no
+ * bytes buffered in poly. Only call this when CC_HAS_AVX2(), with
+ * poly->rpow computed. */
+
+#define CCCHACHA20POLY1305_AVX_NBYTES (CCCHACHA20_AVX512_NBLOCKS * CCCHACHA20_BLOCK_NBYTES)
+
+void ccchacha20poly1305_avx_crypt(uint32_t state[16], ccpoly1305_ctx *poly, size_t nbytes,
+                                  const uint8_t *in, uint8_t *out, bool encrypt);
+
+/* Convert h, in 44, 44 and 42 bit limbs with h1 possibly carrying one bit
+ * over, to 26 bit limbs. */
+CC_INLINE void ccpoly1305_radix26(uint32_t l[5], uint64_t h0, uint64_t h1, uint64_t h2)
+{
+    h2 += h1 >> 44;
+    h1 &= 0xfffffffffff;
+
+    l[0] = (uint32_t)(h0 & 0x3ffffff);
+    l[1] = (uint32_t)(((h0 >> 26) | (h1 << 18)) & 0x3ffffff);
+    l[2] = (uint32_t)((h1 >> 8) & 0x3ffffff);
+    l[3] = (uint32_t)(((h1 >> 34) | (h2 << 10)) & 0x3ffffff);
+    l[4] = (uint32_t)(h2 >> 16);
+}
+
+/* Set ctx->h from 26 bit limbs l, each below 2^29. */
+CC_INLINE void ccpoly1305_radix44(ccpoly1305_ctx *ctx, const uint64_t l[5])
+{
+    uint64_t c;
+
+    c = l[0] + (l[1] << 26);
+    ctx->h0 = c & 0xfffffffffff;
+    c = (c >> 44) + (l[2] << 8) + (l[3] << 34);
+    ctx->h1 = c & 0xfffffffffff;
+    c = (c >> 44) + (l[4] << 16);
+    ctx->h2 = c & 0x3ffffffffff;
+    ctx->h0 += (c >> 42) * 5;
+    ctx->h1 += ctx->h0 >> 44;
+    ctx->h0 &= 0xfffffffffff;
+}
+
+#endif /* CCPOLY1305_64BIT */
+
+#endif /* CCCHACHA20_AVX_INTRINSICS */
+
+#endif /* _CORECRYPTO_CCCHACHA20_AVX_H_ */
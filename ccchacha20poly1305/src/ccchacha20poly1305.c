@@ -9,11 +9,14 @@
  * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
  */
 
+#include <stddef.h>
 #include <corecrypto/cc.h>
 #include <corecrypto/cc_macros.h>
 #include <corecrypto/cc_priv.h>
 #include <corecrypto/ccchacha20poly1305.h>
 #include <corecrypto/ccchacha20poly1305_priv.h>
+#include "ccchacha20_avx.h"
+#include "cc_internal.h"
 
 // COMPILER_CLANG
 
@@ -199,9 +202,41 @@ int	ccchacha20_final(ccchacha20_ctx *ctx)
 	return 0;
 }
 
-#if( !CHACHA20_SIMD )
+static void	_ccchacha20_xor_portable(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, const uint8_t *in);
 
+// Runs of whole blocks go through the widest kernel the CPU supports; the
+// remaining blocks and any partial block use the SIMD or scalar code below.
 static void	_ccchacha20_xor(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, const uint8_t *in)
+{
+#if CCCHACHA20_AVX_INTRINSICS
+	size_t nblocks = nbytes / CCCHACHA20_BLOCK_NBYTES;
+	size_t n;
+
+	if( nblocks >= CCCHACHA20_AVX512_NBLOCKS && CC_HAS_AVX512F() )
+	{
+		n = nblocks & ~( (size_t)( CCCHACHA20_AVX512_NBLOCKS - 1 ) );
+		ccchacha20_avx512_xor(ctx->state, n, out, in);
+		nblocks -= n;
+		nbytes -= n * CCCHACHA20_BLOCK_NBYTES;
+		out += n * CCCHACHA20_BLOCK_NBYTES;
+		in += n * CCCHACHA20_BLOCK_NBYTES;
+	}
+	if( nblocks >= CCCHACHA20_AVX2_NBLOCKS && CC_HAS_AVX2() )
+	{
+		n = nblocks & ~( (size_t)( CCCHACHA20_AVX2_NBLOCKS - 1 ) );
+		ccchacha20_avx2_xor(ctx->state, n, out, in);
+		nbytes -= n * CCCHACHA20_BLOCK_NBYTES;
+		out += n * CCCHACHA20_BLOCK_NBYTES;
+		in += n * CCCHACHA20_BLOCK_NBYTES;
+	}
+	if( nbytes == 0 ) return;
+#endif
+	_ccchacha20_xor_portable(ctx, nbytes, out, in);
+}
+
+#if( !CHACHA20_SIMD )
+
+static void	_ccchacha20_xor_portable(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, const uint8_t *in)
 {
 	uint32_t		x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
 	uint32_t		j0, j1, j2, j3, j4, j5, j6, j7, j8, j9, j10, j11, j12, j13, j14, j15;
@@ -428,7 +463,7 @@ static void	_ccchacha20_xor(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, co
 	STORE(op + d + 8, LOAD(in + d + 8) ^ REVV_BE(v2)); \
 	STORE(op + d +12, LOAD(in + d +12) ^ REVV_BE(v3));
 
-static void	_ccchacha20_xor(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, const uint8_t *in)
+static void	_ccchacha20_xor_portable(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, const uint8_t *in)
 {
 	size_t iters, i;
     unsigned *op=(unsigned *)out;
@@ -588,42 +623,6 @@ static void	_ccchacha20_xor(ccchacha20_ctx *ctx, size_t nbytes, uint8_t *out, co
 
 static void _ccpoly1305_update(ccpoly1305_ctx *ctx, size_t nbytes, const uint8_t *in);
 
-int ccpoly1305_init(ccpoly1305_ctx *ctx, const uint8_t *key)
-{
-	uint32_t t0,t1,t2,t3;
-	size_t i;
-
-	t0 = U8TO32_LE(key+0);
-	t1 = U8TO32_LE(key+4);
-	t2 = U8TO32_LE(key+8);
-	t3 = U8TO32_LE(key+12);
-
-	/* precompute multipliers */
-	ctx->r0 = t0 & 0x3ffffff; t0 >>= 26; t0 |= t1 << 6;
-	ctx->r1 = t0 & 0x3ffff03; t1 >>= 20; t1 |= t2 << 12;
-	ctx->r2 = t1 & 0x3ffc0ff; t2 >>= 14; t2 |= t3 << 18;
-	ctx->r3 = t2 & 0x3f03fff; t3 >>= 8;
-	ctx->r4 = t3 & 0x00fffff;
-
-	ctx->s1 = ctx->r1 * 5;
-	ctx->s2 = ctx->r2 * 5;
-	ctx->s3 = ctx->r3 * 5;
-	ctx->s4 = ctx->r4 * 5;
-
-	/* init state */
-	ctx->h0 = 0;
-	ctx->h1 = 0;
-	ctx->h2 = 0;
-	ctx->h3 = 0;
-	ctx->h4 = 0;
-
-	ctx->buf_used = 0;
-	for (i = 0; i < 16; ++i)
-		ctx->key[i] = key[i + 16];
-
-    return 0;
-}
-
 int ccpoly1305_update(ccpoly1305_ctx *ctx, size_t nbytes, const uint8_t *in)
 {
 	size_t i, n;
@@ -660,6 +659,228 @@ int ccpoly1305_update(ccpoly1305_ctx *ctx, size_t nbytes, const uint8_t *in)
     return 0;
 }
 
+// The limbs of every variant fit in the fixed-size state.
+cc_static_assert(offsetof(ccpoly1305_ctx, buf) == CCPOLY1305_STATE_NBYTES, "ccpoly1305_ctx state too small");
+
+#if CCPOLY1305_64BIT
+
+// Radix 2^44: h and r are held in 44, 44 and 42 bit limbs, so that a block
+// takes nine 64x64 bit multiplications.
+
+typedef unsigned ccpoly1305_uint128_t __attribute__((mode(TI)));
+
+#define POLY1305_MASK44		((uint64_t)0xfffffffffff)
+#define POLY1305_MASK42		((uint64_t)0x3ffffffffff)
+
+// h = h * r, with h partially reduced on input and output.
+CC_INLINE void _ccpoly1305_mul(uint64_t *h0, uint64_t *h1, uint64_t *h2,
+                               uint64_t r0, uint64_t r1, uint64_t r2, uint64_t s1, uint64_t s2)
+{
+	ccpoly1305_uint128_t d0, d1, d2;
+	uint64_t c;
+
+	d0 = (ccpoly1305_uint128_t)*h0 * r0 + (ccpoly1305_uint128_t)*h1 * s2 + (ccpoly1305_uint128_t)*h2 * s1;
+	d1 = (ccpoly1305_uint128_t)*h0 * r1 + (ccpoly1305_uint128_t)*h1 * r0 + (ccpoly1305_uint128_t)*h2 * s2;
+	d2 = (ccpoly1305_uint128_t)*h0 * r2 + (ccpoly1305_uint128_t)*h1 * r1 + (ccpoly1305_uint128_t)*h2 * r0;
+
+	             *h0 = (uint64_t)d0 & POLY1305_MASK44; c = (uint64_t)(d0 >> 44);
+	d1 += c;     *h1 = (uint64_t)d1 & POLY1305_MASK44; c = (uint64_t)(d1 >> 44);
+	d2 += c;     *h2 = (uint64_t)d2 & POLY1305_MASK42; c = (uint64_t)(d2 >> 42);
+	*h0 += c * 5; c = *h0 >> 44; *h0 &= POLY1305_MASK44;
+	*h1 += c;
+}
+
+int ccpoly1305_init(ccpoly1305_ctx *ctx, const uint8_t *key)
+{
+	uint64_t t0, t1;
+	size_t i;
+
+	CC_LOAD64_LE(t0, key + 0);
+	CC_LOAD64_LE(t1, key + 8);
+
+	/* clamp r and split it into limbs */
+	ctx->r0 = ( t0                    ) & 0xffc0fffffff;
+	ctx->r1 = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+	ctx->r2 = ((t1 >> 24)             ) & 0x00ffffffc0f;
+
+	/* 2^130 = 5 mod p, so products at 2^132 and above fold back times 20 */
+	ctx->s1 = ctx->r1 * (5 << 2);
+	ctx->s2 = ctx->r2 * (5 << 2);
+
+	/* init state */
+	ctx->h0 = 0;
+	ctx->h1 = 0;
+	ctx->h2 = 0;
+#if CCCHACHA20_AVX_INTRINSICS
+	ctx->rpow_valid = false;
+#endif
+
+	ctx->buf_used = 0;
+	for (i = 0; i < 16; ++i)
+		ctx->key[i] = key[i + 16];
+
+    return 0;
+}
+
+int ccpoly1305_final(ccpoly1305_ctx *ctx, uint8_t *tag)
+{
+	uint64_t h0, h1, h2, g0, g1, g2;
+	uint64_t t0, t1, c, mask;
+
+	if (ctx->buf_used)
+		_ccpoly1305_update(ctx, ctx->buf_used, ctx->buf);
+
+	h0 = ctx->h0;
+	h1 = ctx->h1;
+	h2 = ctx->h2;
+
+	/* fully carry h */
+	             c = h1 >> 44; h1 &= POLY1305_MASK44;
+	h2 += c;     c = h2 >> 42; h2 &= POLY1305_MASK42;
+	h0 += c * 5; c = h0 >> 44; h0 &= POLY1305_MASK44;
+	h1 += c;     c = h1 >> 44; h1 &= POLY1305_MASK44;
+	h2 += c;     c = h2 >> 42; h2 &= POLY1305_MASK42;
+	h0 += c * 5; c = h0 >> 44; h0 &= POLY1305_MASK44;
+	h1 += c;
+
+	/* compute h - p and keep it if it did not underflow */
+	g0 = h0 + 5; c = g0 >> 44; g0 &= POLY1305_MASK44;
+	g1 = h1 + c; c = g1 >> 44; g1 &= POLY1305_MASK44;
+	g2 = h2 + c - ((uint64_t)1 << 42);
+
+	mask = (g2 >> 63) - 1;
+	h0 = (h0 & ~mask) | (g0 & mask);
+	h1 = (h1 & ~mask) | (g1 & mask);
+	h2 = (h2 & ~mask) | (g2 & mask);
+
+	/* tag = (h + key) mod 2^128 */
+	CC_LOAD64_LE(t0, &ctx->key[0]);
+	CC_LOAD64_LE(t1, &ctx->key[8]);
+
+	h0 += t0 & POLY1305_MASK44; c = h0 >> 44; h0 &= POLY1305_MASK44;
+	h1 += (((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44) + c; c = h1 >> 44; h1 &= POLY1305_MASK44;
+	h2 += (t1 >> 24) + c; h2 &= POLY1305_MASK42;
+
+	h0 = h0 | (h1 << 44);
+	h1 = (h1 >> 20) | (h2 << 24);
+
+	CC_WRITE_LE64(&tag[0], h0);
+	CC_WRITE_LE64(&tag[8], h1);
+
+    return 0;
+}
+
+#if CCCHACHA20_AVX_INTRINSICS
+
+// Compute r^4, r^3, r^2 and r for the 4-way vector path.
+static void _ccpoly1305_powers(ccpoly1305_ctx *ctx)
+{
+	uint64_t h0 = ctx->r0, h1 = ctx->r1, h2 = ctx->r2;
+	int i;
+
+	for (i = 3; i >= 0; i--) {
+		ccpoly1305_radix26(ctx->rpow[i], h0, h1, h2);
+		if (i) {
+			_ccpoly1305_mul(&h0, &h1, &h2, ctx->r0, ctx->r1, ctx->r2, ctx->s1, ctx->s2);
+		}
+	}
+	ctx->rpow_valid = true;
+}
+
+#endif
+
+static void _ccpoly1305_update(ccpoly1305_ctx *ctx, size_t nbytes, const uint8_t *in)
+{
+	uint64_t h0, h1, h2, t0, t1;
+	uint64_t hibit = (uint64_t)1 << 40;
+	uint8_t mp[16];
+	size_t j;
+
+#if CCCHACHA20_AVX_INTRINSICS
+	if (nbytes >= CCPOLY1305_AVX2_MIN_NBYTES && CC_HAS_AVX2()) {
+		size_t n = nbytes & ~((size_t)(CCPOLY1305_AVX2_NBLOCKS * 16 - 1));
+
+		if (!ctx->rpow_valid)
+			_ccpoly1305_powers(ctx);
+		ccpoly1305_avx2_update(ctx, n / 16, in);
+		in += n;
+		nbytes -= n;
+	}
+#endif
+
+	h0 = ctx->h0;
+	h1 = ctx->h1;
+	h2 = ctx->h2;
+
+	while (nbytes) {
+		if (nbytes < 16) {
+			/* final bytes */
+			for (j = 0; j < nbytes; j++)
+				mp[j] = in[j];
+			mp[j++] = 1;
+			for (; j < 16; j++)
+				mp[j] = 0;
+			in = mp;
+			nbytes = 16;
+			hibit = 0;
+		}
+
+		CC_LOAD64_LE(t0, in + 0);
+		CC_LOAD64_LE(t1, in + 8);
+
+		h0 += t0 & POLY1305_MASK44;
+		h1 += ((t0 >> 44) | (t1 << 20)) & POLY1305_MASK44;
+		h2 += (t1 >> 24) | hibit;
+
+		_ccpoly1305_mul(&h0, &h1, &h2, ctx->r0, ctx->r1, ctx->r2, ctx->s1, ctx->s2);
+
+		in += 16;
+		nbytes -= 16;
+	}
+
+	ctx->h0 = h0;
+	ctx->h1 = h1;
+	ctx->h2 = h2;
+}
+
+#else
+
+int ccpoly1305_init(ccpoly1305_ctx *ctx, const uint8_t *key)
+{
+	uint32_t t0,t1,t2,t3;
+	size_t i;
+
+	t0 = U8TO32_LE(key+0);
+	t1 = U8TO32_LE(key+4);
+	t2 = U8TO32_LE(key+8);
+	t3 = U8TO32_LE(key+12);
+
+	/* precompute multipliers */
+	ctx->r0 = t0 & 0x3ffffff; t0 >>= 26; t0 |= t1 << 6;
+	ctx->r1 = t0 & 0x3ffff03; t1 >>= 20; t1 |= t2 << 12;
+	ctx->r2 = t1 & 0x3ffc0ff; t2 >>= 14; t2 |= t3 << 18;
+	ctx->r3 = t2 & 0x3f03fff; t3 >>= 8;
+	ctx->r4 = t3 & 0x00fffff;
+
+	ctx->s1 = ctx->r1 * 5;
+	ctx->s2 = ctx->r2 * 5;
+	ctx->s3 = ctx->r3 * 5;
+	ctx->s4 = ctx->r4 * 5;
+
+	/* init state */
+	ctx->h0 = 0;
+	ctx->h1 = 0;
+	ctx->h2 = 0;
+	ctx->h3 = 0;
+	ctx->h4 = 0;
+
+	ctx->buf_used = 0;
+	for (i = 0; i < 16; ++i)
+		ctx->key[i] = key[i + 16];
+
+    return 0;
+}
+
 int ccpoly1305_final(ccpoly1305_ctx *ctx, uint8_t *tag)
 {
 	uint64_t f0,f1,f2,f3;
@@ -793,6 +1014,8 @@ poly1305_donna_atmost15bytes:
 	goto poly1305_donna_mul;
 }
 
+#endif // CCPOLY1305_64BIT
+
 int	ccpoly1305(const uint8_t *key, size_t nbytes, const uint8_t *data, uint8_t *out)
 {
 	ccpoly1305_ctx ctx;
@@ -881,6 +1104,59 @@ static int finalize_aad(CC_UNUSED const struct ccchacha20poly1305_info *info, cc
     return 0;
 }
 
+// Encrypt and MAC in chunks small enough that each one is still in L1 when
+// the second function reads it, instead of two passes over the whole text.
+#define CCCHACHA20POLY1305_CHUNK_NBYTES 512
+
+static void crypt_step(ccchacha20poly1305_ctx *ctx, size_t nbytes, const uint8_t *in, uint8_t *out, bool encrypt)
+{
+    if (encrypt) {
+        ccchacha20_update(&ctx->chacha20_ctx, nbytes, in, out);
+        ccpoly1305_update(&ctx->poly1305_ctx, nbytes, out);
+    } else {
+        ccpoly1305_update(&ctx->poly1305_ctx, nbytes, in);
+        ccchacha20_update(&ctx->chacha20_ctx, nbytes, in, out);
+    }
+    ctx->text_nbytes += nbytes;
+}
+
+static void crypt_chunks(ccchacha20poly1305_ctx *ctx, size_t nbytes, const uint8_t *in, uint8_t *out, bool encrypt)
+{
+    // Cut the first chunk short so that the rest start on a block boundary.
+    size_t n = CCCHACHA20POLY1305_CHUNK_NBYTES - (size_t)(ctx->text_nbytes % CCCHACHA20_BLOCK_NBYTES);
+
+#if CCCHACHA20_AVX_INTRINSICS && CCPOLY1305_64BIT
+    // The fused kernel keeps the Poly1305 lanes live across chunks, so the
+    // setup cost of the vector MAC is paid once per call.
+    n %= CCCHACHA20_BLOCK_NBYTES;
+    if (nbytes >= n + CCCHACHA20POLY1305_AVX_NBYTES && CC_HAS_AVX2()) {
+        crypt_step(ctx, n, in, out, encrypt);
+        in += n;
+        out += n;
+        nbytes -= n;
+
+        n = nbytes & ~((size_t)(CCCHACHA20POLY1305_AVX_NBYTES - 1));
+        if (!ctx->poly1305_ctx.rpow_valid)
+            _ccpoly1305_powers(&ctx->poly1305_ctx);
+        ccchacha20poly1305_avx_crypt(ctx->chacha20_ctx.state, &ctx->poly1305_ctx, n, in, out, encrypt);
+        ctx->text_nbytes += n;
+        in += n;
+        out += n;
+        nbytes -= n;
+    }
+    n = CCCHACHA20POLY1305_CHUNK_NBYTES - (size_t)(ctx->text_nbytes % CCCHACHA20_BLOCK_NBYTES);
+#endif
+
+    while (nbytes) {
+        n = CC_MIN(n, nbytes);
+        crypt_step(ctx, n, in, out, encrypt);
+        in += n;
+        out += n;
+        nbytes -= n;
+        n = CCCHACHA20POLY1305_CHUNK_NBYTES;
+    }
+}
+
 int	ccchacha20poly1305_encrypt(CC_UNUSED const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, size_t nbytes, const void *in, void *out)
 {
     finalize_aad(info, ctx, CCCHACHA20POLY1305_STATE_ENCRYPT);
@@ -888,9 +1164,7 @@ int	ccchacha20poly1305_encrypt(CC_UNUSED const struct ccchacha20poly1305_info *i
     cc_require(UINT64_MAX - ctx->text_nbytes >= nbytes, err);
     cc_require(ctx->text_nbytes + nbytes <= CCCHACHA20POLY1305_TEXT_MAX_NBYTES, err);
 
-	ccchacha20_update(&ctx->chacha20_ctx, nbytes, in, out);
-    ccpoly1305_update(&ctx->poly1305_ctx, nbytes, out);
-    ctx->text_nbytes += nbytes;
+    crypt_chunks(ctx, nbytes, in, out, true);
 
 	return 0;
 
@@ -905,9 +1179,7 @@ int	ccchacha20poly1305_decrypt(CC_UNUSED const struct ccchacha20poly1305_info *i
     cc_require(UINT64_MAX - ctx->text_nbytes >= nbytes, err);
     cc_require(ctx->text_nbytes + nbytes <= CCCHACHA20POLY1305_TEXT_MAX_NBYTES, err);
 
-	ccpoly1305_update(&ctx->poly1305_ctx, nbytes, in);
-	ccchacha20_update(&ctx->chacha20_ctx, nbytes, in, out);
-	ctx->text_nbytes += nbytes;
+    crypt_chunks(ctx, nbytes, in, out, false);
 
 	return 0;
 
@@ -987,3 +1259,455 @@ int ccchacha20poly1305_decrypt_oneshot(const struct ccchacha20poly1305_info *inf
     ccchacha20poly1305_decrypt(info, &ctx, ctext_nbytes, ctext, ptext);
     return ccchacha20poly1305_verify(info, &ctx, tag);
 }
+
+typedef int (*ccchacha20poly1305_crypt_fn)(const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, size_t nbytes, const void *in, void *out);
+
+struct crypt_iov_ctx {
+    const struct ccchacha20poly1305_info *info;
+    ccchacha20poly1305_ctx *ctx;
+    ccchacha20poly1305_crypt_fn crypt;
+};
+
+// Partial ChaCha20 and Poly1305 blocks at fragment boundaries are carried
+// by the context.
+static int crypt_iov_run(void *crypt_ctx, size_t nbytes, const void *in, void *out)
+{
+    struct crypt_iov_ctx *c = crypt_ctx;
+    return c->crypt(c->info, c->ctx, nbytes, in, out);
+}
+
+// Feed the AAD fragments, then the text fragments through cc_iovec_crypt().
+static int crypt_iov(const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, ccchacha20poly1305_crypt_fn crypt,
+                     size_t aad_niov, const struct cc_const_iovec *aad, size_t in_niov, const struct cc_const_iovec *in, size_t out_niov, const struct cc_iovec *out)
+{
+    struct crypt_iov_ctx crypt_ctx = { .info = info, .ctx = ctx, .crypt = crypt };
+
+    for (size_t k = 0; k < aad_niov; k++) {
+        cc_require(ccchacha20poly1305_aad(info, ctx, aad[k].nbytes, aad[k].base) == 0, err);
+    }
+
+    cc_require(cc_iovec_crypt(in_niov, in, out_niov, out, crypt_iov_run, &crypt_ctx) == 0, err);
+    return 0;
+
+err:
+    return 1;
+}
+
+int ccchacha20poly1305_encrypt_iov(const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, size_t aad_niov, const struct cc_const_iovec *aad, size_t in_niov, const struct cc_const_iovec *in, size_t out_niov, const struct cc_iovec *out, uint8_t *tag)
+{
+    cc_require(crypt_iov(info, ctx, ccchacha20poly1305_encrypt, aad_niov, aad, in_niov, in, out_niov, out) == 0, err);
+    return ccchacha20poly1305_finalize(info, ctx, tag);
+
+err:
+    return 1;
+}
+
+int ccchacha20poly1305_decrypt_iov(const struct ccchacha20poly1305_info *info, ccchacha20poly1305_ctx *ctx, size_t aad_niov, const struct cc_const_iovec *aad, size_t in_niov, const struct cc_const_iovec *in, size_t out_niov, const struct cc_iovec *out, const uint8_t *tag)
+{
+    cc_require(crypt_iov(info, ctx, ccchacha20poly1305_decrypt, aad_niov, aad, in_niov, in, out_niov, out) == 0, err);
+    return ccchacha20poly1305_verify(info, ctx, tag);
+
+err:
+    return 1;
+}
+
+static void batch_tag(ccpoly1305_ctx *poly1305_ctx, const struct ccchacha20poly1305_record *r, const uint8_t *ctext, uint8_t *tag)
+{
+    uint8_t buf[8];
+
+    ccpoly1305_update(poly1305_ctx, r->aad_nbytes, r->aad);
+    ccpoly1305_update(poly1305_ctx, pad_nbytes(r->aad_nbytes), kZero64);
+    ccpoly1305_update(poly1305_ctx, r->nbytes, ctext);
+    ccpoly1305_update(poly1305_ctx, pad_nbytes(r->nbytes), kZero64);
+
+    CC_WRITE_LE64(buf, r->aad_nbytes);
+    ccpoly1305_update(poly1305_ctx, sizeof (uint64_t), buf);
+    CC_WRITE_LE64(buf, r->nbytes);
+    ccpoly1305_update(poly1305_ctx, sizeof (uint64_t), buf);
+
+    ccpoly1305_final(poly1305_ctx, tag);
+}
+
+// Seal or open one record. The ciphertext is authenticated before any
+// plaintext is written.
+static int batch_record(ccchacha20poly1305_ctx *ctx, const struct ccchacha20poly1305_record *r, bool encrypt)
+{
+    uint8_t block[CCCHACHA20_BLOCK_NBYTES];
+    uint8_t tag[CCPOLY1305_TAG_NBYTES];
+    int rc = 0;
+
+    ccchacha20_setnonce(&ctx->chacha20_ctx, r->nonce);
+    ccchacha20_setcounter(&ctx->chacha20_ctx, 0);
+    _ccchacha20_xor(&ctx->chacha20_ctx, sizeof (block), block, kZero64);
+    ccpoly1305_init(&ctx->poly1305_ctx, block);
+
+    if (encrypt && r->nbytes > 0) {
+        _ccchacha20_xor(&ctx->chacha20_ctx, r->nbytes, r->out, r->in);
+    }
+
+    batch_tag(&ctx->poly1305_ctx, r, encrypt ? r->out : r->in, tag);
+
+    if (encrypt) {
+        cc_memcpy(r->tag, tag, sizeof (tag));
+    } else if (cc_cmp_safe(sizeof (tag), tag, r->tag) != 0) {
+        rc = -1;
+        if (r->nbytes > 0) {
+            cc_clear(r->nbytes, r->out);
+        }
+    } else if (r->nbytes > 0) {
+        _ccchacha20_xor(&ctx->chacha20_ctx, r->nbytes, r->out, r->in);
+    }
+
+    return rc;
+}
+
+#if CCCHACHA20_AVX_INTRINSICS && CCPOLY1305_64BIT
+
+// Records are processed in groups of up to this many, with one ChaCha20
+// block per vector lane and one record per Poly1305 lane. Longer records
+// go through batch_record(), which already runs the wide single-nonce
+// kernels.
+#define CCCHACHA20POLY1305_BATCH_NRECORDS CCCHACHA20_AVX512_NBLOCKS
+#define CCCHACHA20POLY1305_BATCH_MAX_NBYTES 4096
+
+// ChaCha20 blocks waiting for a kernel call, each with its own counter and
+// nonce. A partial block is staged in buf and copied out after the call.
+struct batch_lanes {
+    const uint32_t *state;
+    bool avx512;
+    size_t width, n;
+    uint32_t w[4 * CCCHACHA20_AVX512_NBLOCKS];
+    uint8_t *out[CCCHACHA20_AVX512_NBLOCKS];
+    const uint8_t *in[CCCHACHA20_AVX512_NBLOCKS];
+    uint8_t *tail_out[CCCHACHA20_AVX512_NBLOCKS];
+    size_t tail_nbytes[CCCHACHA20_AVX512_NBLOCKS];
+    uint8_t buf[CCCHACHA20_AVX512_NBLOCKS][CCCHACHA20_BLOCK_NBYTES];
+};
+
+static void batch_lanes_flush(struct batch_lanes *l)
+{
+    if (l->n == 0) {
+        return;
+    }
+
+    for (size_t i = l->n; i < l->width; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            l->w[l->width * j + i] = 0;
+        }
+        l->out[i] = l->buf[i];
+        l->in[i] = l->buf[i];
+        l->tail_nbytes[i] = 0;
+    }
+
+    if (l->avx512) {
+        ccchacha20_avx512_xor_lanes(l->state, l->w, l->out, l->in);
+    } else {
+        ccchacha20_avx2_xor_lanes(l->state, l->w, l->out, l->in);
+    }
+
+    for (size_t i = 0; i < l->n; i++) {
+        if (l->tail_nbytes[i] > 0) {
+            cc_memcpy(l->tail_out[i], l->buf[i], l->tail_nbytes[i]);
+        }
+    }
+    l->n = 0;
+}
+
+// Queue block ctr of the keystream for nonce, XORed from the nbytes at in
+// (at most one block) into out.
+static void batch_lanes_add(struct batch_lanes *l, const uint8_t *nonce, uint32_t ctr, size_t nbytes, const uint8_t *in, uint8_t *out)
+{
+    size_t i = l->n;
+
+    l->w[i] = ctr;
+    l->w[l->width + i] = CC_READ_LE32(nonce + 0);
+    l->w[2 * l->width + i] = CC_READ_LE32(nonce + 4);
+    l->w[3 * l->width + i] = CC_READ_LE32(nonce + 8);
+
+    if (nbytes == CCCHACHA20_BLOCK_NBYTES) {
+        l->out[i] = out;
+        l->in[i] = in;
+        l->tail_nbytes[i] = 0;
+    } else {
+        cc_memcpy(l->buf[i], in, nbytes);
+        l->out[i] = l->buf[i];
+        l->in[i] = l->buf[i];
+        l->tail_out[i] = out;
+        l->tail_nbytes[i] = nbytes;
+    }
+
+    if (++l->n == l->width) {
+        batch_lanes_flush(l);
+    }
+}
+
+static void batch_lanes_text(struct batch_lanes *l, const struct ccchacha20poly1305_record *r)
+{
+    const uint8_t *in = r->in;
+    uint8_t *out = r->out;
+
+    for (size_t off = 0; off < r->nbytes; off += CCCHACHA20_BLOCK_NBYTES) {
+        size_t n = CC_MIN(r->nbytes - off, (size_t)CCCHACHA20_BLOCK_NBYTES);
+        batch_lanes_add(l, r->nonce, (uint32_t)(1 + off / CCCHACHA20_BLOCK_NBYTES), n, in + off, out + off);
+    }
+}
+
+// The Poly1305 input of a record, walked as runs of full blocks: the AAD,
+// its padded tail, the ciphertext, its padded tail and the lengths.
+struct batch_mac_src {
+    const struct ccchacha20poly1305_record *r;
+    const uint8_t *ctext;
+    unsigned part;
+    const uint8_t *p;
+    size_t nblocks;
+    uint8_t block[16];
+};
+
+// Move to the next nonempty run; false at the end of the input.
+static bool batch_mac_next(struct batch_mac_src *m)
+{
+    while (m->part < 5) {
+        unsigned part = m->part++;
+        size_t nbytes = part < 2 ? m->r->aad_nbytes : m->r->nbytes;
+        const uint8_t *data = part < 2 ? m->r->aad : m->ctext;
+
+        if (part == 4) {
+            CC_WRITE_LE64(m->block, m->r->aad_nbytes);
+            CC_WRITE_LE64(m->block + 8, m->r->nbytes);
+            m->p = m->block;
+            m->nblocks = 1;
+        } else if (part % 2 == 0) {
+            m->p = data;
+            m->nblocks = nbytes / 16;
+        } else {
+            size_t tail = nbytes % 16;
+            cc_clear(sizeof (m->block), m->block);
+            if (tail > 0) {
+                cc_memcpy(m->block, data + nbytes - tail, tail);
+            }
+            m->p = m->block;
+            m->nblocks = tail > 0;
+        }
+
+        if (m->nblocks > 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool batch_mac_advance(struct batch_mac_src *m, size_t nblocks)
+{
+    m->p += 16 * nblocks;
+    m->nblocks -= nblocks;
+    return m->nblocks > 0 || batch_mac_next(m);
+}
+
+// Compute the tags of n records, four at a time in the AVX2 Poly1305
+// lanes. A lane whose record ends takes the next one; the last record left
+// on its own is finished with the scalar code.
+static void batch_mac(size_t n, struct batch_mac_src *src, ccpoly1305_ctx *poly, uint8_t tags[][CCPOLY1305_TAG_NBYTES])
+{
+    uint64_t h[5][4];
+    uint32_t r[4][5];
+    size_t slot[4], next = 0;
+    const size_t none = SIZE_MAX;
+
+    for (size_t i = 0; i < n; i++) {
+        batch_mac_next(&src[i]);
+    }
+    for (size_t k = 0; k < 4; k++) {
+        slot[k] = none;
+    }
+
+    for (;;) {
+        const uint8_t *in[4];
+        size_t nactive = 0, active = none, nblocks = SIZE_MAX;
+
+        for (size_t k = 0; k < 4; k++) {
+            if (slot[k] == none && next < n) {
+                slot[k] = next++;
+                ccpoly1305_radix26(r[k], poly[slot[k]].r0, poly[slot[k]].r1, poly[slot[k]].r2);
+                for (size_t j = 0; j < 5; j++) {
+                    h[j][k] = 0;
+                }
+            }
+            if (slot[k] != none) {
+                nactive++;
+                active = k;
+                nblocks = CC_MIN(nblocks, src[slot[k]].nblocks);
+            }
+        }
+        if (nactive < 2) {
+            break;
+        }
+
+        // Idle lanes run over another lane's input with r = 0.
+        for (size_t k = 0; k < 4; k++) {
+            if (slot[k] == none) {
+                in[k] = src[slot[active]].p;
+                for (size_t j = 0; j < 5; j++) {
+                    r[k][j] = 0;
+                    h[j][k] = 0;
+                }
+            } else {
+                in[k] = src[slot[k]].p;
+            }
+        }
+
+        ccpoly1305_avx2_lanes(h, r, nblocks, in);
+
+        for (size_t k = 0; k < 4; k++) {
+            if (slot[k] != none && !batch_mac_advance(&src[slot[k]], nblocks)) {
+                uint64_t l[5] = { h[0][k], h[1][k], h[2][k], h[3][k], h[4][k] };
+                ccpoly1305_radix44(&poly[slot[k]], l);
+                slot[k] = none;
+            }
+        }
+    }
+
+    for (size_t k = 0; k < 4; k++) {
+        if (slot[k] != none) {
+            struct batch_mac_src *m = &src[slot[k]];
+            uint64_t l[5] = { h[0][k], h[1][k], h[2][k], h[3][k], h[4][k] };
+
+            ccpoly1305_radix44(&poly[slot[k]], l);
+            do {
+                ccpoly1305_update(&poly[slot[k]], 16 * m->nblocks, m->p);
+            } while (batch_mac_advance(m, m->nblocks));
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        ccpoly1305_final(&poly[i], tags[i]);
+    }
+}
+
+// Seal or open a group of short records: one keystream call per vector
+// width of blocks across all of them, and four records at a time through
+// the Poly1305 lanes. As in batch_record(), a record is authenticated
+// before any of its plaintext is written.
+static void batch_group(const uint32_t state[16], size_t n, const struct ccchacha20poly1305_record *records, int *rcs, bool encrypt)
+{
+    struct batch_lanes lanes;
+    struct batch_mac_src src[CCCHACHA20POLY1305_BATCH_NRECORDS];
+    ccpoly1305_ctx poly[CCCHACHA20POLY1305_BATCH_NRECORDS];
+    uint8_t keys[CCCHACHA20POLY1305_BATCH_NRECORDS][CCCHACHA20_BLOCK_NBYTES];
+    uint8_t tags[CCCHACHA20POLY1305_BATCH_NRECORDS][CCPOLY1305_TAG_NBYTES];
+
+    lanes.state = state;
+    lanes.avx512 = CC_HAS_AVX512F();
+    lanes.width = lanes.avx512 ? CCCHACHA20_AVX512_NBLOCKS : CCCHACHA20_AVX2_NBLOCKS;
+    lanes.n = 0;
+
+    // Block 0 of each record keys its Poly1305.
+    for (size_t i = 0; i < n; i++) {
+        batch_lanes_add(&lanes, records[i].nonce, 0, sizeof (kZero64), kZero64, keys[i]);
+    }
+    if (encrypt) {
+        for (size_t i = 0; i < n; i++) {
+            batch_lanes_text(&lanes, &records[i]);
+        }
+    }
+    batch_lanes_flush(&lanes);
+
+    for (size_t i = 0; i < n; i++) {
+        ccpoly1305_init(&poly[i], keys[i]);
+        src[i].r = &records[i];
+        src[i].ctext = encrypt ? records[i].out : records[i].in;
+        src[i].part = 0;
+    }
+    batch_mac(n, src, poly, tags);
+
+    for (size_t i = 0; i < n; i++) {
+        const struct ccchacha20poly1305_record *r = &records[i];
+
+        rcs[i] = 0;
+        if (encrypt) {
+            cc_memcpy(r->tag, tags[i], sizeof (tags[i]));
+        } else if (cc_cmp_safe(sizeof (tags[i]), tags[i], r->tag) != 0) {
+            rcs[i] = -1;
+            if (r->nbytes > 0) {
+                cc_clear(r->nbytes, r->out);
+            }
+        } else {
+            batch_lanes_text(&lanes, r);
+        }
+    }
+    batch_lanes_flush(&lanes);
+
+    cc_clear(sizeof (lanes), &lanes);
+    cc_clear(sizeof (src), src);
+    cc_clear(sizeof (poly), poly);
+    cc_clear(sizeof (keys), keys);
+    cc_clear(sizeof (tags), tags);
+}
+
+#else
+
+#define CCCHACHA20POLY1305_BATCH_NRECORDS 1
+
+#endif // CCCHACHA20_AVX_INTRINSICS && CCPOLY1305_64BIT
+
+static int batch(const struct ccchacha20poly1305_info *info, const uint8_t *key, size_t nrecords, const struct ccchacha20poly1305_record *records, int *results, bool encrypt)
+{
+    ccchacha20poly1305_ctx ctx;
+    int rc = 0;
+
+    for (size_t i = 0; i < nrecords; i++) {
+        cc_require(records[i].nbytes <= CCCHACHA20POLY1305_TEXT_MAX_NBYTES, err);
+    }
+
+    ccchacha20poly1305_init(info, &ctx, key);
+
+    for (size_t i = 0; i < nrecords;) {
+        int rcs[CCCHACHA20POLY1305_BATCH_NRECORDS];
+        size_t n = 1;
+
+#if CCCHACHA20_AVX_INTRINSICS && CCPOLY1305_64BIT
+        // Gather the consecutive short records into a group.
+        n = 0;
+        while (n < CCCHACHA20POLY1305_BATCH_NRECORDS && i + n < nrecords &&
+               records[i + n].nbytes <= CCCHACHA20POLY1305_BATCH_MAX_NBYTES) {
+            n++;
+        }
+
+        if (n >= 2 && CC_HAS_AVX2()) {
+            batch_group(ctx.chacha20_ctx.state, n, &records[i], rcs, encrypt);
+        } else
+#endif
+        {
+            n = 1;
+            rcs[0] = batch_record(&ctx, &records[i], encrypt);
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            if (results) {
+                results[i + k] = rcs[k];
+            }
+            rc = rc ? rc : rcs[k];
+        }
+        i += n;
+    }
+
+    cc_clear(sizeof (ctx), &ctx);
+    return rc;
+
+err:
+    // Nothing was processed; every record reports the error.
+    for (size_t i = 0; results && i < nrecords; i++) {
+        results[i] = 1;
+    }
+    return 1;
+}
+
+int ccchacha20poly1305_seal_batch(const struct ccchacha20poly1305_info *info, const uint8_t *key, size_t nrecords, const struct ccchacha20poly1305_record *records)
+{
+    return batch(info, key, nrecords, records, NULL, true);
+}
+
+int ccchacha20poly1305_open_batch(const struct ccchacha20poly1305_info *info, const uint8_t *key, size_t nrecords, const struct ccchacha20poly1305_record *records, int *results)
+{
+    return batch(info, key, nrecords, records, results, false);
+}
@@ -99,6 +99,14 @@ void ccdigest_final(const struct ccdigest_info *di, ccdigest_ctx_t ctx, unsigned
 void ccdigest(const struct ccdigest_info *di, size_t len,
               const void *data, void *digest);
 
+/* Hash n independent messages, message i being lens[i] bytes at datas[i]
+   with its digest written to outs[i]. For SHA-2 this runs several messages
+   in parallel in SIMD lanes where available, which gives a much higher
+   aggregate throughput than hashing them one at a time for short messages
+   of similar lengths. Other digests are computed one message at a time. */
+void ccdigest_multi(const struct ccdigest_info *di, size_t n,
+                    const size_t *lens, const void *const *datas, void *const *outs);
+
 #define OID_DEF(_VALUE_)  ((const unsigned char *)_VALUE_)
 
 #define CC_DIGEST_OID_MD2           OID_DEF("\x06\x08\x2A\x86\x48\x86\xF7\x0D\x02\x02")
@@ -19,4 +19,42 @@ void ccdigest_final_64be(const struct ccdigest_info *di, ccdigest_ctx_t,
 void ccdigest_final_64le(const struct ccdigest_info *di, ccdigest_ctx_t,
                          unsigned char *digest);
 
+#if CCSHA2_MULTI_INTRINSICS
+/* Multi-lane compression for a digest, hashing one block of each of nlanes
+   independent messages per call. Lane states are transposed: word j of the
+   state of lane i is at state[j * nlanes + i], with words of word_size bytes.
+   compress reads the block of lane i from in[i]; compress_words takes the
+   blocks as host order words, word t of lane i at words[t * nlanes + i]. */
+struct ccdigest_multi_info {
+    size_t nlanes;
+    /* Fewer messages than this are faster one at a time on di->compress. */
+    size_t min_nlanes;
+    size_t word_size;
+    void (*compress)(void *state, const uint8_t *const *in);
+    void (*compress_words)(void *state, const void *words);
+};
+
+#define CCDIGEST_MULTI_MAX_NLANES 16
+
+/* Transposed states, or blocks as words, of up to CCDIGEST_MULTI_MAX_NLANES lanes. */
+typedef union {
+    uint32_t u32[16 * CCDIGEST_MULTI_MAX_NLANES];
+    uint64_t u64[16 * CCDIGEST_MULTI_MAX_NLANES];
+} ccdigest_multi_words;
+
+/* Return the multi-lane compression for di on this CPU, or NULL when hashing
+   one message at a time is as fast. */
+const struct ccdigest_multi_info *ccdigest_multi_info(const struct ccdigest_info *di);
+
+/* The SHA-2 kernels, for any of the SHA-224/256 or SHA-384/512 variants.
+   Only use an AVX2 or AVX-512 one when CC_HAS_AVX2() or CC_HAS_AVX512F(). */
+extern const struct ccdigest_multi_info ccsha256_avx2_multi_info;
+extern const struct ccdigest_multi_info ccsha256_avx512_multi_info;
+#if CCSHA_SHANI_INTRINSICS
+extern const struct ccdigest_multi_info ccsha256_avx512_shani_multi_info;
+#endif
+extern const struct ccdigest_multi_info ccsha512_avx2_multi_info;
+extern const struct ccdigest_multi_info ccsha512_avx512_multi_info;
+#endif
+
 #endif /* _CORECRYPTO_CCDIGEST_INTERNAL_H_ */
@@ -29,6 +29,10 @@ entryPoint(ccdigest,"ccdigest test")
 #include <corecrypto/ccsha1.h>
 #include <corecrypto/ccsha2.h>
 #include <corecrypto/ccripemd.h>
+#include <corecrypto/cc_runtime_config.h>
+#include "ccsha1_internal.h"
+#include "ccsha2_internal.h"
+#include "ccdigest_internal.h"
 
 /* Currently, ccdigest and friends won't work when length == 0 and the
  * data pointer is NULL.
@@ -363,6 +367,157 @@ static int test_finalize(const struct ccdigest_info *di)
     return 1;
 }
 
+static int test_digest_multi(const struct ccdigest_info *di)
+{
+    uint8_t data[37][300];
+    uint8_t outs[37][CCSHA512_OUTPUT_SIZE];
+    uint8_t expected[CCSHA512_OUTPUT_SIZE];
+    size_t lens[37];
+    const void *datas[37];
+    void *outps[37];
+    const size_t n = CC_ARRAY_LEN(lens);
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < sizeof(data[i]); j++) {
+            data[i][j] = (uint8_t)(i * 31 + j);
+        }
+        datas[i] = data[i];
+        outps[i] = outs[i];
+    }
+
+    // Equal lengths, then different lengths across the padding boundaries.
+    for (size_t k = 0; k < 2; k++) {
+        for (size_t i = 0; i < n; i++) {
+            lens[i] = k ? (i * 71) % 300 : di->block_size;
+        }
+
+        ccdigest_multi(di, n, lens, datas, outps);
+
+        for (size_t i = 0; i < n; i++) {
+            ccdigest(di, lens[i], datas[i], expected);
+            if (memcmp(outs[i], expected, di->output_size)) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+#if CCSHA2_MULTI_INTRINSICS
+// Hash mi->nlanes messages of three blocks each, padding included, straight
+// through mi->compress and then mi->compress_words, and compare each lane
+// with ccdigest on di.
+static int test_digest_multi_info(const struct ccdigest_info *di, const struct ccdigest_multi_info *mi)
+{
+    const size_t bs = di->block_size;
+    const size_t ws = mi->word_size;
+    const size_t nlanes = mi->nlanes;
+    uint8_t blocks[CCDIGEST_MULTI_MAX_NLANES][3 * CCSHA512_BLOCK_SIZE];
+    uint8_t digest[CCSHA512_OUTPUT_SIZE];
+    uint8_t expected[CCSHA512_OUTPUT_SIZE];
+    const uint8_t *in[CCDIGEST_MULTI_MAX_NLANES];
+    size_t lens[CCDIGEST_MULTI_MAX_NLANES];
+    ccdigest_multi_words state;
+    ccdigest_multi_words words;
+
+    for (size_t i = 0; i < nlanes; i++) {
+        lens[i] = 2 * bs + (i * 7) % (bs - 2 * ws);
+        cc_clear(sizeof(blocks[i]), blocks[i]);
+        for (size_t j = 0; j < lens[i]; j++) {
+            blocks[i][j] = (uint8_t)(i * 13 + j);
+        }
+        blocks[i][lens[i]] = 0x80;
+        CC_STORE64_BE((uint64_t)lens[i] << 3, blocks[i] + 3 * bs - 8);
+    }
+
+    for (size_t k = 0; k < 2; k++) {
+        for (size_t j = 0; j < 8; j++) {
+            for (size_t i = 0; i < nlanes; i++) {
+                if (ws == sizeof(uint32_t)) {
+                    state.u32[j * nlanes + i] = ((const uint32_t *)di->initial_state)[j];
+                } else {
+                    state.u64[j * nlanes + i] = ((const uint64_t *)di->initial_state)[j];
+                }
+            }
+        }
+
+        for (size_t b = 0; b < 3; b++) {
+            if (k == 0) {
+                for (size_t i = 0; i < nlanes; i++) {
+                    in[i] = blocks[i] + b * bs;
+                }
+                mi->compress(&state, in);
+                continue;
+            }
+
+            for (size_t t = 0; t < 16; t++) {
+                for (size_t i = 0; i < nlanes; i++) {
+                    const uint8_t *p = blocks[i] + b * bs + t * ws;
+                    if (ws == sizeof(uint32_t)) {
+                        CC_LOAD32_BE(words.u32[t * nlanes + i], p);
+                    } else {
+                        CC_LOAD64_BE(words.u64[t * nlanes + i], p);
+                    }
+                }
+            }
+            mi->compress_words(&state, &words);
+        }
+
+        for (size_t i = 0; i < nlanes; i++) {
+            for (size_t j = 0; j < di->output_size / ws; j++) {
+                if (ws == sizeof(uint32_t)) {
+                    CC_STORE32_BE(state.u32[j * nlanes + i], digest + j * ws);
+                } else {
+                    CC_STORE64_BE(state.u64[j * nlanes + i], digest + j * ws);
+                }
+            }
+
+            ccdigest(di, lens[i], blocks[i], expected);
+            if (memcmp(digest, expected, di->output_size)) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+#endif
+
+// Digest every length up to 2000 bytes with di, fed in three updates
+// that straddle block boundaries, and compare against ref in one shot.
+static int test_digest_split(const struct ccdigest_info *di, const struct ccdigest_info *ref)
+{
+    static uint8_t data[2000];
+    uint8_t digest[CCSHA256_OUTPUT_SIZE];
+    uint8_t expected[CCSHA256_OUTPUT_SIZE];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        size_t a = len / 3;
+        size_t b = a + (len - a) / 2;
+
+        ccdigest_di_decl(di, ctx);
+        ccdigest_init(di, ctx);
+        ccdigest_update(di, ctx, a, data);
+        ccdigest_update(di, ctx, b - a, data + a);
+        ccdigest_update(di, ctx, len - b, data + b);
+        ccdigest_final(di, ctx, digest);
+        ccdigest_di_clear(di, ctx);
+
+        ccdigest(ref, len, data, expected);
+        if (memcmp(digest, expected, di->output_size)) {
+            diag("%zu byte message mismatch", len);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 static int test_digest(const struct ccdigest_info *di) {
     ok(test_digest_of_zero(di), "test_digest_of_zero");
     ok(test_digest_lt_blocksize(di), "test_digest_lt_blocksize");
@@ -379,6 +534,30 @@ int ccdigest_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     int ntests = 956;
     ntests += 20; // test_huge_input
     ntests += 45; // test_finalize
+    ntests += 7;  // test_digest_multi
+#if CCSHA2_MULTI_INTRINSICS
+    if (CC_HAS_AVX2()) {
+        ntests += 2; // AVX2 multi kernels
+    }
+    if (CC_HAS_AVX512F()) {
+        ntests += 2; // AVX-512 multi kernels
+    }
+#if CCSHA_SHANI_INTRINSICS
+    if (CC_HAS_SHA_NI() && CC_HAS_AVX512F()) {
+        ntests += 1; // SHA-NI with AVX-512 multi kernel
+    }
+#endif
+#endif
+#if CCSHA_SHANI_INTRINSICS
+    if (CC_HAS_SHA_NI()) {
+        ntests += 180; // SHA-NI test_digest and test_digest_split
+    }
+#endif
+#if CCSHA_AVX2_INTRINSICS
+    if (CC_HAS_AVX2()) {
+        ntests += 180; // AVX2 test_digest and test_digest_split
+    }
+#endif
     plan_tests(ntests);
 
     ok(test_huge_input(&custom1_di), "test_huge_input #1");
@@ -397,6 +576,30 @@ int ccdigest_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     ok(test_digest(&ccrmd160_ltc_di), "ccrmd160_ltc_di");
     ok(test_digest(&ccsha512_256_ltc_di), "ccsha512_256_ltc_di");
     
+#if CCSHA_SHANI_INTRINSICS
+    // SHA-NI intrinsics, checked against the C version
+    if (CC_HAS_SHA_NI()) {
+        ok(test_digest(&ccsha1_shani_di), "ccsha1_shani_di");
+        ok(test_digest(&ccsha224_shani_di), "ccsha224_shani_di");
+        ok(test_digest(&ccsha256_shani_di), "ccsha256_shani_di");
+        ok(test_digest_split(&ccsha1_shani_di, &ccsha1_ltc_di), "ccsha1_shani_di split updates");
+        ok(test_digest_split(&ccsha224_shani_di, &ccsha224_ltc_di), "ccsha224_shani_di split updates");
+        ok(test_digest_split(&ccsha256_shani_di, &ccsha256_ltc_di), "ccsha256_shani_di split updates");
+    }
+#endif
+
+#if CCSHA_AVX2_INTRINSICS
+    // AVX2 message schedule, checked against the C version
+    if (CC_HAS_AVX2()) {
+        ok(test_digest(&ccsha1_avx2_di), "ccsha1_avx2_di");
+        ok(test_digest(&ccsha224_avx2_di), "ccsha224_avx2_di");
+        ok(test_digest(&ccsha256_avx2_di), "ccsha256_avx2_di");
+        ok(test_digest_split(&ccsha1_avx2_di, &ccsha1_ltc_di), "ccsha1_avx2_di split updates");
+        ok(test_digest_split(&ccsha224_avx2_di, &ccsha224_ltc_di), "ccsha224_avx2_di split updates");
+        ok(test_digest_split(&ccsha256_avx2_di, &ccsha256_ltc_di), "ccsha256_avx2_di split updates");
+    }
+#endif
+
     // Default (optimized)
     ok(test_digest(ccsha1_di()),   "Default ccsha1_di");
     ok(test_digest(ccsha224_di()), "Default ccsha224_di");
@@ -405,6 +608,31 @@ int ccdigest_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     ok(test_digest(ccsha512_di()), "Default ccsha512_di");
     ok(test_digest(ccsha512_256_di()), "Default ccsha512_256_di");
 
+    ok(test_digest_multi(ccsha1_di()), "ccdigest_multi ccsha1_di");
+    ok(test_digest_multi(ccsha224_di()), "ccdigest_multi ccsha224_di");
+    ok(test_digest_multi(ccsha256_di()), "ccdigest_multi ccsha256_di");
+    ok(test_digest_multi(&ccsha256_ltc_di), "ccdigest_multi ccsha256_ltc_di");
+    ok(test_digest_multi(ccsha384_di()), "ccdigest_multi ccsha384_di");
+    ok(test_digest_multi(ccsha512_di()), "ccdigest_multi ccsha512_di");
+    ok(test_digest_multi(ccsha512_256_di()), "ccdigest_multi ccsha512_256_di");
+
+#if CCSHA2_MULTI_INTRINSICS
+    // Each multi-lane kernel, whichever one ccdigest_multi picks on this CPU
+    if (CC_HAS_AVX2()) {
+        ok(test_digest_multi_info(&ccsha256_ltc_di, &ccsha256_avx2_multi_info), "ccsha256_avx2_multi_info");
+        ok(test_digest_multi_info(&ccsha512_ltc_di, &ccsha512_avx2_multi_info), "ccsha512_avx2_multi_info");
+    }
+    if (CC_HAS_AVX512F()) {
+        ok(test_digest_multi_info(&ccsha256_ltc_di, &ccsha256_avx512_multi_info), "ccsha256_avx512_multi_info");
+        ok(test_digest_multi_info(&ccsha512_ltc_di, &ccsha512_avx512_multi_info), "ccsha512_avx512_multi_info");
+    }
+#if CCSHA_SHANI_INTRINSICS
+    if (CC_HAS_SHA_NI() && CC_HAS_AVX512F()) {
+        ok(test_digest_multi_info(&ccsha224_shani_di, &ccsha256_avx512_shani_multi_info), "ccsha256_avx512_shani_multi_info");
+    }
+#endif
+#endif
+
     //this is a standalone KAT test for sha256. It is used when clients have only sha256 available.
     ok(sha256_kat()==0, "sha256, standalone KAT");
 
@@ -55,6 +55,37 @@ typedef struct cchmac_ctx* cchmac_ctx_t;
 
 void cchmac_init(const struct ccdigest_info *di, cchmac_ctx_t ctx,
                  size_t key_len, const void *key);
+
+/* A prepared key holds the inner and outer digest states after compressing
+   the key XORed with ipad and opad. It depends only on the key, so it can be
+   computed once with cchmac_key_prepare() and used to start any number of
+   MACs with cchmac_init_prepared(), skipping the key setup of cchmac_init(). */
+struct cchmac_key {
+    uint8_t b[1];
+} CC_ALIGNED(8);
+
+typedef struct cchmac_key* cchmac_key_t;
+
+#define cchmac_key_size(STATE_SIZE) (2 * (STATE_SIZE))
+#define cchmac_key_di_size(_di_)  (cchmac_key_size((_di_)->state_size))
+
+#define cchmac_key_decl(STATE_SIZE, _name_) cc_ctx_decl(struct cchmac_key, cchmac_key_size(STATE_SIZE), _name_)
+#define cchmac_key_clear(STATE_SIZE, _name_) cc_clear(cchmac_key_size(STATE_SIZE), _name_)
+#define cchmac_key_di_decl(_di_, _name_) cchmac_key_decl((_di_)->state_size, _name_)
+#define cchmac_key_di_clear(_di_, _name_) cchmac_key_clear((_di_)->state_size, _name_)
+
+/* Accessors for the inner and outer states of a prepared key, writable
+   and read-only. */
+#define cchmac_key_istate(_di_, K) ((struct ccdigest_state *)((K)->b))
+#define cchmac_key_ostate(_di_, K) ((struct ccdigest_state *)((K)->b + (_di_)->state_size))
+#define cchmac_key_const_istate(_di_, K) ((const struct ccdigest_state *)((K)->b))
+#define cchmac_key_const_ostate(_di_, K) ((const struct ccdigest_state *)((K)->b + (_di_)->state_size))
+
+void cchmac_key_prepare(const struct ccdigest_info *di, cchmac_key_t key,
+                        size_t key_len, const void *key_data);
+void cchmac_init_prepared(const struct ccdigest_info *di, cchmac_ctx_t ctx,
+                          const struct cchmac_key *key);
+
 void cchmac_update(const struct ccdigest_info *di, cchmac_ctx_t ctx,
                    size_t data_len, const void *data);
 void cchmac_final(const struct ccdigest_info *di, cchmac_ctx_t ctx,
@@ -18,6 +18,7 @@ static int verbose = 0;
 #if (CCHMAC == 0)
 entryPoint(cchmac_tests,"cchmac test")
 #else
+#include <corecrypto/cc_priv.h>
 #include <corecrypto/ccasn1.h>
 #include <corecrypto/ccdigest.h>
 #include <corecrypto/ccdigest_priv.h>
@@ -260,17 +261,56 @@ static int test_hmac_of_zero(const struct ccdigest_info *di) {
     return 1;
 }
 
+static int test_hmac_prepared(const struct ccdigest_info *di) {
+    uint8_t key[200];
+    uint8_t data[300];
+    uint8_t mac[CCSHA512_OUTPUT_SIZE];
+    uint8_t expected[CCSHA512_OUTPUT_SIZE];
+    const size_t key_lens[] = { 0, 16, di->block_size, di->block_size + 1, sizeof(key) };
+
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t)(i * 7);
+    }
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 13);
+    }
+
+    for (size_t k = 0; k < CC_ARRAY_LEN(key_lens); k++) {
+        cchmac_key_di_decl(di, pk);
+        cchmac_key_prepare(di, pk, key_lens[k], key);
+
+        // The same prepared key is used for every message.
+        for (size_t len = 0; len <= sizeof(data); len += 37) {
+            cchmac_di_decl(di, hc);
+            cchmac_init_prepared(di, hc, pk);
+            cchmac_update(di, hc, len, data);
+            cchmac_final(di, hc, mac);
+            cchmac_di_clear(di, hc);
+
+            cchmac(di, key_lens[k], key, len, data, expected);
+            if (memcmp(mac, expected, di->output_size)) {
+                return 0;
+            }
+        }
+
+        cchmac_key_di_clear(di, pk);
+    }
+
+    return 1;
+}
+
 static int test_hmac(const struct ccdigest_info *di) {
     ok(test_hmac_of_zero(di), "test_hmac_of_zero");
     ok(test_hmac_lt_blocksize(di), "test_hmac_lt_blocksize");
     ok(test_hmac_eq_blocksize(di), "test_hmac_eq_blocksize");
     ok(test_hmac_many_blocks(di), "test_hmac_many_blocks");
+    ok(test_hmac_prepared(di), "test_hmac_prepared");
     return 1;
 }
 
 int cchmac_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 {
-    plan_tests(795);
+    plan_tests(810);
 
     if(verbose) diag("Starting hmac tests\n");
 
@@ -0,0 +1,25 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include <corecrypto/ccdigest_priv.h>
+#include <corecrypto/cchmac.h>
+#include <corecrypto/cc_priv.h>
+
+/* Same state as cchmac_init() leaves, with the inner and outer key blocks
+   already compressed by cchmac_key_prepare(). */
+void cchmac_init_prepared(const struct ccdigest_info *di, cchmac_ctx_t hc,
+                          const struct cchmac_key *key) {
+    ccdigest_copy_state(di, cchmac_ostate(di, hc), cchmac_key_const_ostate(di, key));
+    ccdigest_copy_state(di, cchmac_istate(di, hc), cchmac_key_const_istate(di, key));
+    cchmac_num(di, hc) = 0;
+    cchmac_nbits(di, hc) = di->block_size * 8;
+}
@@ -0,0 +1,28 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include <corecrypto/ccdigest_priv.h>
+#include <corecrypto/cchmac.h>
+#include <corecrypto/cc_priv.h>
+
+#include "corecrypto/fipspost_trace.h"
+
+void cchmac_key_prepare(const struct ccdigest_info *di, cchmac_key_t key,
+                        size_t key_len, const void *key_data) {
+    FIPSPOST_TRACE_EVENT;
+
+    cchmac_di_decl(di, hc);
+    cchmac_init(di, hc, key_len, key_data);
+    ccdigest_copy_state(di, cchmac_key_istate(di, key), cchmac_istate(di, hc));
+    ccdigest_copy_state(di, cchmac_key_ostate(di, key), cchmac_ostate(di, hc));
+    cchmac_di_clear(di, hc);
+}
@@ -628,6 +628,78 @@ cc_deprecate_with_replacement("ccgcm_aad", 13.0, 10.15, 13.0, 6.0, 4.0)
     return mode->gmac(ctx, nbytes, in);
 }
 
+/*!
+ @struct     ccgcm_aad_snapshot
+ @abstract   GHASH state after a prefix of the additional data.
+
+ @discussion Only meaningful with the key of the context it was saved from. Treat the contents as opaque.
+
+ @warning The snapshot is secret key material. It holds GHASH_H of the prefix, from which the hash key H can be recovered
+ when the prefix is known, and knowing H allows forging tags under the key. Keep it in memory no more exposed than the
+ context, never store or transmit it, and clear it with @p cc_clear once the records using it are done.
+ */
+struct ccgcm_aad_snapshot {
+    uint8_t ghash[16];
+    uint64_t aad_nbytes;
+};
+
+/*!
+ @function   ccgcm_aad_save
+ @abstract   Save the state reached after authenticating a prefix of the additional data.
+
+ @param      mode       Descriptor for the mode
+ @param      ctx        Context for this instance
+ @param      snapshot   Saved state
+
+ @result     0 iff successful.
+
+ @discussion May be called after @p ccgcm_aad and before @p ccgcm_update. The GHASH state over the additional data does not
+ depend on the IV, so the snapshot may be restored into later messages under the same key with @p ccgcm_aad_restore.
+
+ A typical use is a header prefix that is identical for every record:
+
+ @code ccgcm_init_with_iv(...)
+ ccgcm_aad(...)       (the common prefix)
+ ccgcm_aad_save(...)
+ ccgcm_aad(...)       (the rest of the additional data)
+ ccgcm_update(...)
+ ccgcm_finalize(...)
+
+ and then for each further record:
+
+ @code ccgcm_reset(...)
+ ccgcm_inc_iv(...)
+ ccgcm_aad_restore(...)
+ ccgcm_aad(...)       (the rest of the additional data)
+ ccgcm_update(...)
+ ccgcm_finalize(...)
+
+ and once the last record is done:
+
+ @code cc_clear(sizeof(snapshot), &snapshot)
+ ccgcm_ctx_clear(...)
+
+ @warning @p snapshot is as sensitive as the key; see @p ccgcm_aad_snapshot.
+ */
+int ccgcm_aad_save(const struct ccmode_gcm *mode, const ccgcm_ctx *ctx, struct ccgcm_aad_snapshot *snapshot);
+
+/*!
+ @function   ccgcm_aad_restore
+ @abstract   Resume from a saved prefix of the additional data.
+
+ @param      mode       Descriptor for the mode
+ @param      ctx        Context for this instance
+ @param      snapshot   State saved by @p ccgcm_aad_save
+
+ @result     0 iff successful.
+
+ @discussion Equivalent to calling @p ccgcm_aad on the prefix that was authenticated when @p snapshot was saved. Must be called
+ after the IV is set and before any additional data is authenticated.
+
+ @warning @p snapshot must have been saved from a context initialized with the same key.
+ */
+int ccgcm_aad_restore(const struct ccmode_gcm *mode, ccgcm_ctx *ctx, const struct ccgcm_aad_snapshot *snapshot);
+
 /*!
  @function   ccgcm_update
  @abstract   Encrypt or decrypt data.
@@ -783,6 +855,180 @@ int ccgcm_one_shot_legacy(const struct ccmode_gcm *mode,
                           size_t tag_nbytes,
                           void *tag);
 
+/*!
+ @function   ccgcm_one_shot_parallel
+ @abstract   Encrypt or decrypt a large message with GCM on several threads.
+
+ @param      mode           Descriptor for the mode
+ @param      key_nbytes     Length of the key in bytes
+ @param      key            Key for the underlying blockcipher (AES)
+ @param      iv_nbytes      Length of the IV in bytes
+ @param      iv             Initialization vector
+ @param      adata_nbytes   Length of the additional data in bytes
+ @param      adata          Additional data to authenticate
+ @param      nbytes         Length of the data in bytes
+ @param      in             Input plaintext or ciphertext
+ @param      out            Output ciphertext or plaintext
+ @param      tag_nbytes     Length of the tag in bytes
+ @param      tag            Authentication tag
+ @param      nthreads       Maximum number of threads to use, including the calling thread
+
+ @result     0 iff successful.
+
+ @discussion Produces the same output and tag as @p ccgcm_one_shot, with the same treatment of @p tag on decryption.
+
+ The text is split into up to @p nthreads chunks. Each chunk is encrypted from its own counter offset on its own thread and
+ hashed into a partial GHASH value, and the partial values are then combined using powers of H. Messages too short to amortize
+ the thread start-up, and platforms without threads, are processed on the calling thread.
+ */
+int ccgcm_one_shot_parallel(const struct ccmode_gcm *mode,
+                            size_t key_nbytes,
+                            const void *key,
+                            size_t iv_nbytes,
+                            const void *iv,
+                            size_t adata_nbytes,
+                            const void *adata,
+                            size_t nbytes,
+                            const void *in,
+                            void *out,
+                            size_t tag_nbytes,
+                            void *tag,
+                            size_t nthreads);
+
+/*!
+ @function   ccgcm_encrypt_iov
+ @abstract   Encrypt and authenticate a scattered message with GCM.
+
+ @param      mode       Descriptor for the mode
+ @param      ctx        Context for this instance
+ @param      aad_niov   Number of additional data fragments
+ @param      aad        Additional data to authenticate
+ @param      in_niov    Number of plaintext fragments
+ @param      in         Input plaintext
+ @param      out_niov   Number of ciphertext fragments
+ @param      out        Output ciphertext
+ @param      tag_nbytes Length of the tag in bytes
+ @param      tag        Generated authentication tag
+
+ @result     0 iff successful.
+
+ @discussion Equivalent to calling @p ccgcm_aad on each fragment of @p aad, @p ccgcm_update on the plaintext and @p
+ ccgcm_finalize, on a context that was set up with @p ccgcm_init and @p ccgcm_set_iv (or @p ccgcm_init_with_iv).
+
+ The fragments of @p in and @p out may be split at different offsets, but must add up to the same length. Blocks straddling
+ fragment boundaries are carried internally, so fragment sizes need not be multiples of the block size.
+
+ In-place processing is supported when @p out describes the same bytes as @p in.
+ */
+int ccgcm_encrypt_iov(const struct ccmode_gcm *mode,
+                      ccgcm_ctx *ctx,
+                      size_t aad_niov,
+                      const struct cc_const_iovec *aad,
+                      size_t in_niov,
+                      const struct cc_const_iovec *in,
+                      size_t out_niov,
+                      const struct cc_iovec *out,
+                      size_t tag_nbytes,
+                      void *tag);
+
+/*!
+ @function   ccgcm_decrypt_iov
+ @abstract   Decrypt and verify a scattered message with GCM.
+
+ @param      mode       Descriptor for the mode
+ @param      ctx        Context for this instance
+ @param      aad_niov   Number of additional data fragments
+ @param      aad        Additional data to authenticate
+ @param      in_niov    Number of ciphertext fragments
+ @param      in         Input ciphertext
+ @param      out_niov   Number of plaintext fragments
+ @param      out        Output plaintext
+ @param      tag_nbytes Length of the tag in bytes
+ @param      tag        Expected authentication tag
+
+ @result     0 iff authentic and otherwise successful.
+
+ @discussion The decryption counterpart of @p ccgcm_encrypt_iov. Unlike @p ccgcm_finalize, @p tag is only read.
+
+ @warning The plaintext is written to @p out before the tag is checked. It must be discarded if authentication fails.
+ */
+int ccgcm_decrypt_iov(const struct ccmode_gcm *mode,
+                      ccgcm_ctx *ctx,
+                      size_t aad_niov,
+                      const struct cc_const_iovec *aad,
+                      size_t in_niov,
+                      const struct cc_const_iovec *in,
+                      size_t out_niov,
+                      const struct cc_iovec *out,
+                      size_t tag_nbytes,
+                      const void *tag);
+
+/*!
+ @struct     ccgcm_record
+ @abstract   One record of a batch sealed or opened under a single key.
+
+ @field      iv         Initialization vector of exactly @p CCGCM_IV_NBYTES bytes
+ @field      aad_nbytes Length of the additional data in bytes
+ @field      aad        Additional data to authenticate
+ @field      nbytes     Length of the text in bytes
+ @field      in         Input text
+ @field      out        Output text, which may be the same as @p in
+ @field      tag        Authentication tag, written by @p ccgcm_seal_batch and read by @p ccgcm_open_batch
+ */
+struct ccgcm_record {
+    const void *iv;
+    size_t aad_nbytes;
+    const void *aad;
+    size_t nbytes;
+    const void *in;
+    void *out;
+    void *tag;
+};
+
+/*!
+ @function   ccgcm_seal_batch
+ @abstract   Encrypt and authenticate many records under the same key.
+
+ @param      mode       Descriptor for the mode
+ @param      ctx        Context initialized with @p ccgcm_init
+ @param      nrecords   Number of records
+ @param      records    Records to seal
+ @param      tag_nbytes Length of the tags in bytes, at most @p CCGCM_BLOCK_NBYTES
+
+ @result     0 iff successful.
+
+ @discussion Each record gives the same result as @p ccgcm_one_shot with its own IV. The key schedule and GHASH tables in @p
+ ctx are set up once for the whole batch, and the counter blocks of consecutive short records are encrypted together, so that
+ the per-record cost does not include a context initialization nor the latency of single-block ECB calls. The GHASH
+ accumulators of up to eight records advance together, one block per step, so that their multiplications overlap.
+
+ On return, @p ctx is reset and may be used for further batches.
+
+ @warning The key-IV pair must be unique per encryption.
+ */
+int ccgcm_seal_batch(const struct ccmode_gcm *mode, ccgcm_ctx *ctx, size_t nrecords, const struct ccgcm_record *records, size_t tag_nbytes);
+
+/*!
+ @function   ccgcm_open_batch
+ @abstract   Decrypt and verify many records under the same key.
+
+ @param      mode       Descriptor for the mode
+ @param      ctx        Context initialized with @p ccgcm_init
+ @param      nrecords   Number of records
+ @param      records    Records to open
+ @param      tag_nbytes Length of the tags in bytes, at most @p CCGCM_BLOCK_NBYTES
+ @param      results    Optional array of @p nrecords results, set to 0 or @p CCMODE_INTEGRITY_FAILURE, or to the returned error
+                        for the records left unprocessed when the batch stops on any other error
+
+ @result     0 iff all records are authentic, @p CCMODE_INTEGRITY_FAILURE if at least one is not, or another negative error if
+             the batch could not be processed.
+
+ @discussion The decryption counterpart of @p ccgcm_seal_batch. The output of a record that fails authentication is cleared.
+
+ On return, @p ctx is reset and may be used for further batches.
+ */
+int ccgcm_open_batch(const struct ccmode_gcm *mode, ccgcm_ctx *ctx, size_t nrecords, const struct ccgcm_record *records, size_t tag_nbytes, int *results);
+
 /* CCM */
 
 #define ccccm_ctx_decl(_size_, _name_) cc_ctx_decl(ccccm_ctx, _size_, _name_)
@@ -17,21 +17,29 @@
 #include <corecrypto/cc_priv.h>
 #include <corecrypto/cc_macros.h>
 #include <corecrypto/cc_memory.h>
+#include "cc_internal.h"
 
 /* Macros defined in this file are only to be used
  within corecrypto files.
  */
 
+/* Largest block size of the ciphers the generic modes run over, for
+ sizing block buffers on the stack. */
+#define CCMODE_MAX_BLOCK_SIZE 16
+
 /* For CBC, direction of underlying ecb is the same as the cbc direction */
 #define CCMODE_CBC_FACTORY(_cipher_, _dir_)                                     \
 static CC_READ_ONLY_LATE(struct ccmode_cbc) cbc_##_cipher_##_##_dir_;           \
                                                                                 \
+static void cbc_##_cipher_##_##_dir_##_init(void)                               \
+{                                                                               \
+    const struct ccmode_ecb *ecb=cc##_cipher_##_ecb_##_dir_##_mode();           \
+    ccmode_factory_cbc_##_dir_(&cbc_##_cipher_##_##_dir_, ecb);                 \
+}                                                                               \
+                                                                                \
 const struct ccmode_cbc *cc##_cipher_##_cbc_##_dir_##_mode(void)                \
 {                                                                               \
-    if (!CC_CACHE_DESCRIPTORS || NULL == cbc_##_cipher_##_##_dir_.init) {        \
-        const struct ccmode_ecb *ecb=cc##_cipher_##_ecb_##_dir_##_mode();       \
-        ccmode_factory_cbc_##_dir_(&cbc_##_cipher_##_##_dir_, ecb);             \
-    }                                                                           \
+    CC_DESCRIPTOR_ONCE(cbc_##_cipher_##_##_dir_##_init);                        \
     return &cbc_##_cipher_##_##_dir_;                                           \
 }
 
@@ -39,10 +47,15 @@ const struct ccmode_cbc *cc##_cipher_##_cbc_##_dir_##_mode(void)
 #define CCMODE_CTR_FACTORY(_cipher_)                                            \
 static struct ccmode_ctr ctr_##_cipher_;                                        \
                                                                                 \
-const struct ccmode_ctr *cc##_cipher_##_ctr_crypt_mode(void)                    \
+static void ctr_##_cipher_##_init(void)                                         \
 {                                                                               \
     const struct ccmode_ecb *ecb=cc##_cipher_##_ecb_encrypt_mode();             \
     ccmode_factory_ctr_crypt(&ctr_##_cipher_, ecb);                             \
+}                                                                               \
+                                                                                \
+const struct ccmode_ctr *cc##_cipher_##_ctr_crypt_mode(void)                    \
+{                                                                               \
+    CC_DESCRIPTOR_ONCE(ctr_##_cipher_##_init);                                  \
     return &ctr_##_cipher_;                                                     \
 }
 
@@ -50,10 +63,15 @@ const struct ccmode_ctr *cc##_cipher_##_ctr_crypt_mode(void)
 #define CCMODE_OFB_FACTORY(_cipher_)                                            \
 static struct ccmode_ofb ofb_##_cipher_;                                        \
                                                                                 \
-const struct ccmode_ofb *cc##_cipher_##_ofb_crypt_mode(void)                    \
+static void ofb_##_cipher_##_init(void)                                         \
 {                                                                               \
     const struct ccmode_ecb *ecb=cc##_cipher_##_ecb_encrypt_mode();             \
     ccmode_factory_ofb_crypt(&ofb_##_cipher_, ecb);                             \
+}                                                                               \
+                                                                                \
+const struct ccmode_ofb *cc##_cipher_##_ofb_crypt_mode(void)                    \
+{                                                                               \
+    CC_DESCRIPTOR_ONCE(ofb_##_cipher_##_init);                                  \
     return &ofb_##_cipher_;                                                     \
 }
 
@@ -62,12 +80,15 @@ const struct ccmode_ofb *cc##_cipher_##_ofb_crypt_mode(void)
 #define CCMODE_CFB_FACTORY(_cipher_, _mode_, _dir_)                             \
 static CC_READ_ONLY_LATE(struct ccmode_##_mode_) _mode_##_##_cipher_##_##_dir_; \
                                                                                 \
+static void _mode_##_##_cipher_##_##_dir_##_init(void)                          \
+{                                                                               \
+    const struct ccmode_ecb *ecb=cc##_cipher_##_ecb_encrypt_mode();             \
+    ccmode_factory_##_mode_##_##_dir_(&_mode_##_##_cipher_##_##_dir_, ecb);     \
+}                                                                               \
+                                                                                \
 const struct ccmode_##_mode_ *cc##_cipher_##_##_mode_##_##_dir_##_mode(void)    \
 {                                                                               \
-    if (!CC_CACHE_DESCRIPTORS || NULL == _mode_##_##_cipher_##_##_dir_.init) {   \
-        const struct ccmode_ecb *ecb=cc##_cipher_##_ecb_encrypt_mode();         \
-        ccmode_factory_##_mode_##_##_dir_(&_mode_##_##_cipher_##_##_dir_, ecb); \
-    }                                                                           \
+    CC_DESCRIPTOR_ONCE(_mode_##_##_cipher_##_##_dir_##_init);                   \
     return &_mode_##_##_cipher_##_##_dir_;                                      \
 }
 
@@ -486,6 +507,8 @@ struct _ccmode_gcm_key {
 
 void ccmode_gcm_gf_mult(const unsigned char *a, const unsigned char *b, unsigned char *c);
 void ccmode_gcm_mult_h(ccgcm_ctx *key, unsigned char *I);
+void ccmode_gcm_ghash(ccgcm_ctx *key, size_t nblocks, const void *in);
+void ccmode_gcm_mult_h_lanes(ccgcm_ctx *key, size_t nlanes, unsigned char *const *X);
 
 void ccmode_gcm_gf_mult_table(const unsigned char *a, const unsigned char *b, unsigned char *c);
 void ccmode_gcm_gf_mult_compute(const unsigned char *a, const unsigned char *b, unsigned char *c);
@@ -625,6 +648,51 @@ CC_INLINE void ccmode_gcm_update_pad(ccgcm_ctx *key)
                                  CCMODE_GCM_KEY_PAD(key));
 }
 
+/* cc_xor() eight bytes at a time, for bulk keystream. */
+CC_INLINE void ccmode_xor_wide(size_t nbytes, uint8_t *out, const uint8_t *in, const uint8_t *ks)
+{
+    uint64_t a, b;
+
+    for (; nbytes >= sizeof(a); nbytes -= sizeof(a)) {
+        cc_memcpy(&a, in, sizeof(a));
+        cc_memcpy(&b, ks, sizeof(b));
+        a ^= b;
+        cc_memcpy(out, &a, sizeof(a));
+        in += sizeof(a);
+        ks += sizeof(b);
+        out += sizeof(a);
+    }
+    cc_xor(nbytes, out, in, ks);
+}
+
+/* Number of blocks encrypted and hashed together by ccmode_gcm_encrypt/decrypt. */
+#define CCMODE_GCM_NBLOCKS 16
+
+/* Compute the keystream for the next nblocks blocks with a single ECB call.
+   The first keystream block is the current pad. On return, Y and the pad are
+   left as nblocks calls to ccmode_gcm_update_pad() would leave them.
+   ks must have room for nblocks + 1 blocks. */
+CC_INLINE void ccmode_gcm_update_pad_nblocks(ccgcm_ctx *key, size_t nblocks, uint8_t *ks)
+{
+    uint8_t *Y = CCMODE_GCM_KEY_Y(key);
+    uint8_t *pad = CCMODE_GCM_KEY_PAD(key);
+    uint32_t ctr;
+
+    // Same as nblocks calls to inc_uint(Y + 12, 4)
+    CC_LOAD32_BE(ctr, Y + 12);
+    cc_memcpy(ks, pad, CCGCM_BLOCK_NBYTES);
+    for (size_t i = 1; i <= nblocks; i++) {
+        uint8_t *block = ks + i * CCGCM_BLOCK_NBYTES;
+        cc_memcpy(block, Y, 12);
+        CC_STORE32_BE(++ctr, block + 12);
+    }
+    CC_STORE32_BE(ctr, Y + 12);
+    CCMODE_GCM_KEY_ECB(key)->ecb(CCMODE_GCM_KEY_ECB_KEY(key), nblocks,
+                                 ks + CCGCM_BLOCK_NBYTES,
+                                 ks + CCGCM_BLOCK_NBYTES);
+    cc_memcpy(pad, ks + nblocks * CCGCM_BLOCK_NBYTES, CCGCM_BLOCK_NBYTES);
+}
+
 CC_INLINE void ccmode_gcm_aad_finalize(ccgcm_ctx *key)
 {
     if (_CCMODE_GCM_KEY(key)->state == CCMODE_GCM_STATE_AAD) {
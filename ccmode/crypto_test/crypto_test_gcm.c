@@ -14,6 +14,7 @@
 #include <corecrypto/ccn.h>
 
 #include "ccmode_internal.h"
+#include "ccmode_gcm_tables.h"
 #include "crypto_test_modes.h"
 #include "testbyteBuffer.h"
 #include "testmore.h"
@@ -350,9 +351,284 @@ gcm_test_gf_mult(void)
 
     ok_memcmp_or_fail(outA, outB, sizeof(outA), "ccmode_gcm_gf_mult_table and ccmode_gcm_gf_mult_compute computed different results");
 
+#if !CCMODE_GCM_VNG_SPEEDUP
+    struct _ccmode_gcm_htable Htable;
+    ccmode_gcm_init_htable(&Htable, keyB);
+    ccmode_gcm_gmult_htable(stateB, &Htable);
+
+    ok_memcmp_or_fail(stateB, outB, sizeof(outB), "ccmode_gcm_gmult_htable and ccmode_gcm_gf_mult_compute computed different results");
+#endif
+
     return 1;
 }
 
+/* Split buf into fragments whose sizes cycle through sizes[], which may
+ include zero-length fragments. Returns the number of fragments used. */
+static size_t gcm_test_iov_split(const uint8_t *buf, size_t nbytes, size_t nsizes, const size_t *sizes,
+                                 size_t max_niov, struct cc_const_iovec *iov)
+{
+    size_t niov = 0;
+
+    for (size_t k = 0; nbytes > 0 && niov < max_niov - 1; k++) {
+        size_t n = CC_MIN(sizes[k % nsizes], nbytes);
+        iov[niov].base = buf;
+        iov[niov].nbytes = n;
+        buf += n;
+        nbytes -= n;
+        niov++;
+    }
+
+    iov[niov].base = buf;
+    iov[niov].nbytes = nbytes;
+    return niov + 1;
+}
+
+/* Same split, for an output buffer. */
+static size_t gcm_test_iov_split_out(uint8_t *buf, size_t nbytes, size_t nsizes, const size_t *sizes,
+                                     size_t max_niov, struct cc_iovec *iov)
+{
+    struct cc_const_iovec split[64];
+    size_t niov = gcm_test_iov_split(buf, nbytes, nsizes, sizes, CC_MIN(max_niov, CC_ARRAY_LEN(split)), split);
+
+    for (size_t i = 0; i < niov; i++) {
+        iov[i].base = buf + ((const uint8_t *)split[i].base - buf);
+        iov[i].nbytes = split[i].nbytes;
+    }
+    return niov;
+}
+
+static int gcm_test_iov(const struct ccmode_gcm *encrypt_ciphermode, const struct ccmode_gcm *decrypt_ciphermode)
+{
+    static const size_t in_sizes[] = { 1, 0, 7, 16, 33, 5, 64, 200 };
+    static const size_t out_sizes[] = { 13, 48, 0, 3, 129 };
+    static const size_t aad_sizes[] = { 0, 5, 11 };
+    static const size_t lengths[] = { 0, 15, 517 };
+
+    uint8_t key[CCAES_KEY_SIZE_128], iv[CCGCM_IV_NBYTES], aad[40];
+    uint8_t pt[517], ct[517], ct_iov[517], pt_iov[517];
+    uint8_t tag[CCGCM_BLOCK_NBYTES], tag_iov[CCGCM_BLOCK_NBYTES];
+    struct cc_const_iovec aad_iov[8], in_iov[64];
+    struct cc_iovec out_iov[64];
+    size_t aad_niov, in_niov, out_niov;
+    int rc;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0x11 * i);
+    for (size_t i = 0; i < sizeof(iv); i++) iv[i] = (uint8_t)(0xa5 ^ i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(3 * i + 1);
+    for (size_t i = 0; i < sizeof(pt); i++) pt[i] = (uint8_t)(7 * i);
+
+    ccgcm_ctx_decl(ccgcm_context_size(encrypt_ciphermode), encrypt_ctx);
+    ccgcm_ctx_decl(ccgcm_context_size(decrypt_ciphermode), decrypt_ctx);
+
+    aad_niov = gcm_test_iov_split(aad, sizeof(aad), CC_ARRAY_LEN(aad_sizes), aad_sizes, CC_ARRAY_LEN(aad_iov), aad_iov);
+
+    for (size_t l = 0; l < CC_ARRAY_LEN(lengths); l++) {
+        size_t nbytes = lengths[l];
+
+        rc = ccgcm_one_shot(encrypt_ciphermode, sizeof(key), key, sizeof(iv), iv, sizeof(aad), aad, nbytes, pt, ct, sizeof(tag), tag);
+        ok_or_fail(rc == 0, "gcm one-shot encryption failed");
+
+        in_niov = gcm_test_iov_split(pt, nbytes, CC_ARRAY_LEN(in_sizes), in_sizes, CC_ARRAY_LEN(in_iov), in_iov);
+        out_niov = gcm_test_iov_split_out(ct_iov, nbytes, CC_ARRAY_LEN(out_sizes), out_sizes, CC_ARRAY_LEN(out_iov), out_iov);
+        ccgcm_init_with_iv(encrypt_ciphermode, encrypt_ctx, sizeof(key), key, iv);
+        rc = ccgcm_encrypt_iov(encrypt_ciphermode, encrypt_ctx, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, sizeof(tag_iov), tag_iov);
+        ok_or_fail(rc == 0, "gcm iov encryption failed");
+        ok_memcmp_or_fail(ct, ct_iov, nbytes, "gcm iov encryption text mismatch");
+        ok_memcmp_or_fail(tag, tag_iov, sizeof(tag), "gcm iov encryption tag mismatch");
+
+        in_niov = gcm_test_iov_split(ct, nbytes, CC_ARRAY_LEN(out_sizes), out_sizes, CC_ARRAY_LEN(in_iov), in_iov);
+        out_niov = gcm_test_iov_split_out(pt_iov, nbytes, CC_ARRAY_LEN(in_sizes), in_sizes, CC_ARRAY_LEN(out_iov), out_iov);
+        ccgcm_init_with_iv(decrypt_ciphermode, decrypt_ctx, sizeof(key), key, iv);
+        rc = ccgcm_decrypt_iov(decrypt_ciphermode, decrypt_ctx, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, sizeof(tag), tag);
+        ok_or_fail(rc == 0, "gcm iov decryption failed");
+        ok_memcmp_or_fail(pt, pt_iov, nbytes, "gcm iov decryption text mismatch");
+    }
+
+    tag[0] ^= 1;
+    ccgcm_init_with_iv(decrypt_ciphermode, decrypt_ctx, sizeof(key), key, iv);
+    rc = ccgcm_decrypt_iov(decrypt_ciphermode, decrypt_ctx, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, sizeof(tag), tag);
+    ok_or_fail(rc != 0, "gcm iov decryption accepted a bad tag");
+
+    in_iov[0].nbytes -= 1;
+    ccgcm_init_with_iv(encrypt_ciphermode, encrypt_ctx, sizeof(key), key, iv);
+    rc = ccgcm_encrypt_iov(encrypt_ciphermode, encrypt_ctx, aad_niov, aad_iov, in_niov, in_iov, out_niov, out_iov, sizeof(tag_iov), tag_iov);
+    ok_or_fail(rc == CCERR_PARAMETER, "gcm iov encryption accepted mismatched lengths");
+
+    ccgcm_ctx_clear(ccgcm_context_size(encrypt_ciphermode), encrypt_ctx);
+    ccgcm_ctx_clear(ccgcm_context_size(decrypt_ciphermode), decrypt_ctx);
+    return 1;
+}
+
+static int gcm_test_batch(const struct ccmode_gcm *encrypt_ciphermode, const struct ccmode_gcm *decrypt_ciphermode)
+{
+    // The first eleven records share an ECB call and take two rounds of
+    // interleaved GHASH; the last one is too long to share an ECB call.
+    static const size_t lengths[] = { 0, 1, 16, 64, 100, 3, 17, 31, 48, 5, 1500, 2100 };
+    enum { nrecords = CC_ARRAY_LEN(lengths), max_nbytes = 2100 };
+
+    static const uint8_t zero[max_nbytes];
+    uint8_t key[CCAES_KEY_SIZE_128], aad[40];
+    uint8_t iv[nrecords][CCGCM_IV_NBYTES];
+    uint8_t pt[max_nbytes], ct[nrecords][max_nbytes], ct_batch[nrecords][max_nbytes], pt_batch[nrecords][max_nbytes];
+    uint8_t tag[nrecords][CCGCM_BLOCK_NBYTES], tag_batch[nrecords][CCGCM_BLOCK_NBYTES];
+    struct ccgcm_record records[nrecords];
+    int results[nrecords];
+    int rc;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0x3b * i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(5 * i + 2);
+    for (size_t i = 0; i < sizeof(pt); i++) pt[i] = (uint8_t)(11 * i);
+
+    ccgcm_ctx_decl(ccgcm_context_size(encrypt_ciphermode), encrypt_ctx);
+    ccgcm_ctx_decl(ccgcm_context_size(decrypt_ciphermode), decrypt_ctx);
+
+    for (size_t i = 0; i < nrecords; i++) {
+        cc_memset(iv[i], (int)i, CCGCM_IV_NBYTES);
+        rc = ccgcm_one_shot(encrypt_ciphermode, sizeof(key), key, CCGCM_IV_NBYTES, iv[i], i * 3, aad, lengths[i], pt, ct[i], CCGCM_BLOCK_NBYTES, tag[i]);
+        ok_or_fail(rc == 0, "gcm one-shot encryption failed for record %zu", i);
+        records[i] = (struct ccgcm_record){ iv[i], i * 3, aad, lengths[i], pt, ct_batch[i], tag_batch[i] };
+    }
+
+    ccgcm_init(encrypt_ciphermode, encrypt_ctx, sizeof(key), key);
+    rc = ccgcm_seal_batch(encrypt_ciphermode, encrypt_ctx, nrecords, records, CCGCM_BLOCK_NBYTES);
+    ok_or_fail(rc == 0, "gcm batch seal failed");
+    for (size_t i = 0; i < nrecords; i++) {
+        ok_memcmp_or_fail(ct[i], ct_batch[i], lengths[i], "gcm batch seal text mismatch for record %zu", i);
+        ok_memcmp_or_fail(tag[i], tag_batch[i], CCGCM_BLOCK_NBYTES, "gcm batch seal tag mismatch for record %zu", i);
+    }
+
+    // Open in place, with a bad tag on the fifth record.
+    for (size_t i = 0; i < nrecords; i++) {
+        cc_memcpy(pt_batch[i], ct[i], lengths[i]);
+        records[i] = (struct ccgcm_record){ iv[i], i * 3, aad, lengths[i], pt_batch[i], pt_batch[i], tag[i] };
+    }
+    tag[4][0] ^= 1;
+
+    ccgcm_init(decrypt_ciphermode, decrypt_ctx, sizeof(key), key);
+    rc = ccgcm_open_batch(decrypt_ciphermode, decrypt_ctx, nrecords, records, CCGCM_BLOCK_NBYTES, results);
+    ok_or_fail(rc == CCMODE_INTEGRITY_FAILURE, "gcm batch open accepted a bad tag");
+    for (size_t i = 0; i < nrecords; i++) {
+        if (i == 4) {
+            ok_or_fail(results[i] == CCMODE_INTEGRITY_FAILURE, "gcm batch open accepted a bad tag for record %zu", i);
+            ok_memcmp_or_fail(zero, pt_batch[i], lengths[i], "gcm batch open did not clear record %zu", i);
+        } else {
+            ok_or_fail(results[i] == 0, "gcm batch open failed for record %zu", i);
+            ok_memcmp_or_fail(pt, pt_batch[i], lengths[i], "gcm batch open text mismatch for record %zu", i);
+        }
+    }
+
+    // A batch rejected as a whole still sets every result.
+    for (size_t i = 0; i < nrecords; i++) {
+        results[i] = 1;
+    }
+    ccgcm_init(decrypt_ciphermode, decrypt_ctx, sizeof(key), key);
+    rc = ccgcm_open_batch(decrypt_ciphermode, decrypt_ctx, nrecords, records, 0, results);
+    ok_or_fail(rc == CCERR_PARAMETER, "gcm batch open accepted an empty tag");
+    for (size_t i = 0; i < nrecords; i++) {
+        ok_or_fail(results[i] == CCERR_PARAMETER, "gcm batch open did not set the result of record %zu", i);
+    }
+
+    ccgcm_ctx_clear(ccgcm_context_size(encrypt_ciphermode), encrypt_ctx);
+    ccgcm_ctx_clear(ccgcm_context_size(decrypt_ciphermode), decrypt_ctx);
+    return 1;
+}
+
+static int gcm_test_aad_snapshot(const struct ccmode_gcm *encrypt_ciphermode)
+{
+    // Prefixes ending inside and on a block boundary.
+    static const size_t prefix_lengths[] = { 5, 16, 21 };
+
+    uint8_t key[CCAES_KEY_SIZE_128], iv[CCGCM_IV_NBYTES], aad[40], pt[50];
+    uint8_t ct[sizeof(pt)], ct_snap[sizeof(pt)];
+    uint8_t tag[CCGCM_BLOCK_NBYTES], tag_snap[CCGCM_BLOCK_NBYTES];
+    struct ccgcm_aad_snapshot snapshot;
+    int rc;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0x5d * i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(9 * i + 4);
+    for (size_t i = 0; i < sizeof(pt); i++) pt[i] = (uint8_t)(13 * i);
+    cc_memset(iv, 0x42, sizeof(iv));
+
+    ccgcm_ctx_decl(ccgcm_context_size(encrypt_ciphermode), ctx);
+
+    for (size_t l = 0; l < CC_ARRAY_LEN(prefix_lengths); l++) {
+        size_t prefix_nbytes = prefix_lengths[l];
+
+        ccgcm_init_with_iv(encrypt_ciphermode, ctx, sizeof(key), key, iv);
+        ccgcm_aad(encrypt_ciphermode, ctx, prefix_nbytes, aad);
+        rc = ccgcm_aad_save(encrypt_ciphermode, ctx, &snapshot);
+        ok_or_fail(rc == 0, "gcm aad snapshot save failed");
+
+        // The second record under the context resumes from the snapshot.
+        ccgcm_reset(encrypt_ciphermode, ctx);
+        ccgcm_inc_iv(encrypt_ciphermode, ctx, iv);
+        rc = ccgcm_aad_restore(encrypt_ciphermode, ctx, &snapshot);
+        ok_or_fail(rc == 0, "gcm aad snapshot restore failed");
+        ccgcm_aad(encrypt_ciphermode, ctx, sizeof(aad) - prefix_nbytes, aad + prefix_nbytes);
+        ccgcm_update(encrypt_ciphermode, ctx, sizeof(pt), pt, ct_snap);
+        ccgcm_finalize(encrypt_ciphermode, ctx, sizeof(tag_snap), tag_snap);
+
+        rc = ccgcm_one_shot(encrypt_ciphermode, sizeof(key), key, sizeof(iv), iv, sizeof(aad), aad, sizeof(pt), pt, ct, sizeof(tag), tag);
+        ok_or_fail(rc == 0, "gcm one-shot encryption failed");
+        ok_memcmp_or_fail(ct, ct_snap, sizeof(ct), "gcm aad snapshot text mismatch");
+        ok_memcmp_or_fail(tag, tag_snap, sizeof(tag), "gcm aad snapshot tag mismatch");
+    }
+
+    // Restoring on top of additional data would drop it.
+    ccgcm_reset(encrypt_ciphermode, ctx);
+    ccgcm_inc_iv(encrypt_ciphermode, ctx, iv);
+    ccgcm_aad(encrypt_ciphermode, ctx, 1, aad);
+    rc = ccgcm_aad_restore(encrypt_ciphermode, ctx, &snapshot);
+    ok_or_fail(rc == CCMODE_INVALID_CALL_SEQUENCE, "gcm aad snapshot restored after additional data");
+
+    // The snapshot reveals H; clear it like the context.
+    cc_clear(sizeof(snapshot), &snapshot);
+    ccgcm_ctx_clear(ccgcm_context_size(encrypt_ciphermode), ctx);
+    return 1;
+}
+
+static int gcm_test_one_shot_parallel(const struct ccmode_gcm *encrypt_ciphermode, const struct ccmode_gcm *decrypt_ciphermode)
+{
+    // Long enough to be split in three chunks, the last one with a partial block.
+    const size_t nbytes = 3 * 1024 * 1024 + 7;
+    // A 16-byte IV, so that J0 is derived with GHASH.
+    uint8_t key[CCAES_KEY_SIZE_256], iv[16], aad[13];
+    uint8_t tag[CCGCM_BLOCK_NBYTES], tag_parallel[CCGCM_BLOCK_NBYTES];
+    uint8_t *pt = malloc(nbytes), *ct = malloc(nbytes), *out = malloc(nbytes);
+    int rc, result = 0;
+
+    cc_require(pt != NULL && ct != NULL && out != NULL, errOut);
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (uint8_t)(0x17 * i);
+    for (size_t i = 0; i < sizeof(aad); i++) aad[i] = (uint8_t)(3 * i);
+    for (size_t i = 0; i < nbytes; i++) pt[i] = (uint8_t)(i ^ (i >> 11));
+    cc_memset(iv, 0x99, sizeof(iv));
+
+    rc = ccgcm_one_shot(encrypt_ciphermode, sizeof(key), key, sizeof(iv), iv, sizeof(aad), aad, nbytes, pt, ct, sizeof(tag), tag);
+    cc_require(rc == 0, errOut);
+
+    rc = ccgcm_one_shot_parallel(encrypt_ciphermode, sizeof(key), key, sizeof(iv), iv, sizeof(aad), aad, nbytes, pt, out, sizeof(tag_parallel), tag_parallel, 4);
+    ok_or_goto(rc == 0, "gcm parallel encryption failed", errOut);
+    ok_memcmp_or_goto(ct, out, nbytes, errOut, "gcm parallel encryption text mismatch");
+    ok_memcmp_or_goto(tag, tag_parallel, sizeof(tag), errOut, "gcm parallel encryption tag mismatch");
+
+    rc = ccgcm_one_shot_parallel(decrypt_ciphermode, sizeof(key), key, sizeof(iv), iv, sizeof(aad), aad, nbytes, ct, out, sizeof(tag_parallel), tag_parallel, 4);
+    ok_or_goto(rc == 0, "gcm parallel decryption failed", errOut);
+    ok_memcmp_or_goto(pt, out, nbytes, errOut, "gcm parallel decryption text mismatch");
+
+    ct[nbytes / 2] ^= 1;
+    rc = ccgcm_one_shot_parallel(decrypt_ciphermode, sizeof(key), key, sizeof(iv), iv, sizeof(aad), aad, nbytes, ct, out, sizeof(tag), tag, 4);
+    ok_or_goto(rc == CCMODE_INTEGRITY_FAILURE, "gcm parallel decryption accepted a modified ciphertext", errOut);
+
+    result = 1;
+
+errOut:
+    free(pt);
+    free(ct);
+    free(out);
+    return result;
+}
+
 int test_gcm(const struct ccmode_gcm *encrypt_ciphermode, const struct ccmode_gcm *decrypt_ciphermode)
 {
 
@@ -363,6 +639,10 @@ int test_gcm(const struct ccmode_gcm *encrypt_ciphermode, const struct ccmode_gc
     gcm_test_zerolen_iv(encrypt_ciphermode, decrypt_ciphermode);
     gcm_test_init_with_iv(encrypt_ciphermode, decrypt_ciphermode);
     gcm_test_counter_wrap(encrypt_ciphermode, decrypt_ciphermode);
+    gcm_test_iov(encrypt_ciphermode, decrypt_ciphermode);
+    gcm_test_batch(encrypt_ciphermode, decrypt_ciphermode);
+    gcm_test_aad_snapshot(encrypt_ciphermode);
+    gcm_test_one_shot_parallel(encrypt_ciphermode, decrypt_ciphermode);
 
     return gcm_test_gf_mult();
 }
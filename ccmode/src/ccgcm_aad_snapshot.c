@@ -0,0 +1,44 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include "ccmode_internal.h"
+
+int ccgcm_aad_save(CC_UNUSED const struct ccmode_gcm *mode, const ccgcm_ctx *ctx, struct ccgcm_aad_snapshot *snapshot)
+{
+    const struct _ccmode_gcm_key *key = (const struct _ccmode_gcm_key *)ctx;
+
+    cc_require(key->state == CCMODE_GCM_STATE_AAD, errOut);
+
+    cc_memcpy(snapshot->ghash, key->X, sizeof(snapshot->ghash));
+    snapshot->aad_nbytes = key->aad_nbytes;
+
+    return 0;
+
+errOut:
+    return CCMODE_INVALID_CALL_SEQUENCE;
+}
+
+int ccgcm_aad_restore(CC_UNUSED const struct ccmode_gcm *mode, ccgcm_ctx *ctx, const struct ccgcm_aad_snapshot *snapshot)
+{
+    // X only holds the additional data at this point; the IV is absorbed
+    // into the counter, so the prefix state can be dropped in as is.
+    cc_require(_CCMODE_GCM_KEY(ctx)->state == CCMODE_GCM_STATE_AAD, errOut);
+    cc_require(_CCMODE_GCM_KEY(ctx)->aad_nbytes == 0, errOut);
+
+    cc_memcpy(CCMODE_GCM_KEY_X(ctx), snapshot->ghash, sizeof(snapshot->ghash));
+    _CCMODE_GCM_KEY(ctx)->aad_nbytes = snapshot->aad_nbytes;
+
+    return 0;
+
+errOut:
+    return CCMODE_INVALID_CALL_SEQUENCE;
+}
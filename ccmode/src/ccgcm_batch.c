@@ -0,0 +1,268 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include "ccmode_internal.h"
+
+/* Number of counter blocks encrypted with a single ECB call. A group of
+ short records contributes, for each record, the block E(J0) that masks
+ the tag followed by the keystream of its text. */
+#define CCGCM_BATCH_NBLOCKS 128
+
+static size_t ccgcm_batch_nblocks(const struct ccgcm_record *r)
+{
+    return 1 + (r->nbytes + CCGCM_BLOCK_NBYTES - 1) / CCGCM_BLOCK_NBYTES;
+}
+
+/* Write the nblocks counter blocks J0, J0 + 1, ... of a 96-bit IV. */
+static void ccgcm_batch_counters(const void *iv, size_t nblocks, uint8_t *ctr)
+{
+    for (size_t i = 0; i < nblocks; i++) {
+        cc_memcpy(ctr, iv, CCGCM_IV_NBYTES);
+        CC_STORE32_BE((uint32_t)i + 1, ctr + CCGCM_IV_NBYTES);
+        ctr += CCGCM_BLOCK_NBYTES;
+    }
+}
+
+/* Number of records whose GHASH accumulators advance together. */
+#define CCGCM_BATCH_NLANES 8
+
+/* Position of one record in its GHASH input: the padded AAD, the padded
+ ciphertext and the lengths block. */
+struct ccgcm_batch_lane {
+    const uint8_t *aad;
+    size_t aad_nbytes;
+    const uint8_t *text;
+    size_t text_nbytes;
+    bool lengths_done;
+    uint8_t lengths[CCGCM_BLOCK_NBYTES];
+};
+
+static void ccgcm_batch_lane_init(struct ccgcm_batch_lane *lane, const struct ccgcm_record *r, bool encrypt)
+{
+    lane->aad = r->aad;
+    lane->aad_nbytes = r->aad_nbytes;
+    lane->text = encrypt ? r->out : r->in;
+    lane->text_nbytes = r->nbytes;
+    lane->lengths_done = false;
+    CC_STORE64_BE((uint64_t)r->aad_nbytes * 8, lane->lengths);
+    CC_STORE64_BE((uint64_t)r->nbytes * 8, lane->lengths + 8);
+}
+
+/* Fold the next block of the lane into X. Returns false once the lengths
+ block has been consumed. */
+static bool ccgcm_batch_lane_next(struct ccgcm_batch_lane *lane, uint8_t *X)
+{
+    size_t n;
+
+    if (lane->aad_nbytes > 0) {
+        n = CC_MIN(lane->aad_nbytes, CCGCM_BLOCK_NBYTES);
+        cc_xor(n, X, X, lane->aad);
+        lane->aad += n;
+        lane->aad_nbytes -= n;
+    } else if (lane->text_nbytes > 0) {
+        n = CC_MIN(lane->text_nbytes, CCGCM_BLOCK_NBYTES);
+        cc_xor(n, X, X, lane->text);
+        lane->text += n;
+        lane->text_nbytes -= n;
+    } else if (!lane->lengths_done) {
+        cc_xor(CCGCM_BLOCK_NBYTES, X, X, lane->lengths);
+        lane->lengths_done = true;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/* Seal or open up to CCGCM_BATCH_NLANES records given ks, the encrypted
+ counter blocks from ccgcm_batch_counters(). The GHASH accumulators of the
+ records advance one block per step, so that the multiplications by H of
+ different records are independent and can overlap. Every ciphertext is
+ hashed before anything is written, so that a record failing
+ authentication is never decrypted. */
+static int ccgcm_batch_records(ccgcm_ctx *ctx, size_t nrecords, const struct ccgcm_record *records,
+                               size_t tag_nbytes, const uint8_t *ks, bool encrypt, int *results)
+{
+    struct ccgcm_batch_lane lanes[CCGCM_BATCH_NLANES];
+    uint8_t X[CCGCM_BATCH_NLANES][CCGCM_BLOCK_NBYTES];
+    uint8_t *active[CCGCM_BATCH_NLANES];
+    const uint8_t *ks_record[CCGCM_BATCH_NLANES];
+    uint8_t block[CCGCM_BLOCK_NBYTES];
+    size_t nactive;
+    int rc = 0;
+
+    cc_clear(sizeof(X), X);
+
+    for (size_t j = 0; j < nrecords; j++) {
+        const struct ccgcm_record *r = &records[j];
+
+        ks_record[j] = ks;
+        if (encrypt && r->nbytes > 0) {
+            ccmode_xor_wide(r->nbytes, r->out, r->in, ks + CCGCM_BLOCK_NBYTES);
+        }
+        ccgcm_batch_lane_init(&lanes[j], r, encrypt);
+        ks += ccgcm_batch_nblocks(r) * CCGCM_BLOCK_NBYTES;
+    }
+
+    do {
+        nactive = 0;
+        for (size_t j = 0; j < nrecords; j++) {
+            if (ccgcm_batch_lane_next(&lanes[j], X[j])) {
+                active[nactive++] = X[j];
+            }
+        }
+        ccmode_gcm_mult_h_lanes(ctx, nactive, active);
+    } while (nactive > 0);
+
+    for (size_t j = 0; j < nrecords; j++) {
+        const struct ccgcm_record *r = &records[j];
+        int rc_record = 0;
+
+        cc_xor(CCGCM_BLOCK_NBYTES, block, X[j], ks_record[j]);
+
+        if (encrypt) {
+            cc_memcpy(r->tag, block, tag_nbytes);
+        } else if (cc_cmp_safe(tag_nbytes, block, r->tag) != 0) {
+            rc_record = CCMODE_INTEGRITY_FAILURE;
+            if (r->nbytes > 0) {
+                cc_clear(r->nbytes, r->out);
+            }
+        } else if (r->nbytes > 0) {
+            ccmode_xor_wide(r->nbytes, r->out, r->in, ks_record[j] + CCGCM_BLOCK_NBYTES);
+        }
+
+        if (results) {
+            results[j] = rc_record;
+        }
+        rc = rc ? rc : rc_record;
+    }
+
+    cc_clear(sizeof(X), X);
+    cc_clear(sizeof(block), block);
+    return rc;
+}
+
+/* Records too long to share an ECB call go through the regular API. */
+static int ccgcm_batch_record_long(const struct ccmode_gcm *mode, ccgcm_ctx *ctx,
+                                   const struct ccgcm_record *r, size_t tag_nbytes)
+{
+    uint8_t tag[CCGCM_BLOCK_NBYTES];
+    int rc;
+
+    if (mode->encdec == CCMODE_GCM_DECRYPTOR) {
+        cc_memcpy(tag, r->tag, tag_nbytes);
+    }
+
+    rc = ccgcm_reset(mode, ctx);
+    cc_require(rc == 0, errOut);
+    rc = ccgcm_set_iv(mode, ctx, CCGCM_IV_NBYTES, r->iv);
+    cc_require(rc == 0, errOut);
+    rc = ccgcm_aad(mode, ctx, r->aad_nbytes, r->aad);
+    cc_require(rc == 0, errOut);
+    rc = ccgcm_update(mode, ctx, r->nbytes, r->in, r->out);
+    cc_require(rc == 0, errOut);
+
+    if (mode->encdec == CCMODE_GCM_ENCRYPTOR) {
+        rc = ccgcm_finalize(mode, ctx, tag_nbytes, r->tag);
+    } else {
+        rc = ccgcm_finalize(mode, ctx, tag_nbytes, tag);
+    }
+
+errOut:
+    if (rc != 0 && r->nbytes > 0) {
+        cc_clear(r->nbytes, r->out);
+    }
+    cc_clear(sizeof(tag), tag);
+    return rc;
+}
+
+static int ccgcm_batch(const struct ccmode_gcm *mode, ccgcm_ctx *ctx, int encdec,
+                       size_t nrecords, const struct ccgcm_record *records,
+                       size_t tag_nbytes, int *results)
+{
+    const struct ccmode_ecb *ecb = CCMODE_GCM_KEY_ECB(ctx);
+    bool encrypt = encdec == CCMODE_GCM_ENCRYPTOR;
+    uint8_t ks[CCGCM_BATCH_NBLOCKS * CCGCM_BLOCK_NBYTES];
+    size_t i = 0;
+    int rc = 0;
+
+    cc_require_action(mode->encdec == encdec, errOut, rc = CCERR_PARAMETER);
+    cc_require_action(tag_nbytes > 0 && tag_nbytes <= CCGCM_BLOCK_NBYTES, errOut, rc = CCERR_PARAMETER);
+
+    // The IVs come from the records, which a context initialized with
+    // ccgcm_init_with_iv() does not allow.
+    cc_require_action(_CCMODE_GCM_KEY(ctx)->state == CCMODE_GCM_STATE_IV &&
+                      (_CCMODE_GCM_KEY(ctx)->flags & CCGCM_FLAGS_INIT_WITH_IV) == 0,
+                      errOut, rc = CCMODE_INVALID_CALL_SEQUENCE);
+
+    for (i = 0; i < nrecords;) {
+        size_t first = i, nblocks = 0;
+        int rc_record;
+
+        if (ccgcm_batch_nblocks(&records[i]) > CCGCM_BATCH_NBLOCKS) {
+            rc_record = ccgcm_batch_record_long(mode, ctx, &records[i], tag_nbytes);
+            cc_require_action(rc_record == 0 || rc_record == CCMODE_INTEGRITY_FAILURE, errOut, rc = rc_record);
+            if (results) {
+                results[i] = rc_record;
+            }
+            rc = rc ? rc : rc_record;
+            i++;
+            continue;
+        }
+
+        // Gather as many short records as fit and encrypt all their
+        // counter blocks at once.
+        while (i < nrecords && nblocks + ccgcm_batch_nblocks(&records[i]) <= CCGCM_BATCH_NBLOCKS) {
+            ccgcm_batch_counters(records[i].iv, ccgcm_batch_nblocks(&records[i]), ks + nblocks * CCGCM_BLOCK_NBYTES);
+            nblocks += ccgcm_batch_nblocks(&records[i]);
+            i++;
+        }
+
+        ecb->ecb(CCMODE_GCM_KEY_ECB_KEY(ctx), nblocks, ks, ks);
+
+        nblocks = 0;
+        for (size_t j = first; j < i; j += CCGCM_BATCH_NLANES) {
+            size_t n = CC_MIN(i - j, CCGCM_BATCH_NLANES);
+
+            rc_record = ccgcm_batch_records(ctx, n, &records[j], tag_nbytes, ks + nblocks * CCGCM_BLOCK_NBYTES,
+                                            encrypt, results ? &results[j] : NULL);
+            rc = rc ? rc : rc_record;
+            for (size_t k = j; k < j + n; k++) {
+                nblocks += ccgcm_batch_nblocks(&records[k]);
+            }
+        }
+    }
+
+errOut:
+    // Records not processed because of an error that is not an
+    // authentication failure report that error.
+    for (size_t j = i; results && j < nrecords; j++) {
+        results[j] = rc;
+    }
+    cc_clear(sizeof(ks), ks);
+    ccgcm_reset(mode, ctx);
+    return rc;
+}
+
+int ccgcm_seal_batch(const struct ccmode_gcm *mode, ccgcm_ctx *ctx,
+                     size_t nrecords, const struct ccgcm_record *records,
+                     size_t tag_nbytes)
+{
+    return ccgcm_batch(mode, ctx, CCMODE_GCM_ENCRYPTOR, nrecords, records, tag_nbytes, NULL);
+}
+
+int ccgcm_open_batch(const struct ccmode_gcm *mode, ccgcm_ctx *ctx,
+                     size_t nrecords, const struct ccgcm_record *records,
+                     size_t tag_nbytes, int *results)
+{
+    return ccgcm_batch(mode, ctx, CCMODE_GCM_DECRYPTOR, nrecords, records, tag_nbytes, results);
+}
@@ -0,0 +1,82 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include "ccmode_internal.h"
+#include "cc_internal.h"
+
+struct ccgcm_iov_crypt_ctx {
+    const struct ccmode_gcm *mode;
+    ccgcm_ctx *ctx;
+};
+
+/* Partial blocks at fragment boundaries are carried by the GCM context. */
+static int ccgcm_iov_update(void *crypt_ctx, size_t nbytes, const void *in, void *out)
+{
+    struct ccgcm_iov_crypt_ctx *c = crypt_ctx;
+    return ccgcm_update(c->mode, c->ctx, nbytes, in, out);
+}
+
+static int ccgcm_iov_crypt(const struct ccmode_gcm *mode, ccgcm_ctx *ctx,
+                           size_t aad_niov, const struct cc_const_iovec *aad,
+                           size_t in_niov, const struct cc_const_iovec *in,
+                           size_t out_niov, const struct cc_iovec *out,
+                           size_t tag_nbytes, void *tag)
+{
+    struct ccgcm_iov_crypt_ctx crypt_ctx = { .mode = mode, .ctx = ctx };
+    int rc;
+
+    for (size_t i = 0; i < aad_niov; i++) {
+        rc = ccgcm_aad(mode, ctx, aad[i].nbytes, aad[i].base);
+        cc_require(rc == 0, errOut);
+    }
+
+    rc = cc_iovec_crypt(in_niov, in, out_niov, out, ccgcm_iov_update, &crypt_ctx);
+    cc_require(rc == 0, errOut);
+
+    rc = ccgcm_finalize(mode, ctx, tag_nbytes, tag);
+
+errOut:
+    return rc;
+}
+
+int ccgcm_encrypt_iov(const struct ccmode_gcm *mode, ccgcm_ctx *ctx,
+                      size_t aad_niov, const struct cc_const_iovec *aad,
+                      size_t in_niov, const struct cc_const_iovec *in,
+                      size_t out_niov, const struct cc_iovec *out,
+                      size_t tag_nbytes, void *tag)
+{
+    if (mode->encdec != CCMODE_GCM_ENCRYPTOR) {
+        return CCERR_PARAMETER;
+    }
+
+    return ccgcm_iov_crypt(mode, ctx, aad_niov, aad, in_niov, in, out_niov, out, tag_nbytes, tag);
+}
+
+int ccgcm_decrypt_iov(const struct ccmode_gcm *mode, ccgcm_ctx *ctx,
+                      size_t aad_niov, const struct cc_const_iovec *aad,
+                      size_t in_niov, const struct cc_const_iovec *in,
+                      size_t out_niov, const struct cc_iovec *out,
+                      size_t tag_nbytes, const void *tag)
+{
+    uint8_t expected_tag[CCGCM_BLOCK_NBYTES];
+    int rc;
+
+    if (mode->encdec != CCMODE_GCM_DECRYPTOR || tag_nbytes > sizeof(expected_tag)) {
+        return CCERR_PARAMETER;
+    }
+
+    // ccgcm_finalize() overwrites the tag it is given with the computed one.
+    cc_memcpy(expected_tag, tag, tag_nbytes);
+    rc = ccgcm_iov_crypt(mode, ctx, aad_niov, aad, in_niov, in, out_niov, out, tag_nbytes, expected_tag);
+    cc_clear(sizeof(expected_tag), expected_tag);
+
+    return rc;
+}
@@ -0,0 +1,194 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include "ccmode_internal.h"
+
+#if CC_PTHREADS
+#include <pthread.h>
+#endif
+
+/* Below this many bytes per thread, starting the threads costs more than
+ it saves. */
+#define CCGCM_PARALLEL_MIN_NBYTES (1024 * 1024)
+
+#define CCGCM_PARALLEL_MAX_NTHREADS 64
+
+#if CC_PTHREADS
+
+struct ccgcm_parallel_chunk {
+    const struct ccmode_gcm *mode;
+    size_t key_nbytes;
+    const void *key;
+    size_t iv_nbytes;
+    const void *iv;
+    uint32_t offset_nblocks; // counter offset from the first text block
+    size_t nbytes;
+    const uint8_t *in;
+    uint8_t *out;
+    uint8_t X[CCGCM_BLOCK_NBYTES]; // GHASH of the chunk from a zero state
+    int rc;
+};
+
+/* Encrypt or decrypt one chunk on a private context and leave the GHASH
+ of its ciphertext in chunk->X. As in ccmode_gcm_encrypt/decrypt, a
+ trailing partial block is added to X but not yet multiplied by H. */
+static void *ccgcm_parallel_crypt_chunk(void *arg)
+{
+    struct ccgcm_parallel_chunk *chunk = arg;
+    const struct ccmode_gcm *mode = chunk->mode;
+    uint8_t *Y;
+    uint32_t ctr;
+    int rc;
+
+    ccgcm_ctx_decl(mode->size, ctx);
+
+    rc = ccgcm_init(mode, ctx, chunk->key_nbytes, chunk->key);
+    cc_require(rc == 0, errOut);
+    rc = ccgcm_set_iv(mode, ctx, chunk->iv_nbytes, chunk->iv);
+    cc_require(rc == 0, errOut);
+
+    // set_iv() left Y at J0 + 1 with the matching pad. Skip ahead to the
+    // first counter block of this chunk; the 32-bit counter wraps as in
+    // ccmode_gcm_update_pad().
+    Y = CCMODE_GCM_KEY_Y(ctx);
+    CC_LOAD32_BE(ctr, Y + 12);
+    ctr += chunk->offset_nblocks;
+    CC_STORE32_BE(ctr, Y + 12);
+    CCMODE_GCM_KEY_ECB(ctx)->ecb(CCMODE_GCM_KEY_ECB_KEY(ctx), 1, Y, CCMODE_GCM_KEY_PAD(ctx));
+
+    rc = ccgcm_update(mode, ctx, chunk->nbytes, chunk->in, chunk->out);
+    cc_require(rc == 0, errOut);
+
+    cc_memcpy(chunk->X, CCMODE_GCM_KEY_X(ctx), CCGCM_BLOCK_NBYTES);
+
+errOut:
+    ccgcm_ctx_clear(mode->size, ctx);
+    chunk->rc = rc;
+    return NULL;
+}
+
+/* Hn = H^n in GF(2^128), by square-and-multiply. */
+static void ccgcm_parallel_hpow(const uint8_t *H, size_t n, uint8_t *Hn)
+{
+    uint8_t base[CCGCM_BLOCK_NBYTES];
+
+    // The GCM representation of 1.
+    cc_clear(CCGCM_BLOCK_NBYTES, Hn);
+    Hn[0] = 0x80;
+    cc_memcpy(base, H, CCGCM_BLOCK_NBYTES);
+
+    for (; n > 0; n >>= 1) {
+        if (n & 1) {
+            ccmode_gcm_gf_mult(base, Hn, Hn);
+        }
+        ccmode_gcm_gf_mult(base, base, base);
+    }
+
+    cc_clear(sizeof(base), base);
+}
+
+#endif /* CC_PTHREADS */
+
+int ccgcm_one_shot_parallel(const struct ccmode_gcm *mode,
+                            size_t key_nbytes, const void *key,
+                            size_t iv_nbytes, const void *iv,
+                            size_t adata_nbytes, const void *adata,
+                            size_t nbytes, const void *in, void *out,
+                            size_t tag_nbytes, void *tag,
+                            size_t nthreads)
+{
+#if CC_PTHREADS
+    struct ccgcm_parallel_chunk chunks[CCGCM_PARALLEL_MAX_NTHREADS];
+    pthread_t threads[CCGCM_PARALLEL_MAX_NTHREADS];
+    bool started[CCGCM_PARALLEL_MAX_NTHREADS];
+    uint8_t Hn[CCGCM_BLOCK_NBYTES];
+    size_t chunk_nbytes, offset = 0;
+    uint8_t *X;
+    int rc;
+
+    nthreads = CC_MIN(nthreads, CCGCM_PARALLEL_MAX_NTHREADS);
+    nthreads = CC_MIN(nthreads, nbytes / CCGCM_PARALLEL_MIN_NBYTES);
+
+    // Too short to split, or longer than GCM allows: let ccgcm_one_shot()
+    // handle it, including the error.
+    if (nthreads < 2 || nbytes > CCGCM_TEXT_MAX_NBYTES) {
+        return ccgcm_one_shot(mode, key_nbytes, key, iv_nbytes, iv, adata_nbytes, adata, nbytes, in, out, tag_nbytes, tag);
+    }
+
+    ccgcm_ctx_decl(mode->size, ctx);
+    rc = ccgcm_init(mode, ctx, key_nbytes, key);
+    cc_require(rc == 0, errOut);
+    rc = ccgcm_set_iv(mode, ctx, iv_nbytes, iv);
+    cc_require(rc == 0, errOut);
+    rc = ccgcm_aad(mode, ctx, adata_nbytes, adata);
+    cc_require(rc == 0, errOut);
+    ccmode_gcm_aad_finalize(ctx);
+
+    // Whole blocks per chunk; the last one also takes the remainder.
+    chunk_nbytes = (nbytes / nthreads) & ~(size_t)(CCGCM_BLOCK_NBYTES - 1);
+
+    for (size_t i = 0; i < nthreads; i++) {
+        chunks[i] = (struct ccgcm_parallel_chunk){
+            .mode = mode,
+            .key_nbytes = key_nbytes,
+            .key = key,
+            .iv_nbytes = iv_nbytes,
+            .iv = iv,
+            .offset_nblocks = (uint32_t)(offset / CCGCM_BLOCK_NBYTES),
+            .nbytes = (i == nthreads - 1) ? nbytes - offset : chunk_nbytes,
+            .in = (const uint8_t *)in + offset,
+            .out = (uint8_t *)out + offset,
+        };
+        offset += chunk_nbytes;
+    }
+
+    // The calling thread takes the first chunk. Chunks whose thread could
+    // not be started are run here as well.
+    for (size_t i = 1; i < nthreads; i++) {
+        started[i] = pthread_create(&threads[i], NULL, ccgcm_parallel_crypt_chunk, &chunks[i]) == 0;
+    }
+    ccgcm_parallel_crypt_chunk(&chunks[0]);
+    for (size_t i = 1; i < nthreads; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            ccgcm_parallel_crypt_chunk(&chunks[i]);
+        }
+    }
+
+    // X = X * H^n_i + X_i for each chunk of n_i whole blocks. The partial
+    // block of the last chunk is multiplied by ccgcm_finalize().
+    X = CCMODE_GCM_KEY_X(ctx);
+    for (size_t i = 0; i < nthreads; i++) {
+        rc = chunks[i].rc;
+        cc_require(rc == 0, errOut);
+
+        ccgcm_parallel_hpow(CCMODE_GCM_KEY_H(ctx), chunks[i].nbytes / CCGCM_BLOCK_NBYTES, Hn);
+        ccmode_gcm_gf_mult(Hn, X, X);
+        cc_xor(CCGCM_BLOCK_NBYTES, X, X, chunks[i].X);
+    }
+
+    _CCMODE_GCM_KEY(ctx)->text_nbytes = nbytes;
+    rc = ccgcm_finalize(mode, ctx, tag_nbytes, tag);
+
+errOut:
+    for (size_t i = 0; i < nthreads; i++) {
+        cc_clear(CCGCM_BLOCK_NBYTES, chunks[i].X);
+    }
+    cc_clear(sizeof(Hn), Hn);
+    ccgcm_ctx_clear(mode->size, ctx);
+    return rc;
+#else
+    (void)nthreads;
+    return ccgcm_one_shot(mode, key_nbytes, key, iv_nbytes, iv, adata_nbytes, adata, nbytes, in, out, tag_nbytes, tag);
+#endif
+}
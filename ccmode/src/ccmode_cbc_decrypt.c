@@ -14,33 +14,47 @@
 #include <corecrypto/ccn.h>
 #include <corecrypto/cc_priv.h>
 
-/* c -> ecb -> xor iv -> p, iv = c, p += 1, c += 1. */
+/* Number of blocks decrypted with a single ECB call. */
+#define CCMODE_CBC_DECRYPT_NBLOCKS 8
+
+/* c -> ecb -> xor iv -> p, iv = c, p += 1, c += 1.
+   Runs of blocks are decrypted with one ECB call; the ciphertext of the
+   run is saved first (preceded by the chaining value) so that in-place
+   operation still XORs against the original ciphertext. */
 int ccmode_cbc_decrypt(const cccbc_ctx *key, cccbc_iv *iv,
                        size_t nblocks, const void *in, void *out) {
     const struct ccmode_ecb *ecb = ccmode_cbc_key_ecb(key);
     const ccecb_ctx *ecb_key = ccmode_cbc_key_ecb_key(key);
-    if (nblocks) {
-        const unsigned char *ct = in;
-        unsigned char *pt = out;
-        cc_unit tmp[ccn_nof_size(ecb->block_size)];
-        for (;;) {
-            ecb->ecb(ecb_key, 1, ct, tmp);
-            /* We assume block_size % CCN_UNIT_SIZE == 0 which is true
-               for CC_UNIT size up to 64 bits. */
-            for (size_t x = 0; x < ecb->block_size; ++x) {
-                uint8_t tmpy = ((uint8_t *)iv)[x] ^ ((uint8_t *)tmp)[x];
-                ((uint8_t *)iv)[x] = ct[x];
-                pt[x] = tmpy;
-            }
-            
-            if (--nblocks) {
-                pt += ecb->block_size;
-                ct += ecb->block_size;
-            } else {
-                break;
-            }
-        }
+    const size_t block_size = ecb->block_size;
+    const unsigned char *ct = in;
+    unsigned char *pt = out;
+    uint8_t saved[(CCMODE_CBC_DECRYPT_NBLOCKS + 1) * CCMODE_MAX_BLOCK_SIZE];
+
+    cc_assert(block_size <= CCMODE_MAX_BLOCK_SIZE);
+
+    if (nblocks == 0) {
+        return 0;
     }
-    
+
+    cc_memcpy(saved, iv, block_size);
+
+    while (nblocks) {
+        size_t n = CC_MIN(nblocks, CCMODE_CBC_DECRYPT_NBLOCKS);
+
+        cc_memcpy(saved + block_size, ct, n * block_size);
+        ecb->ecb(ecb_key, n, ct, pt);
+        cc_xor(n * block_size, pt, pt, saved);
+
+        // The last ciphertext block chains into the next run.
+        cc_memcpy(saved, saved + n * block_size, block_size);
+
+        nblocks -= n;
+        pt += n * block_size;
+        ct += n * block_size;
+    }
+
+    cc_memcpy(iv, saved, block_size);
+    cc_clear(sizeof(saved), saved);
+
     return 0;
 }
@@ -11,6 +11,9 @@
 
 #include "ccmode_internal.h"
 
+/* Number of keystream blocks generated with a single ECB call. */
+#define CCMODE_CTR_NBLOCKS 8
+
 int ccmode_ctr_crypt(ccctr_ctx *key,
                      size_t nbytes, const void *in, void *out) {
     const struct ccmode_ecb *ecb = CCMODE_CTR_KEY_ECB(key);
@@ -24,17 +27,38 @@ int ccmode_ctr_crypt(ccctr_ctx *key,
     const size_t max_counter_size = 8;
     const size_t counter_size = CC_MIN(ecb->block_size, max_counter_size);
     uint8_t *out_bytes = out;
+    uint8_t ks[CCMODE_CTR_NBLOCKS * CCMODE_MAX_BLOCK_SIZE];
+    size_t ks_nbytes = 0;
     size_t n;
 
+    cc_assert(ecb->block_size <= CCMODE_MAX_BLOCK_SIZE);
+
     while (nbytes) {
+        if (pad_offset == ecb->block_size && nbytes >= ecb->block_size) {
+            // Whole blocks: encrypt a run of counters with a single ECB call.
+            size_t nblocks = CC_MIN(nbytes / ecb->block_size, CCMODE_CTR_NBLOCKS);
+            n = nblocks * ecb->block_size;
+
+            for (size_t i = 0; i < nblocks; i++) {
+                cc_memcpy(ks + i * ecb->block_size, ctr, ecb->block_size);
+                inc_uint(ctr + ecb->block_size - counter_size, counter_size);
+            }
+            ecb->ecb(ecb_key, nblocks, ks, ks);
+            ccmode_xor_wide(n, out_bytes, in_bytes, ks);
+            ks_nbytes = CC_MAX(ks_nbytes, n);
+
+            nbytes -= n;
+            in_bytes += n;
+            out_bytes += n;
+            continue;
+        }
+
         if (pad_offset == ecb->block_size) {
             ecb->ecb(ecb_key, 1, ctr, pad);
             pad_offset = 0;
 
             /* increment the big endian counter */
             inc_uint(ctr + ecb->block_size - counter_size, counter_size);
-
-            if (nbytes==0) break;
         }
         
         n = CC_MIN(nbytes, ecb->block_size - pad_offset);
@@ -45,6 +69,10 @@ int ccmode_ctr_crypt(ccctr_ctx *key,
         pad_offset += n;
     }
     CCMODE_CTR_KEY_PAD_OFFSET(key) = pad_offset;
-    
+
+    if (ks_nbytes) {
+        cc_clear(ks_nbytes, ks);
+    }
+
     return 0;
 }
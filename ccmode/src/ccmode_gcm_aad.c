@@ -9,8 +9,6 @@
  * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
  */
 
-#include <corecrypto/cc_runtime_config.h>
-#include "ccaes_vng_gcm.h"
 #include "ccmode_internal.h"
 
 /**
@@ -43,32 +41,13 @@ int ccmode_gcm_aad(ccgcm_ctx *key, size_t nbytes, const void *in)
     }
 
     // process full blocks, if any
-    if (X_nbytes == 0) {
-#if CCMODE_GCM_VNG_SPEEDUP
-#ifdef  __x86_64__
-        if (CC_HAS_AESNI() && CC_HAS_SupplementalSSE3())
-#endif //__x86_64__
-            if (nbytes >= CCGCM_BLOCK_NBYTES) {
-                size_t j = nbytes & (size_t)(-16);
-                gcm_ghash(X, (void *) CCMODE_GCM_VNG_KEY_Htable(key), (const void*) bytes, j);
-                
-                bytes += j;
-                nbytes -= j;
-                _CCMODE_GCM_KEY(key)->aad_nbytes += j;
-            }
-#endif //CCMODE_GCM_VNG_SPEEDUP
-        
-        /* fallback in absence of vng */
-        /* including this in ifdef is tricky */
-        /* due to runtime checks for aesni and sse3 */
-        while (nbytes >= CCGCM_BLOCK_NBYTES) {
-            cc_xor(CCGCM_BLOCK_NBYTES, X, X, bytes);
-            ccmode_gcm_mult_h(key, X);
-            
-            nbytes -= CCGCM_BLOCK_NBYTES;
-            bytes += CCGCM_BLOCK_NBYTES;
-            _CCMODE_GCM_KEY(key)->aad_nbytes += CCGCM_BLOCK_NBYTES;
-        }
+    if (X_nbytes == 0 && nbytes >= CCGCM_BLOCK_NBYTES) {
+        size_t j = nbytes & (size_t)(-16);
+        ccmode_gcm_ghash(key, j / CCGCM_BLOCK_NBYTES, bytes);
+
+        nbytes -= j;
+        bytes += j;
+        _CCMODE_GCM_KEY(key)->aad_nbytes += j;
     }
 
     // process the remainder
@@ -0,0 +1,147 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#ifndef _CORECRYPTO_CCMODE_GCM_CLMUL_H_
+#define _CORECRYPTO_CCMODE_GCM_CLMUL_H_
+
+#include "ccmode_gcm_tables.h"
+
+#if CCMODE_GCM_CLMUL
+
+#include <immintrin.h>
+
+/* GHASH using PCLMULQDQ, following "Intel Carry-Less Multiplication
+ * Instruction and its Usage for Computing the GCM Mode" (Gueron, Kounavis).
+ *
+ * Operands are byte reversed on load, so that the carry-less product of
+ * two field elements a and b represents a * b * x. The powers of H are
+ * stored multiplied by x^-1 (see ghash_twist()), which cancels the extra
+ * factor and lets ghash_reduce() fold the product with two multiplications
+ * by the reflected polynomial instead of a chain of shifts.
+ * The reduction is linear, so the unreduced products of several blocks
+ * with H^8..H^1 can be summed and reduced only once. With VPCLMULQDQ,
+ * four blocks are multiplied per instruction and sixteen blocks share a
+ * reduction. */
+
+#define GHASH_TARGET __attribute__((target("pclmul,ssse3")))
+
+CC_INLINE GHASH_TARGET
+__m128i ghash_bswap(__m128i x)
+{
+    return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/* x^128 + x^7 + x^2 + x + 1, reflected: the high half is x^63 + x^62 + x^57. */
+CC_INLINE GHASH_TARGET
+__m128i ghash_poly(void)
+{
+    return _mm_set_epi64x((long long)0xc200000000000000ULL, 1);
+}
+
+/* Multiply the byte reversed H by x^-1, i.e. shift the 128-bit value left
+ * by one bit and add the reflected polynomial if a bit was shifted out. */
+CC_INLINE GHASH_TARGET
+__m128i ghash_twist(__m128i h)
+{
+    __m128i carry = _mm_srai_epi32(_mm_shuffle_epi32(h, 0xd3), 31);
+    carry = _mm_and_si128(carry, _mm_set_epi32((int)0xc2000000, 1, 0, 1));
+    return _mm_xor_si128(_mm_add_epi64(h, h), carry);
+}
+
+/* Accumulate the 256-bit carry-less product a * b into (lo, mid, hi). */
+CC_INLINE GHASH_TARGET
+void ghash_mul_acc(__m128i a, __m128i b, __m128i *lo, __m128i *mid, __m128i *hi)
+{
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x01));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a, b, 0x10));
+}
+
+/* Reduce the product (lo, mid, hi) modulo x^128 + x^7 + x^2 + x + 1. The
+ * low 64 bits of lo, then of mid, are folded in by multiplying them by the
+ * high half of the reflected polynomial. */
+CC_INLINE GHASH_TARGET
+__m128i ghash_reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+    const __m128i poly = ghash_poly();
+
+    mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(lo, poly, 0x10));
+    mid = _mm_xor_si128(mid, _mm_shuffle_epi32(lo, 0x4e));
+    hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(mid, poly, 0x10));
+    return _mm_xor_si128(hi, _mm_shuffle_epi32(mid, 0x4e));
+}
+
+#define GHASH_WIDE_TARGET __attribute__((target("pclmul,ssse3,avx512f,avx512bw,vpclmulqdq")))
+
+CC_INLINE GHASH_WIDE_TARGET
+__m128i ghash_fold4(__m512i v)
+{
+    __m128i r = _mm512_extracti32x4_epi32(v, 0);
+    r = _mm_xor_si128(r, _mm512_extracti32x4_epi32(v, 1));
+    r = _mm_xor_si128(r, _mm512_extracti32x4_epi32(v, 2));
+    return _mm_xor_si128(r, _mm512_extracti32x4_epi32(v, 3));
+}
+
+CC_INLINE GHASH_WIDE_TARGET
+__m512i ghash_bswap_mask_wide(void)
+{
+    return _mm512_broadcast_i32x4(_mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/* Accumulate the four 256-bit carry-less products a[i] * b[i] using
+ * Karatsuba: mid collects (a_hi ^ a_lo) * (b_hi ^ b_lo), and the middle
+ * term is mid ^ lo ^ hi once all products have been summed. */
+CC_INLINE GHASH_WIDE_TARGET
+void ghash_mul_acc_wide(__m512i a, __m512i b, __m512i *lo, __m512i *mid, __m512i *hi)
+{
+    __m512i am = _mm512_xor_si512(a, _mm512_shuffle_epi32(a, _MM_PERM_BADC));
+    __m512i bm = _mm512_xor_si512(b, _mm512_shuffle_epi32(b, _MM_PERM_BADC));
+
+    *lo = _mm512_xor_si512(*lo, _mm512_clmulepi64_epi128(a, b, 0x00));
+    *hi = _mm512_xor_si512(*hi, _mm512_clmulepi64_epi128(a, b, 0x11));
+    *mid = _mm512_xor_si512(*mid, _mm512_clmulepi64_epi128(am, bm, 0x00));
+}
+
+/* Vector i holds H^(16-4i)..H^(13-4i), matching blocks 4i..4i+3 of a
+ * CCMODE_GCM_CLMUL_WIDE_NBLOCKS run. */
+CC_INLINE GHASH_WIDE_TARGET
+void ghash_load_hpow_wide(const struct _ccmode_gcm_htable *Htable, __m512i hpow[CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4])
+{
+    for (unsigned i = 0; i < CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4; i++) {
+        __m512i h = _mm512_loadu_si512(Htable->Hpow[CCMODE_GCM_CLMUL_WIDE_NBLOCKS - 4 * (i + 1)]);
+        hpow[i] = _mm512_shuffle_i64x2(h, h, 0x1b);
+    }
+}
+
+/* Fold the CCMODE_GCM_CLMUL_WIDE_NBLOCKS blocks c (as stored in memory)
+ * into the byte reversed accumulator x, with a single reduction. */
+CC_INLINE GHASH_WIDE_TARGET
+__m128i ghash_fold_wide(__m128i x, const __m512i hpow[CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4],
+                        const __m512i c[CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4])
+{
+    const __m512i bswap = ghash_bswap_mask_wide();
+    __m512i lo = _mm512_setzero_si512(), mid = lo, hi = lo;
+
+    for (unsigned i = 0; i < CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4; i++) {
+        __m512i b = _mm512_shuffle_epi8(c[i], bswap);
+        if (i == 0) {
+            b = _mm512_xor_si512(b, _mm512_inserti32x4(_mm512_setzero_si512(), x, 0));
+        }
+        ghash_mul_acc_wide(b, hpow[i], &lo, &mid, &hi);
+    }
+    mid = _mm512_ternarylogic_epi64(mid, lo, hi, 0x96);
+    return ghash_reduce(ghash_fold4(lo), ghash_fold4(mid), ghash_fold4(hi));
+}
+
+#endif /* CCMODE_GCM_CLMUL */
+
+#endif /* _CORECRYPTO_CCMODE_GCM_CLMUL_H_ */
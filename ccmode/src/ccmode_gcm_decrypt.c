@@ -51,18 +51,24 @@ int ccmode_gcm_decrypt(ccgcm_ctx *key, size_t nbytes, const void *in, void *out)
 
     // process full blocks, if any
     if (Xpad_nbytes == 0) {
-        while (nbytes >= CCGCM_BLOCK_NBYTES) {
-            cc_xor(CCGCM_BLOCK_NBYTES, X, X, ctext);
-            ccmode_gcm_mult_h(key, X);
-            cc_xor(CCGCM_BLOCK_NBYTES, ptext, ctext, pad);
-
-            nbytes -= CCGCM_BLOCK_NBYTES;
-            ctext += CCGCM_BLOCK_NBYTES;
-            ptext += CCGCM_BLOCK_NBYTES;
-            _CCMODE_GCM_KEY(key)->text_nbytes += CCGCM_BLOCK_NBYTES;
+        uint8_t ks[(CCMODE_GCM_NBLOCKS + 1) * CCGCM_BLOCK_NBYTES];
 
-            ccmode_gcm_update_pad(key);
+        while (nbytes >= CCGCM_BLOCK_NBYTES) {
+            size_t nblocks = CC_MIN(nbytes / CCGCM_BLOCK_NBYTES, CCMODE_GCM_NBLOCKS);
+            size_t n = nblocks * CCGCM_BLOCK_NBYTES;
+
+            // hash the ciphertext first, in case it is decrypted in place
+            ccmode_gcm_ghash(key, nblocks, ctext);
+            ccmode_gcm_update_pad_nblocks(key, nblocks, ks);
+            ccmode_xor_wide(n, ptext, ctext, ks);
+
+            nbytes -= n;
+            ctext += n;
+            ptext += n;
+            _CCMODE_GCM_KEY(key)->text_nbytes += n;
         }
+
+        cc_clear(sizeof(ks), ks);
     }
 
     // process the remainder
@@ -48,18 +48,23 @@ int ccmode_gcm_encrypt(ccgcm_ctx *key, size_t nbytes, const void *in, void *out)
 
     // process full blocks, if any
     if (Xpad_nbytes == 0) {
+        uint8_t ks[(CCMODE_GCM_NBLOCKS + 1) * CCGCM_BLOCK_NBYTES];
+
         while (nbytes >= CCGCM_BLOCK_NBYTES) {
-            cc_xor(CCGCM_BLOCK_NBYTES, ctext, ptext, pad);
-            cc_xor(CCGCM_BLOCK_NBYTES, X, X, ctext);
-            ccmode_gcm_mult_h(key, X);
+            size_t nblocks = CC_MIN(nbytes / CCGCM_BLOCK_NBYTES, CCMODE_GCM_NBLOCKS);
+            size_t n = nblocks * CCGCM_BLOCK_NBYTES;
 
-            nbytes -= CCGCM_BLOCK_NBYTES;
-            ptext += CCGCM_BLOCK_NBYTES;
-            ctext += CCGCM_BLOCK_NBYTES;
-            _CCMODE_GCM_KEY(key)->text_nbytes += CCGCM_BLOCK_NBYTES;
+            ccmode_gcm_update_pad_nblocks(key, nblocks, ks);
+            ccmode_xor_wide(n, ctext, ptext, ks);
+            ccmode_gcm_ghash(key, nblocks, ctext);
 
-            ccmode_gcm_update_pad(key);
+            nbytes -= n;
+            ptext += n;
+            ctext += n;
+            _CCMODE_GCM_KEY(key)->text_nbytes += n;
         }
+
+        cc_clear(sizeof(ks), ks);
     }
 
     // process the remainder
@@ -24,6 +24,7 @@
 
 #include <corecrypto/cc_runtime_config.h>
 #include <corecrypto/ccmode_internal.h>
+#include "ccmode_gcm_tables.h"
 
 /* this is x*2^128 mod p(x) ... the results are 16 bytes each stored in a packed format.  Since only the
  * lower 16 bits are not zero'ed I removed the upper 14 bytes */
@@ -239,3 +240,84 @@ ccmode_gcm_gf_mult_compute(const unsigned char *a, const unsigned char *b, unsig
 {
     _ccmode_gcm_gf_mult(a, b, c);
 }
+
+#if !CCMODE_GCM_VNG_SPEEDUP
+
+/* x^4 * r mod p(x) for the 4 bits shifted out of the product, in the top
+   16 bits of the high word. */
+static const uint64_t gcm_rem_4bit[16] = {
+    0x0000ULL << 48, 0x1C20ULL << 48, 0x3840ULL << 48, 0x2460ULL << 48,
+    0x7080ULL << 48, 0x6CA0ULL << 48, 0x48C0ULL << 48, 0x54E0ULL << 48,
+    0xE100ULL << 48, 0xFD20ULL << 48, 0xD940ULL << 48, 0xC560ULL << 48,
+    0x9180ULL << 48, 0x8DA0ULL << 48, 0xA9C0ULL << 48, 0xB5E0ULL << 48,
+};
+
+void
+ccmode_gcm_init_htable(struct _ccmode_gcm_htable *Htable, const unsigned char *H)
+{
+    uint64_t hi, lo, t;
+
+    CC_LOAD64_BE(hi, H);
+    CC_LOAD64_BE(lo, H + 8);
+
+    Htable->hi[0] = 0;
+    Htable->lo[0] = 0;
+
+    /* H, H*x, H*x^2 and H*x^3, at the reflected indices 8, 4, 2 and 1 */
+    for (unsigned i = 8; i > 0; i >>= 1) {
+        Htable->hi[i] = hi;
+        Htable->lo[i] = lo;
+
+        t = 0xe100000000000000ULL & (0 - (lo & 1));
+        lo = (hi << 63) | (lo >> 1);
+        hi = (hi >> 1) ^ t;
+    }
+
+    /* the remaining entries are sums of the four above */
+    for (unsigned i = 2; i < 16; i <<= 1) {
+        for (unsigned j = 1; j < i; j++) {
+            Htable->hi[i + j] = Htable->hi[i] ^ Htable->hi[j];
+            Htable->lo[i + j] = Htable->lo[i] ^ Htable->lo[j];
+        }
+    }
+}
+
+void
+ccmode_gcm_gmult_htable(unsigned char *X, const struct _ccmode_gcm_htable *Htable)
+{
+    uint64_t zhi, zlo;
+    unsigned rem, nlo, nhi;
+    int i;
+
+    nlo = X[15] & 0xf;
+    nhi = X[15] >> 4;
+    zhi = Htable->hi[nlo];
+    zlo = Htable->lo[nlo];
+
+    /* consume X one nibble at a time, from the last byte to the first */
+    for (i = 15;;) {
+        rem = (unsigned)zlo & 0xf;
+        zlo = (zhi << 60) | (zlo >> 4);
+        zhi = (zhi >> 4) ^ gcm_rem_4bit[rem];
+        zhi ^= Htable->hi[nhi];
+        zlo ^= Htable->lo[nhi];
+
+        if (--i < 0) {
+            break;
+        }
+
+        nlo = X[i] & 0xf;
+        nhi = X[i] >> 4;
+
+        rem = (unsigned)zlo & 0xf;
+        zlo = (zhi << 60) | (zlo >> 4);
+        zhi = (zhi >> 4) ^ gcm_rem_4bit[rem];
+        zhi ^= Htable->hi[nlo];
+        zlo ^= Htable->lo[nlo];
+    }
+
+    CC_STORE64_BE(zhi, X);
+    CC_STORE64_BE(zlo, X + 8);
+}
+
+#endif // !CCMODE_GCM_VNG_SPEEDUP
@@ -0,0 +1,139 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include "ccmode_internal.h"
+#include "ccmode_gcm_tables.h"
+
+#if CCMODE_GCM_CLMUL
+
+#include "ccmode_gcm_clmul.h"
+
+CC_INLINE GHASH_TARGET
+__m128i ghash_mul(__m128i a, __m128i b)
+{
+    __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+    ghash_mul_acc(a, b, &lo, &mid, &hi);
+    return ghash_reduce(lo, mid, hi);
+}
+
+GHASH_TARGET
+void ccmode_gcm_init_clmul(struct _ccmode_gcm_htable *Htable, const unsigned char *H)
+{
+    __m128i h = ghash_twist(ghash_bswap(_mm_loadu_si128((const __m128i *)H)));
+    __m128i hn = h;
+
+    _mm_storeu_si128((__m128i *)Htable->Hpow[0], h);
+    for (unsigned i = 1; i < CCMODE_GCM_CLMUL_WIDE_NBLOCKS; i++) {
+        hn = ghash_mul(hn, h);
+        _mm_storeu_si128((__m128i *)Htable->Hpow[i], hn);
+    }
+}
+
+GHASH_TARGET
+void ccmode_gcm_gmult_clmul(unsigned char *X, const struct _ccmode_gcm_htable *Htable)
+{
+    __m128i x = ghash_bswap(_mm_loadu_si128((const __m128i *)X));
+    x = ghash_mul(x, _mm_loadu_si128((const __m128i *)Htable->Hpow[0]));
+    _mm_storeu_si128((__m128i *)X, ghash_bswap(x));
+}
+
+/* Four products in flight hide the latency of PCLMULQDQ, which a
+   single accumulator leaves exposed on every block. */
+GHASH_TARGET
+void ccmode_gcm_gmult_clmul_lanes(size_t nlanes, unsigned char *const *X, const struct _ccmode_gcm_htable *Htable)
+{
+    __m128i h = _mm_loadu_si128((const __m128i *)Htable->Hpow[0]);
+    __m128i x[4];
+    size_t i = 0;
+
+    for (; i + 4 <= nlanes; i += 4) {
+        for (unsigned j = 0; j < 4; j++) {
+            x[j] = ghash_bswap(_mm_loadu_si128((const __m128i *)X[i + j]));
+        }
+        for (unsigned j = 0; j < 4; j++) {
+            x[j] = ghash_mul(x[j], h);
+        }
+        for (unsigned j = 0; j < 4; j++) {
+            _mm_storeu_si128((__m128i *)X[i + j], ghash_bswap(x[j]));
+        }
+    }
+
+    for (; i < nlanes; i++) {
+        ccmode_gcm_gmult_clmul(X[i], Htable);
+    }
+}
+
+/* Fold a multiple of CCMODE_GCM_CLMUL_WIDE_NBLOCKS blocks into x. */
+static GHASH_WIDE_TARGET
+__m128i ghash_wide(__m128i x, const struct _ccmode_gcm_htable *Htable,
+                   size_t nblocks, const unsigned char *in)
+{
+    const __m512i *p = (const __m512i *)in;
+    __m512i hpow[CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4];
+    __m512i c[CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4];
+
+    ghash_load_hpow_wide(Htable, hpow);
+
+    for (; nblocks; nblocks -= CCMODE_GCM_CLMUL_WIDE_NBLOCKS) {
+        for (unsigned i = 0; i < CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4; i++) {
+            c[i] = _mm512_loadu_si512(p + i);
+        }
+        x = ghash_fold_wide(x, hpow, c);
+        p += CCMODE_GCM_CLMUL_WIDE_NBLOCKS / 4;
+    }
+
+    return x;
+}
+
+GHASH_TARGET
+void ccmode_gcm_ghash_clmul(unsigned char *X, const struct _ccmode_gcm_htable *Htable,
+                            size_t nblocks, const unsigned char *in)
+{
+    const __m128i *p = (const __m128i *)in;
+    __m128i hpow[CCMODE_GCM_CLMUL_NBLOCKS];
+    __m128i x = ghash_bswap(_mm_loadu_si128((const __m128i *)X));
+
+    for (unsigned i = 0; i < CCMODE_GCM_CLMUL_NBLOCKS; i++) {
+        hpow[i] = _mm_loadu_si128((const __m128i *)Htable->Hpow[i]);
+    }
+
+    if (nblocks >= CCMODE_GCM_CLMUL_WIDE_NBLOCKS && CC_HAS_AVX512_VAES()) {
+        size_t n = nblocks - nblocks % CCMODE_GCM_CLMUL_WIDE_NBLOCKS;
+        x = ghash_wide(x, Htable, n, in);
+        p += n;
+        nblocks -= n;
+    }
+
+    while (nblocks >= CCMODE_GCM_CLMUL_NBLOCKS) {
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+
+        // (X ^ C_0) * H^8 ^ C_1 * H^7 ^ ... ^ C_7 * H
+        x = _mm_xor_si128(x, ghash_bswap(_mm_loadu_si128(p)));
+        ghash_mul_acc(x, hpow[CCMODE_GCM_CLMUL_NBLOCKS - 1], &lo, &mid, &hi);
+        for (unsigned i = 1; i < CCMODE_GCM_CLMUL_NBLOCKS; i++) {
+            __m128i c = ghash_bswap(_mm_loadu_si128(p + i));
+            ghash_mul_acc(c, hpow[CCMODE_GCM_CLMUL_NBLOCKS - 1 - i], &lo, &mid, &hi);
+        }
+        x = ghash_reduce(lo, mid, hi);
+
+        p += CCMODE_GCM_CLMUL_NBLOCKS;
+        nblocks -= CCMODE_GCM_CLMUL_NBLOCKS;
+    }
+
+    while (nblocks--) {
+        x = _mm_xor_si128(x, ghash_bswap(_mm_loadu_si128(p++)));
+        x = ghash_mul(x, hpow[0]);
+    }
+
+    _mm_storeu_si128((__m128i *)X, ghash_bswap(x));
+}
+
+#endif /* CCMODE_GCM_CLMUL */
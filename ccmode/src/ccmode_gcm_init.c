@@ -44,7 +44,13 @@ int ccmode_gcm_init(const struct ccmode_gcm *gcm, ccgcm_ctx *key,
     if (CC_HAS_AESNI() && CC_HAS_SupplementalSSE3())
 #endif
         gcm_init(CCMODE_GCM_VNG_KEY_Htable(key), CCMODE_GCM_KEY_H(key));
-
+#else
+    ccmode_gcm_init_htable(CCMODE_GCM_KEY_Htable(key), CCMODE_GCM_KEY_H(key));
+#if CCMODE_GCM_CLMUL
+    if (CCMODE_GCM_CLMUL_ENABLED()) {
+        ccmode_gcm_init_clmul(CCMODE_GCM_KEY_Htable(key), CCMODE_GCM_KEY_H(key));
+    }
+#endif
 #endif
 
      return 0;
@@ -12,6 +12,7 @@
 #include <corecrypto/cc_runtime_config.h>
 #include "ccaes_vng_gcm.h"
 #include "ccmode_internal.h"
+#include "ccmode_gcm_tables.h"
 
 /*!
  GCM multiply by H
@@ -34,8 +35,65 @@ void ccmode_gcm_mult_h(ccgcm_ctx *key, unsigned char *I)
         return;
     }
 #else
-    //It can handle in and out buffers to be the same
-    ccmode_gcm_gf_mult(CCMODE_GCM_KEY_H(key), I, I);
+#if CCMODE_GCM_CLMUL
+    if (CCMODE_GCM_CLMUL_ENABLED()) {
+        ccmode_gcm_gmult_clmul(I, CCMODE_GCM_KEY_Htable(key));
+        return;
+    }
+#endif
+    ccmode_gcm_gmult_htable(I, CCMODE_GCM_KEY_Htable(key));
+#endif
+}
+
+/*!
+ GCM multiply by H of independent accumulators, such as those of different
+ records under the same key
+ @param key     The GCM state which holds the H value
+ @param nlanes  Number of accumulators
+ @param X       The values to multiply H by
+ */
+void ccmode_gcm_mult_h_lanes(ccgcm_ctx *key, size_t nlanes, unsigned char *const *X)
+{
+#if CCMODE_GCM_CLMUL
+    if (CCMODE_GCM_CLMUL_ENABLED()) {
+        ccmode_gcm_gmult_clmul_lanes(nlanes, X, CCMODE_GCM_KEY_Htable(key));
+        return;
+    }
 #endif
+    for (size_t i = 0; i < nlanes; i++) {
+        ccmode_gcm_mult_h(key, X[i]);
+    }
 }
 
+/*!
+ GCM hash of whole blocks
+ @param key       The GCM state which holds the H value and the accumulator X
+ @param nblocks   Number of 16-byte blocks to hash
+ @param in        The blocks to fold into X
+ */
+void ccmode_gcm_ghash(ccgcm_ctx *key, size_t nblocks, const void *in)
+{
+    const uint8_t *bytes = in;
+    uint8_t *X = CCMODE_GCM_KEY_X(key);
+
+#if CCMODE_GCM_VNG_SPEEDUP
+#ifdef  __x86_64__
+    if (CC_HAS_AESNI() && CC_HAS_SupplementalSSE3())
+#endif
+    {
+        gcm_ghash(X, (void *)CCMODE_GCM_VNG_KEY_Htable(key), bytes, nblocks * CCGCM_BLOCK_NBYTES);
+        return;
+    }
+#elif CCMODE_GCM_CLMUL
+    if (CCMODE_GCM_CLMUL_ENABLED()) {
+        ccmode_gcm_ghash_clmul(X, CCMODE_GCM_KEY_Htable(key), nblocks, bytes);
+        return;
+    }
+#endif
+
+    while (nblocks--) {
+        cc_xor(CCGCM_BLOCK_NBYTES, X, X, bytes);
+        ccmode_gcm_mult_h(key, X);
+        bytes += CCGCM_BLOCK_NBYTES;
+    }
+}
@@ -15,10 +15,58 @@
 #include "ccaes_vng_gcm.h"
 #include "ccmode_internal.h"
 
+// Carry-less multiply GHASH, for x86_64 targets without the VNG assembly.
+#if defined(__x86_64__) && !CC_KERNEL && !CCMODE_GCM_VNG_SPEEDUP
+#define CCMODE_GCM_CLMUL 1
+#include <corecrypto/cc_runtime_config.h>
+#define CCMODE_GCM_CLMUL_ENABLED() (CC_HAS_AESNI() && CC_HAS_PCLMUL())
+#else
+#define CCMODE_GCM_CLMUL 0
+#endif
+
+// Number of blocks folded into a single GHASH reduction
+#define CCMODE_GCM_CLMUL_NBLOCKS 8
+
+// Same, for the 512-bit VPCLMULQDQ path used when CC_HAS_AVX512_VAES()
+#define CCMODE_GCM_CLMUL_WIDE_NBLOCKS 16
+
 #if CCMODE_GCM_VNG_SPEEDUP
     #define GCM_TABLE_SIZE VNG_GCM_TABLE_SIZE
 #else
-    #define GCM_TABLE_SIZE 0
+    #define GCM_TABLE_SIZE sizeof(struct _ccmode_gcm_htable)
+    #define CCMODE_GCM_KEY_Htable(K) ((struct _ccmode_gcm_htable *)&_CCMODE_GCM_KEY(K)->u[0])
+
+/* Shoup's 4-bit table of multiples of H: entry i holds i * H, with the
+   4-bit index i read in GCM's reflected bit order. Each element is kept as
+   two big endian 64-bit halves. Computed once per key by ccmode_gcm_init(). */
+struct _ccmode_gcm_htable {
+    uint64_t hi[16];
+    uint64_t lo[16];
+#if CCMODE_GCM_CLMUL
+    // H^1..H^16, byte reversed, for the aggregated carry-less multiply
+    unsigned char Hpow[CCMODE_GCM_CLMUL_WIDE_NBLOCKS][16];
+#endif
+};
+
+void ccmode_gcm_init_htable(struct _ccmode_gcm_htable *Htable, const unsigned char *H);
+
+/* X = X * H, where Htable was computed from H. */
+void ccmode_gcm_gmult_htable(unsigned char *X, const struct _ccmode_gcm_htable *Htable);
+
+#if CCMODE_GCM_CLMUL
+/* Only call these when CCMODE_GCM_CLMUL_ENABLED(). */
+void ccmode_gcm_init_clmul(struct _ccmode_gcm_htable *Htable, const unsigned char *H);
+
+/* X = X * H */
+void ccmode_gcm_gmult_clmul(unsigned char *X, const struct _ccmode_gcm_htable *Htable);
+
+/* X[i] = X[i] * H for each of the nlanes independent accumulators */
+void ccmode_gcm_gmult_clmul_lanes(size_t nlanes, unsigned char *const *X, const struct _ccmode_gcm_htable *Htable);
+
+/* Fold nblocks blocks of in into X: X = (...((X ^ in[0]) * H ^ in[1]) * H ...) * H */
+void ccmode_gcm_ghash_clmul(unsigned char *X, const struct _ccmode_gcm_htable *Htable,
+                            size_t nblocks, const unsigned char *in);
+#endif
 #endif
 
 #endif /* ccmode_gcm_tables_h */
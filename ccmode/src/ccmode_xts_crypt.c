@@ -11,6 +11,10 @@
 
 #include "ccmode_internal.h"
 
+/* Number of blocks whose tweaks are precomputed and handed to the
+   underlying ECB in a single call. */
+#define CCMODE_XTS_NBLOCKS 8
+
 void *ccmode_xts_crypt(const ccxts_ctx *ctx, ccxts_tweak *tweak,
                        size_t nblocks, const void *in, void *out) 
 {
@@ -25,15 +29,31 @@ void *ccmode_xts_crypt(const ccxts_ctx *ctx, ccxts_tweak *tweak,
     cc_unit *t=CCMODE_XTS_TWEAK_VALUE(tweak);
     const cc_unit *input = in;
     cc_unit *output = out;
+    const size_t n16 = ccn_nof_size(16);
+    cc_unit tweaks[CCMODE_XTS_NBLOCKS * ccn_nof_size(16)];
+    size_t tweaks_used = 0;
+
     while (nblocks) {
-        ccn_xor(ccn_nof_size(16), output, input, t);
-        ecb->ecb(ccmode_xts_key_data_key(ctx), 1, output, output);
-        ccn_xor(ccn_nof_size(16), output, output, t);
-        ccmode_xts_mult_alpha(t);
-        --nblocks;
-        input += ccn_nof_size(16);
-        output += ccn_nof_size(16);
+        size_t n = CC_MIN(nblocks, CCMODE_XTS_NBLOCKS);
+
+        // Derive the tweak of every block in the run, then whiten,
+        // encrypt all of them with one ECB call, and whiten again.
+        for (size_t i = 0; i < n; i++) {
+            ccn_set(n16, &tweaks[i * n16], t);
+            ccmode_xts_mult_alpha(t);
+        }
+        ccn_xor(n * n16, output, input, tweaks);
+        ecb->ecb(ccmode_xts_key_data_key(ctx), n, output, output);
+        ccn_xor(n * n16, output, output, tweaks);
+
+        tweaks_used = CC_MAX(tweaks_used, n);
+        nblocks -= n;
+        input += n * n16;
+        output += n * n16;
+    }
+
+    if (tweaks_used) {
+        cc_clear(tweaks_used * 16, tweaks);
     }
     return t;
 }
-
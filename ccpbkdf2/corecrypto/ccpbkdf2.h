@@ -40,4 +40,27 @@ int ccpbkdf2_hmac(const struct ccdigest_info *di,
                    size_t iterations,
                    size_t dkLen, void *dk);
 
+/*! @function ccpbkdf2_hmac_batch
+    @abstract perform n independent pbkdf2 derivations with the same digest, iteration count and output length
+    @discussion Equivalent to calling ccpbkdf2_hmac for each password in turn. With the SHA-2
+digests on processors with AVX2 or AVX-512, the passwords are processed in parallel SIMD
+lanes, which is considerably faster than deriving them one at a time.
+    @param di            digest info defining the digest type to use in the PRF.
+    @param n             number of derivations
+    @param passwordLens  n password lengths
+    @param passwords     n passwords
+    @param saltLens      n salt lengths
+    @param salts         n salts
+    @param iterations    itrations to go
+    @param dkLen         length of each result
+    @param dks           n buffers for the results, each must be dkLen big
+
+ */
+int ccpbkdf2_hmac_batch(const struct ccdigest_info *di,
+                        size_t n,
+                        const size_t *passwordLens, const void *const *passwords,
+                        const size_t *saltLens, const void *const *salts,
+                        size_t iterations,
+                        size_t dkLen, void *const *dks);
+
 #endif /* _CORECRYPTO_CCPBKDF2_H_ */
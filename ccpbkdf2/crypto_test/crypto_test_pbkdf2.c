@@ -28,8 +28,9 @@ entryPoint(ccpbkdf2_tests,"ccpbkdf2 test")
 #include <corecrypto/ccsha1.h>
 #include <corecrypto/ccsha2.h>
 #include <corecrypto/ccripemd.h>
+#include <corecrypto/cchmac.h>
 
-static const int kTestTestCount = 180;
+static const int kTestTestCount = 196;
 
 
 /* Currently, ccpbkdf2 and friends won't work when length == 0 and the
@@ -175,6 +176,72 @@ static int test_pbkdf2(const struct ccdigest_info *di) {
     return 1;
 }
 
+/* PBKDF2 straight from the definition, one HMAC call per U_i. */
+static void ref_pbkdf2(const struct ccdigest_info *di,
+                       size_t passwordLen, const void *password,
+                       size_t saltLen, const uint8_t *salt,
+                       size_t iterations, size_t dkLen, uint8_t *dk)
+{
+    size_t hLen = di->output_size;
+    uint8_t in[saltLen + 4], u[hLen], t[hLen];
+
+    memcpy(in, salt, saltLen);
+    for (uint32_t block = 1; dkLen > 0; block++) {
+        in[saltLen + 0] = (uint8_t)(block >> 24);
+        in[saltLen + 1] = (uint8_t)(block >> 16);
+        in[saltLen + 2] = (uint8_t)(block >> 8);
+        in[saltLen + 3] = (uint8_t)block;
+        cchmac(di, passwordLen, password, saltLen + 4, in, u);
+        memcpy(t, u, hLen);
+        for (size_t i = 2; i <= iterations; i++) {
+            cchmac(di, passwordLen, password, hLen, u, u);
+            for (size_t j = 0; j < hLen; j++) {
+                t[j] ^= u[j];
+            }
+        }
+        size_t n = dkLen < hLen ? dkLen : hLen;
+        memcpy(dk, t, n);
+        dk += n;
+        dkLen -= n;
+    }
+}
+
+/* Batch and multi-block derivations, which may use SIMD lanes, against the
+   reference. Enough passwords to fill every lane once and leave a few, and
+   enough output blocks (17 and a partial one) to reach the lanes with any
+   min_nlanes and then hand the remaining blocks back to F(). */
+static int test_batch(const struct ccdigest_info *di) {
+    enum { n = 19 };
+    const size_t iterations = 5;
+    const size_t dkLen = 17 * di->output_size + 5;
+    uint8_t passwords[n][n + 1], salts[n][16];
+    uint8_t dks[n][dkLen], expected[n][dkLen], single[dkLen];
+    size_t passwordLens[n], saltLens[n];
+    const void *passwordPtrs[n], *saltPtrs[n];
+    void *dkPtrs[n];
+    int single_ok = 1;
+
+    for (size_t i = 0; i < n; i++) {
+        passwordLens[i] = i + 1;
+        saltLens[i] = 1 + i % 16;
+        memset(passwords[i], 'a' + (int)i, sizeof(passwords[i]));
+        memset(salts[i], (int)i, sizeof(salts[i]));
+        passwordPtrs[i] = passwords[i];
+        saltPtrs[i] = salts[i];
+        dkPtrs[i] = dks[i];
+        ref_pbkdf2(di, passwordLens[i], passwords[i], saltLens[i], salts[i], iterations, dkLen, expected[i]);
+
+        ccpbkdf2_hmac(di, passwordLens[i], passwords[i], saltLens[i], salts[i], iterations, dkLen, single);
+        single_ok &= (memcmp(single, expected[i], dkLen) == 0);
+    }
+    ok(single_ok, "multi-block ccpbkdf2_hmac matches reference");
+
+    is(ccpbkdf2_hmac_batch(di, n, passwordLens, passwordPtrs, saltLens, saltPtrs, iterations, dkLen, dkPtrs), 0,
+       "ccpbkdf2_hmac_batch succeeds");
+    ok(memcmp(dks, expected, sizeof(dks)) == 0, "ccpbkdf2_hmac_batch matches reference");
+    return 1;
+}
+
 int ccpbkdf2_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 {
 	plan_tests(kTestTestCount);
@@ -200,6 +267,11 @@ int ccpbkdf2_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
     ok(test_pbkdf2(ccsha384_di()), "Default ccsha384_di");
     ok(test_pbkdf2(ccsha512_di()), "Default ccsha512_di");
 
+    ok(test_batch(ccsha224_di()), "Batch ccsha224_di");
+    ok(test_batch(ccsha256_di()), "Batch ccsha256_di");
+    ok(test_batch(ccsha384_di()), "Batch ccsha384_di");
+    ok(test_batch(ccsha512_di()), "Batch ccsha512_di");
+
     return 0;
 }
 #endif
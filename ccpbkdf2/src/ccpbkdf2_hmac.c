@@ -14,6 +14,239 @@
 #include <corecrypto/cchmac.h>
 #include <corecrypto/cc.h>
 #include <corecrypto/cc_priv.h>
+#include "ccdigest_internal.h"
+
+/* Size in bytes of the message length in the padding of di, when U_i can be
+   hashed by calling di->compress on a single pre-padded block, or 0 if the
+   padding of di is not known here. */
+static size_t
+pbkdf2_length_nbytes(const struct ccdigest_info *di)
+{
+    size_t nbytes = 0;
+
+    if (di->final == ccdigest_final_64be) {
+        nbytes = 8;
+    } else if (ccdigest_oid_equal(di, CC_DIGEST_OID_SHA384) ||
+               ccdigest_oid_equal(di, CC_DIGEST_OID_SHA512) ||
+               ccdigest_oid_equal(di, CC_DIGEST_OID_SHA512_256)) {
+        nbytes = 16;
+    }
+
+    if (di->output_size + 1 + nbytes > di->block_size) {
+        return 0;
+    }
+    return nbytes;
+}
+
+/* Write the digest in state to block, as 32-bit words for digests with an
+   8-byte message length (SHA-1, SHA-224, SHA-256) and 64-bit words
+   otherwise (SHA-384, SHA-512). */
+static void
+pbkdf2_store_state(const struct ccdigest_info *di, size_t length_nbytes,
+                   cc_unit *state, uint8_t *block)
+{
+    if (length_nbytes == 8) {
+        for (size_t i = 0; i < di->output_size / 4; i++) {
+            CC_STORE32_BE(ccdigest_u32(state)[i], block + 4 * i);
+        }
+    } else {
+        for (size_t i = 0; i < di->output_size / 8; i++) {
+            CC_STORE64_BE(ccdigest_u64(state)[i], block + 8 * i);
+        }
+    }
+}
+
+/* Calculate U2 through UiterationCount from U1 with exactly two calls to
+   di->compress per iteration. The inner and outer HMAC messages both are
+   block_size bytes of key followed by hLen bytes, so U_i is kept in a block
+   padded once for a message of block_size + hLen bytes, and hashed from the
+   saved inner and outer states. */
+static void
+F_compress(const struct ccdigest_info *di,
+           const void *istate,
+           const void *ostate,
+           size_t length_nbytes,
+           size_t iterationCount,
+           const uint8_t *u1,
+           size_t dataLen,
+           void *data)
+{
+    const size_t hLen = di->output_size;
+    uint8_t block[di->block_size];
+    cc_unit state[ccn_nof_size(di->state_size)];
+
+    cc_memset(block, 0, di->block_size);
+    cc_memcpy(block, u1, hLen);
+    block[hLen] = 0x80;
+    CC_STORE64_BE((uint64_t)(di->block_size + hLen) * 8, block + di->block_size - 8);
+
+    for (size_t iteration = 2; iteration <= iterationCount; iteration++)
+    {
+        ccdigest_copy_state(di, state, istate);
+        di->compress((ccdigest_state_t)state, 1, block);
+        pbkdf2_store_state(di, length_nbytes, state, block);
+
+        ccdigest_copy_state(di, state, ostate);
+        di->compress((ccdigest_state_t)state, 1, block);
+        pbkdf2_store_state(di, length_nbytes, state, block);
+
+        cc_xor(dataLen, data, data, block);
+    }
+
+    cc_clear(di->block_size, block);
+    ccn_clear(ccn_nof_size(di->state_size), state);
+}
+
+#if CCSHA2_MULTI_INTRINSICS
+
+/* Largest state of the digests with a multi-lane compression (SHA-512). */
+#define PBKDF2_MULTI_MAX_STATE_SIZE 64
+
+/* One independent PBKDF2 block: T_blockNumber for the password prepared in
+   key, of which the first dataLen bytes are written to data. */
+struct pbkdf2_lane {
+    const struct cchmac_key *key;
+    size_t saltLen;
+    const void *salt;
+    size_t blockNumber;
+    size_t dataLen;
+    uint8_t *data;
+};
+
+static uint64_t
+pbkdf2_load_word(size_t word_size, const uint8_t *p)
+{
+    if (word_size == sizeof(uint32_t)) {
+        uint32_t w;
+        CC_LOAD32_BE(w, p);
+        return w;
+    }
+    uint64_t w;
+    CC_LOAD64_BE(w, p);
+    return w;
+}
+
+/* Word j of a digest state, which holds native 32 or 64-bit words. */
+static uint64_t
+pbkdf2_state_word(size_t word_size, const struct ccdigest_state *state, size_t j)
+{
+    const uint8_t *p = (const uint8_t *)state + j * word_size;
+
+    if (word_size == sizeof(uint32_t)) {
+        uint32_t w;
+        cc_memcpy(&w, p, sizeof(w));
+        return w;
+    }
+    uint64_t w;
+    cc_memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/* Write word i of a transposed state or block. */
+static void
+pbkdf2_set_word(size_t word_size, ccdigest_multi_words *words, size_t i, uint64_t w)
+{
+    if (word_size == sizeof(uint32_t)) {
+        words->u32[i] = (uint32_t)w;
+    } else {
+        words->u64[i] = w;
+    }
+}
+
+static uint64_t
+pbkdf2_get_word(size_t word_size, const ccdigest_multi_words *words, size_t i)
+{
+    return (word_size == sizeof(uint32_t)) ? words->u32[i] : words->u64[i];
+}
+
+/* Compute n <= mi->nlanes blocks of PBKDF2 at once. U1 is computed for each
+   lane with HMAC, then U2 through UiterationCount with the same two compress
+   calls per iteration as F_compress, in SIMD lanes with the states and
+   blocks transposed. Lanes past n repeat the first one. */
+static void
+F_multi(const struct ccdigest_info *di,
+        const struct ccdigest_multi_info *mi,
+        size_t n,
+        const struct pbkdf2_lane *lanes,
+        size_t iterationCount)
+{
+    const size_t nlanes = mi->nlanes;
+    const size_t ws = mi->word_size;
+    const size_t hLen = di->output_size;
+    const size_t hw = hLen / ws;
+    const size_t ntransposed = nlanes * ws;
+    uint8_t u1[CCDIGEST_MULTI_MAX_NLANES][PBKDF2_MULTI_MAX_STATE_SIZE];
+    uint8_t block[di->block_size];
+    ccdigest_multi_words istate, ostate, state, words, acc;
+    uint32_t bn;
+
+    cchmac_di_decl(di, hc);
+    for (size_t l = 0; l < n; l++) {
+        cchmac_init_prepared(di, hc, lanes[l].key);
+        cchmac_update(di, hc, lanes[l].saltLen, lanes[l].salt);
+        CC_STORE32_BE((uint32_t)lanes[l].blockNumber, &bn);
+        cchmac_update(di, hc, 4, &bn);
+        cchmac_final(di, hc, u1[l]);
+    }
+    cchmac_di_clear(di, hc);
+
+    /* The words of U are followed by the same padding in every lane. */
+    cc_memset(block, 0, di->block_size);
+    block[hLen] = 0x80;
+    CC_STORE64_BE((uint64_t)(di->block_size + hLen) * 8, block + di->block_size - 8);
+
+    for (size_t i = 0; i < nlanes; i++) {
+        size_t l = (i < n) ? i : 0;
+        const struct cchmac_key *key = lanes[l].key;
+
+        for (size_t t = 0; t < 16; t++) {
+            const uint8_t *p = (t < hw) ? &u1[l][t * ws] : &block[t * ws];
+            pbkdf2_set_word(ws, &words, t * nlanes + i, pbkdf2_load_word(ws, p));
+        }
+        for (size_t j = 0; j < 8; j++) {
+            pbkdf2_set_word(ws, &istate, j * nlanes + i, pbkdf2_state_word(ws, cchmac_key_const_istate(di, key), j));
+            pbkdf2_set_word(ws, &ostate, j * nlanes + i, pbkdf2_state_word(ws, cchmac_key_const_ostate(di, key), j));
+        }
+    }
+
+    cc_memcpy(&acc, &words, hw * ntransposed);
+
+    for (size_t iteration = 2; iteration <= iterationCount; iteration++)
+    {
+        cc_memcpy(&state, &istate, 8 * ntransposed);
+        mi->compress_words(&state, &words);
+        cc_memcpy(&words, &state, hw * ntransposed);
+
+        cc_memcpy(&state, &ostate, 8 * ntransposed);
+        mi->compress_words(&state, &words);
+        cc_memcpy(&words, &state, hw * ntransposed);
+
+        for (size_t k = 0; k < hw * ntransposed / sizeof(uint64_t); k++) {
+            acc.u64[k] ^= words.u64[k];
+        }
+    }
+
+    for (size_t l = 0; l < n; l++) {
+        for (size_t t = 0; t < hw; t++) {
+            if (ws == sizeof(uint32_t)) {
+                CC_STORE32_BE((uint32_t)pbkdf2_get_word(ws, &acc, t * nlanes + l), &u1[l][t * ws]);
+            } else {
+                CC_STORE64_BE(pbkdf2_get_word(ws, &acc, t * nlanes + l), &u1[l][t * ws]);
+            }
+        }
+        cc_memcpy(lanes[l].data, u1[l], lanes[l].dataLen);
+    }
+
+    cc_clear(sizeof(u1), u1);
+    cc_clear(8 * ntransposed, &istate);
+    cc_clear(8 * ntransposed, &ostate);
+    cc_clear(8 * ntransposed, &state);
+    cc_clear(16 * ntransposed, &words);
+    cc_clear(hw * ntransposed, &acc);
+}
+
+#endif // CCSHA2_MULTI_INTRINSICS
+
 /* Will write hLen bytes into dataPtr according to PKCS #5 2.0 spec.
    See: ../docs/pkcs5v2_1.pdf for details (cached copy of RSA's PKCS5v2)
 */
@@ -44,6 +277,13 @@ F (const struct ccdigest_info *di,
 
 	cc_memcpy(data, inBlock, dataLen);
 
+    size_t length_nbytes = pbkdf2_length_nbytes(di);
+    if (length_nbytes) {
+        F_compress(di, istate, cchmac_ostate32(di, hc), length_nbytes,
+                   iterationCount, inBlock, dataLen, data);
+        return;
+    }
+
     /* Calculate U2 though UiterationCount. */
 	for (size_t iteration = 2; iteration <= iterationCount; iteration++)
 	{
@@ -88,6 +328,33 @@ int ccpbkdf2_hmac(const struct ccdigest_info *di,
 	/* First calculate all the complete hLen sized blocks required. */
 	size_t blockNumber = 1;
 	uint8_t *dataPtr = dk;
+
+#if CCSHA2_MULTI_INTRINSICS
+    /* Blocks are independent, so compute them in SIMD lanes while enough
+       are left to make it worthwhile. */
+    const struct ccdigest_multi_info *mi = ccdigest_multi_info(di);
+    size_t nblocks = completeBlocks + (partialBlock_nbytes > 0);
+
+    if (mi && pbkdf2_length_nbytes(di) && nblocks - blockNumber + 1 >= mi->min_nlanes) {
+        cchmac_key_decl(PBKDF2_MULTI_MAX_STATE_SIZE, key);
+        struct pbkdf2_lane lanes[CCDIGEST_MULTI_MAX_NLANES];
+
+        cchmac_key_prepare(di, key, passwordLen, password);
+        while (nblocks - blockNumber + 1 >= mi->min_nlanes) {
+            size_t n = CC_MIN(nblocks - blockNumber + 1, mi->nlanes);
+            for (size_t l = 0; l < n; l++, blockNumber++, dataPtr += hLen) {
+                lanes[l].key = key;
+                lanes[l].saltLen = saltLen;
+                lanes[l].salt = salt;
+                lanes[l].blockNumber = blockNumber;
+                lanes[l].dataLen = (blockNumber <= completeBlocks) ? hLen : partialBlock_nbytes;
+                lanes[l].data = dataPtr;
+            }
+            F_multi(di, mi, n, lanes, iterations);
+        }
+        cchmac_key_clear(PBKDF2_MULTI_MAX_STATE_SIZE, key);
+    }
+#endif
 	
 	// For FIPS the output needs to be concatenated not just xor'd
 	for (; blockNumber <= completeBlocks; blockNumber++, dataPtr += hLen)
@@ -98,7 +365,7 @@ int ccpbkdf2_hmac(const struct ccdigest_info *di,
     /* Finally if the requested output size was not an even multiple of hLen,
        calculate the final block and copy the first partialBlock_nbytes bytes of
        it to the output. */
-	if (partialBlock_nbytes > 0)
+	if (partialBlock_nbytes > 0 && blockNumber == completeBlocks + 1)
 	{
 		F (di, hc, istate, saltLen, salt, iterations, blockNumber, partialBlock_nbytes, dataPtr);
 	}
@@ -107,3 +374,60 @@ int ccpbkdf2_hmac(const struct ccdigest_info *di,
 	ccn_clear(ccn_nof_size(di->state_size), istate);
 	return 0;
 }
+
+int ccpbkdf2_hmac_batch(const struct ccdigest_info *di,
+                        size_t n,
+                        const size_t *passwordLens, const void *const *passwords,
+                        const size_t *saltLens, const void *const *salts,
+                        size_t iterations,
+                        size_t dkLen, void *const *dks)
+{
+	if ((dkLen / di->output_size) > UINT32_MAX)
+	{
+		return -1;
+	}
+
+    size_t i = 0;
+
+#if CCSHA2_MULTI_INTRINSICS
+    const struct ccdigest_multi_info *mi = ccdigest_multi_info(di);
+
+    if (mi && pbkdf2_length_nbytes(di)) {
+        const size_t hLen = di->output_size;
+        cc_unit keys[CCDIGEST_MULTI_MAX_NLANES][ccn_nof_size(cchmac_key_size(PBKDF2_MULTI_MAX_STATE_SIZE))];
+        struct pbkdf2_lane lanes[CCDIGEST_MULTI_MAX_NLANES];
+
+        /* One password per lane, for each output block in turn. */
+        for (; n - i >= mi->min_nlanes; i += CC_MIN(n - i, mi->nlanes)) {
+            size_t nlanes = CC_MIN(n - i, mi->nlanes);
+
+            for (size_t l = 0; l < nlanes; l++) {
+                cchmac_key_prepare(di, (cchmac_key_t)keys[l], passwordLens[i + l], passwords[i + l]);
+            }
+
+            for (size_t offset = 0, blockNumber = 1; offset < dkLen; offset += hLen, blockNumber++) {
+                for (size_t l = 0; l < nlanes; l++) {
+                    lanes[l].key = (const struct cchmac_key *)keys[l];
+                    lanes[l].saltLen = saltLens[i + l];
+                    lanes[l].salt = salts[i + l];
+                    lanes[l].blockNumber = blockNumber;
+                    lanes[l].dataLen = CC_MIN(dkLen - offset, hLen);
+                    lanes[l].data = (uint8_t *)dks[i + l] + offset;
+                }
+                F_multi(di, mi, nlanes, lanes, iterations);
+            }
+        }
+
+        cc_clear(sizeof(keys), keys);
+    }
+#endif
+
+    for (; i < n; i++) {
+        int rv = ccpbkdf2_hmac(di, passwordLens[i], passwords[i], saltLens[i], salts[i], iterations, dkLen, dks[i]);
+        if (rv) {
+            return rv;
+        }
+    }
+
+	return 0;
+}
@@ -59,4 +59,49 @@ ccscrypt(size_t password_len, const uint8_t *password, size_t salt_len,
 int64_t
 ccscrypt_storage_size(uint64_t N, uint32_t r, uint32_t p);
 
+/*! @function ccscrypt_parallel
+ @abstract perform scrypt using parameters N, r, and p, mixing the p blocks on several threads.
+ @discussion Produces the same derived key as ccscrypt(). |buffer| MUST be allocated space of size at least
+  equal to ccscrypt_parallel_storage_size(N, r, p, nthreads), since every thread needs its own scratch space
+  of about 128 * r * N bytes. This memory is cleared upon completion of the computation.
+
+  At most p threads are used. On platforms without threads, the computation runs on the calling thread
+  and needs the same storage as ccscrypt().
+
+ @param password_len Length of the password
+ @param password     Password to hash
+ @param salt_len     Length of per-invocation salt
+ @param salt         Per-invocation salt
+ @param storage      Temporary storage to be used by the scrypt computation
+ @param N            CPU/memory cost parameter
+ @param r            Scrypt block size parameter
+ @param p            Parallelization parameter
+ @param dk_len       Length of the derived key
+ @param dk           Output buffer for the derived key, which must be at least |dk_len| bytes long, yet no
+                     longer than (2^32 - 1) * 32.
+ @param nthreads     Maximum number of threads to use, including the calling thread
+
+ @return 0 on success, non-zero on failure. See cc_error.h for more details.
+ */
+int
+ccscrypt_parallel(size_t password_len, const uint8_t *password, size_t salt_len,
+                  const uint8_t *salt, uint8_t *storage, uint64_t N, uint32_t r,
+                  uint32_t p, size_t dk_len, uint8_t *dk, size_t nthreads);
+
+/*! @function ccscrypt_parallel_storage_size
+ @abstract Compute the amount of temporary memory needed by ccscrypt_parallel() to compute scrypt(N, r, p)
+  on up to nthreads threads.
+ @discussion The parameters are constrained as for ccscrypt_storage_size(). With nthreads = 1 the result
+ equals ccscrypt_storage_size(N, r, p).
+
+ @param N            CPU/memory cost parameter
+ @param r            Scrypt block size parameter
+ @param p            Parallelization parameter
+ @param nthreads     Maximum number of threads to use, including the calling thread
+
+ @return The storage size if the parameters are valid, negative on failure.
+ */
+int64_t
+ccscrypt_parallel_storage_size(uint64_t N, uint32_t r, uint32_t p, size_t nthreads);
+
 #endif /* _CORECRYPTO_CCSCRYPT_H_ */
@@ -12,6 +12,8 @@
 #ifndef ccscrypt_internal_h
 #define ccscrypt_internal_h
 
+#include <corecrypto/cc_config.h>
+
 /*! @function ccscrypt_valid_parameters
  @abstract Determine if scrypt parameters (N, r, p) are valid.
 
@@ -52,4 +54,14 @@ void ccscrypt_blockmix_salsa8(uint8_t *B, uint8_t *Y, size_t r);
  */
 void ccscrypt_romix(size_t r, uint8_t *B, size_t N, uint8_t *T, uint8_t *X, uint8_t *Y);
 
+#if CCSCRYPT_SSE2_INTRINSICS
+/*! @function ccscrypt_romix_sse2
+ @abstract scryptROMix with SSE2, called by ccscrypt_romix().
+ @discussion Same arguments and result as ccscrypt_romix(). X, Y and T hold blocks
+ with the words of each 64-byte Salsa20 block stored along its diagonals, so that
+ B is only reordered on entry and exit.
+ */
+void ccscrypt_romix_sse2(size_t r, uint8_t *B, size_t N, uint8_t *T, uint8_t *X, uint8_t *Y);
+#endif
+
 #endif /* ccscrypt_internal_h */
@@ -156,6 +156,38 @@ test_ccscrypt(void)
     }
 }
 
+static void
+test_ccscrypt_parallel(void)
+{
+    // The p = 16 vector, with lanes split evenly, unevenly, and one per thread.
+    const test_ccscrypt_vector test = test_ccscrypt_vectors[1];
+    const size_t nthreads[] = { 2, 3, 16 };
+
+    byteBuffer expected = hexStringToBytes((char *)test.dk);
+    uint8_t actual[test.dk_len];
+
+    size_t password_len = strlen((char *)test.password);
+    size_t salt_len = strlen((char *)test.salt);
+
+    is(ccscrypt_parallel_storage_size(test.N, test.r, test.p, 1), ccscrypt_storage_size(test.N, test.r, test.p),
+       "ccscrypt_parallel_storage_size with one thread differs from ccscrypt_storage_size");
+
+    for (size_t i = 0; i < CC_ARRAY_LEN(nthreads); i++) {
+        int64_t buffer_size = ccscrypt_parallel_storage_size(test.N, test.r, test.p, nthreads[i]);
+        uint8_t *buffer = (uint8_t *)malloc((size_t)buffer_size);
+        memset(buffer, 0, (size_t)buffer_size);
+
+        memset(actual, 0, sizeof(actual));
+        ccscrypt_parallel(password_len, test.password, salt_len, test.salt, buffer, test.N, test.r, test.p,
+                          test.dk_len, actual, nthreads[i]);
+        free(buffer);
+
+        is(cc_cmp_safe(test.dk_len, actual, expected->bytes), 0, "test_ccscrypt_parallel with %zu threads failed", nthreads[i]);
+    }
+
+    free(expected);
+}
+
 static void
 test_ccscrypt_valid_parameters(void)
 {
@@ -179,12 +211,13 @@ test_ccscrypt_valid_parameters(void)
 
 int ccscrypt_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 {
-    plan_tests(7 + test_ccscrypt_vectors_len);
+    plan_tests(11 + test_ccscrypt_vectors_len);
 
     test_ccscrypt_salsa20_8();
     test_ccscrypt_blockmix_salsa8();
     test_ccscrypt_romix();
     test_ccscrypt();
+    test_ccscrypt_parallel();
     test_ccscrypt_valid_parameters();
 
     return 0;
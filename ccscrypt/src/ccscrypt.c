@@ -16,6 +16,12 @@
 
 #include "ccscrypt_internal.h"
 
+#if CC_PTHREADS
+#include <pthread.h>
+#endif
+
+#define CCSCRYPT_PARALLEL_MAX_NTHREADS 64
+
 static void
 ccscrypt_block_xor(uint8_t *Z, uint8_t *X, uint8_t *Y, size_t length)
 {
@@ -24,6 +30,7 @@ ccscrypt_block_xor(uint8_t *Z, uint8_t *X, uint8_t *Y, size_t length)
     }
 }
 
+#if !CCSCRYPT_SSE2_INTRINSICS
 static uint64_t
 ccscrypt_integerify(uint8_t *B, size_t r, size_t N)
 {
@@ -33,6 +40,7 @@ ccscrypt_integerify(uint8_t *B, size_t r, size_t N)
         | (uint64_t)X[4] << 32 | (uint64_t)X[5] << 40 | (uint64_t)X[6] << 48 | (uint64_t)X[7] << 56;
     return j & (N - 1);
 }
+#endif
 
 void
 ccscrypt_salsa20_8(uint8_t *in_buffer, uint8_t *out_buffer)
@@ -106,6 +114,9 @@ ccscrypt_blockmix_salsa8(uint8_t *B, uint8_t *Y, size_t r)
 void
 ccscrypt_romix(size_t r, uint8_t *B, size_t N, uint8_t *T, uint8_t *X, uint8_t *Y)
 {
+#if CCSCRYPT_SSE2_INTRINSICS
+    ccscrypt_romix_sse2(r, B, N, T, X, Y);
+#else
     cc_memcpy(X, B, 128 * r);
 
     for (size_t i = 0; i < N; i++) {
@@ -120,6 +131,7 @@ ccscrypt_romix(size_t r, uint8_t *B, size_t N, uint8_t *T, uint8_t *X, uint8_t *
     }
 
     cc_memcpy(B, X, 128 * r);
+#endif
 }
 
 int
@@ -146,14 +158,31 @@ ccscrypt_valid_parameters(uint64_t N, uint32_t r, uint32_t p)
     return CCERR_OK;
 }
 
+// Number of threads ccscrypt_parallel() runs for p lanes, including the
+// calling thread.
+static size_t
+ccscrypt_parallel_nthreads(uint32_t p, size_t nthreads)
+{
+#if CC_PTHREADS
+    nthreads = CC_MIN(nthreads, CCSCRYPT_PARALLEL_MAX_NTHREADS);
+    nthreads = CC_MIN(nthreads, (size_t)p);
+    return nthreads > 0 ? nthreads : 1;
+#else
+    (void)p;
+    (void)nthreads;
+    return 1;
+#endif
+}
+
 int64_t
-ccscrypt_storage_size(uint64_t N, uint32_t r, uint32_t p)
+ccscrypt_parallel_storage_size(uint64_t N, uint32_t r, uint32_t p, size_t nthreads)
 {
     int valid = ccscrypt_valid_parameters(N, r, p);
     if (valid != CCERR_OK) {
         return valid;
     }
 
+    // B is shared, and each thread has its own X, Y and T.
     int64_t x, y, z, result;
     bool overflow = false;
 
@@ -162,8 +191,9 @@ ccscrypt_storage_size(uint64_t N, uint32_t r, uint32_t p)
     overflow |= cc_mul_overflow(256, r, &y);
     overflow |= cc_mul_overflow(128, r, &z);
     overflow |= cc_mul_overflow(N, z, &z);
-    overflow |= cc_add_overflow(x, y, &result);
-    overflow |= cc_add_overflow(z, result, &result);
+    overflow |= cc_add_overflow(y, z, &z);
+    overflow |= cc_mul_overflow(ccscrypt_parallel_nthreads(p, nthreads), z, &z);
+    overflow |= cc_add_overflow(x, z, &result);
 
     if (overflow) {
         return CCERR_OVERFLOW;
@@ -172,13 +202,44 @@ ccscrypt_storage_size(uint64_t N, uint32_t r, uint32_t p)
     return result;
 }
 
+int64_t
+ccscrypt_storage_size(uint64_t N, uint32_t r, uint32_t p)
+{
+    return ccscrypt_parallel_storage_size(N, r, p, 1);
+}
+
+// The lanes first, first + stride, ... of B, mixed with one scratch area.
+struct ccscrypt_parallel_worker {
+    size_t r;
+    size_t N;
+    size_t p;
+    size_t first;
+    size_t stride;
+    uint8_t *B;
+    uint8_t *T;
+    uint8_t *X;
+    uint8_t *Y;
+};
+
+static void *
+ccscrypt_parallel_romix(void *arg)
+{
+    struct ccscrypt_parallel_worker *w = arg;
+
+    for (size_t i = w->first; i < w->p; i += w->stride) {
+        ccscrypt_romix(w->r, &w->B[i * 128 * w->r], w->N, w->T, w->X, w->Y);
+    }
+    return NULL;
+}
+
 int
-ccscrypt(size_t password_len, const uint8_t *password, size_t salt_len, const uint8_t *salt,
-         uint8_t *storage, uint64_t N_in, uint32_t r_in, uint32_t p_in, size_t dk_len, uint8_t *dk)
+ccscrypt_parallel(size_t password_len, const uint8_t *password, size_t salt_len, const uint8_t *salt,
+                  uint8_t *storage, uint64_t N_in, uint32_t r_in, uint32_t p_in, size_t dk_len, uint8_t *dk,
+                  size_t nthreads)
 {
     cc_assert(storage);
 
-    int64_t total_size = ccscrypt_storage_size(N_in, r_in, p_in);
+    int64_t total_size = ccscrypt_parallel_storage_size(N_in, r_in, p_in, nthreads);
     if (total_size < 0) {
         // This will either be CCERR_PARAMETER or CCERR_OVERFLOW.
         return (int)total_size;
@@ -194,19 +255,52 @@ ccscrypt(size_t password_len, const uint8_t *password, size_t salt_len, const ui
     size_t B_len = 128 * r * p;
     size_t X_len = 128 * r;
     size_t Y_len = 128 * r;
+    size_t T_len = 128 * r * N;
 
     uint8_t *B = storage;
-    uint8_t *X = &storage[B_len];
-    uint8_t *Y = &storage[B_len + X_len];
-    uint8_t *T = &storage[B_len + X_len + Y_len];
 
     if (0 != ccpbkdf2_hmac(ccsha256_di(), password_len, password, salt_len, salt, 1, B_len, B)) {
         return CCERR_INTERNAL;
     }
 
-    for (size_t i = 0; i < p; i++) {
-        ccscrypt_romix(r, &B[i * 128 * r], N, T, X, Y);
+    struct ccscrypt_parallel_worker workers[CCSCRYPT_PARALLEL_MAX_NTHREADS];
+    nthreads = ccscrypt_parallel_nthreads(p_in, nthreads);
+
+    for (size_t i = 0; i < nthreads; i++) {
+        uint8_t *scratch = &storage[B_len + i * (X_len + Y_len + T_len)];
+        workers[i] = (struct ccscrypt_parallel_worker){
+            .r = r,
+            .N = N,
+            .p = p,
+            .first = i,
+            .stride = nthreads,
+            .B = B,
+            .X = scratch,
+            .Y = &scratch[X_len],
+            .T = &scratch[X_len + Y_len],
+        };
+    }
+
+#if CC_PTHREADS
+    // The calling thread takes the first lanes. Lanes whose thread could
+    // not be started are run here as well.
+    pthread_t threads[CCSCRYPT_PARALLEL_MAX_NTHREADS];
+    bool started[CCSCRYPT_PARALLEL_MAX_NTHREADS];
+
+    for (size_t i = 1; i < nthreads; i++) {
+        started[i] = pthread_create(&threads[i], NULL, ccscrypt_parallel_romix, &workers[i]) == 0;
     }
+    ccscrypt_parallel_romix(&workers[0]);
+    for (size_t i = 1; i < nthreads; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            ccscrypt_parallel_romix(&workers[i]);
+        }
+    }
+#else
+    ccscrypt_parallel_romix(&workers[0]);
+#endif
 
     if (0 != ccpbkdf2_hmac(ccsha256_di(), password_len, password, B_len, B, 1, dk_len, dk)) {
         return CCERR_INTERNAL;
@@ -216,3 +310,10 @@ ccscrypt(size_t password_len, const uint8_t *password, size_t salt_len, const ui
 
     return 0;
 }
+
+int
+ccscrypt(size_t password_len, const uint8_t *password, size_t salt_len, const uint8_t *salt,
+         uint8_t *storage, uint64_t N_in, uint32_t r_in, uint32_t p_in, size_t dk_len, uint8_t *dk)
+{
+    return ccscrypt_parallel(password_len, password, salt_len, salt, storage, N_in, r_in, p_in, dk_len, dk, 1);
+}
@@ -0,0 +1,170 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include <corecrypto/cc.h>
+#include <corecrypto/cc_priv.h>
+#include "ccscrypt_internal.h"
+
+#if CCSCRYPT_SSE2_INTRINSICS
+
+#include <emmintrin.h>
+
+/* Each 64-byte block is held as four vectors along the diagonals of the
+ * Salsa20 state: row k holds words 5i + 4k mod 16 for i = 0..3, i.e.
+ *
+ *   x[0] = (0, 5, 10, 15), x[1] = (4, 9, 14, 3),
+ *   x[2] = (8, 13, 2, 7),  x[3] = (12, 1, 6, 11).
+ *
+ * The column quarter rounds then work on whole vectors, and the row
+ * quarter rounds only need the vectors rotated by one word. */
+
+#define CCSCRYPT_SSE2_BLOCK_NVECS 4
+
+/* Position of Salsa20 word w in a block in the diagonal layout. */
+#define CCSCRYPT_SSE2_POS(w) ((13 * (w)) & 15)
+
+#define CCSCRYPT_SSE2_ROTXOR(x, t, n) \
+    x = _mm_xor_si128(x, _mm_xor_si128(_mm_slli_epi32(t, n), _mm_srli_epi32(t, 32 - (n))))
+
+/* x = Salsa20/8(x) + x. */
+CC_INLINE void ccscrypt_salsa20_8_sse2(__m128i x[4])
+{
+    __m128i x0 = x[0], x1 = x[1], x2 = x[2], x3 = x[3], t;
+
+    for (int i = 0; i < 8; i += 2) {
+        // Columns.
+        t = _mm_add_epi32(x0, x3);
+        CCSCRYPT_SSE2_ROTXOR(x1, t, 7);
+        t = _mm_add_epi32(x1, x0);
+        CCSCRYPT_SSE2_ROTXOR(x2, t, 9);
+        t = _mm_add_epi32(x2, x1);
+        CCSCRYPT_SSE2_ROTXOR(x3, t, 13);
+        t = _mm_add_epi32(x3, x2);
+        CCSCRYPT_SSE2_ROTXOR(x0, t, 18);
+
+        x1 = _mm_shuffle_epi32(x1, 0x93);
+        x2 = _mm_shuffle_epi32(x2, 0x4e);
+        x3 = _mm_shuffle_epi32(x3, 0x39);
+
+        // Rows.
+        t = _mm_add_epi32(x0, x1);
+        CCSCRYPT_SSE2_ROTXOR(x3, t, 7);
+        t = _mm_add_epi32(x3, x0);
+        CCSCRYPT_SSE2_ROTXOR(x2, t, 9);
+        t = _mm_add_epi32(x2, x3);
+        CCSCRYPT_SSE2_ROTXOR(x1, t, 13);
+        t = _mm_add_epi32(x1, x2);
+        CCSCRYPT_SSE2_ROTXOR(x0, t, 18);
+
+        x1 = _mm_shuffle_epi32(x1, 0x39);
+        x2 = _mm_shuffle_epi32(x2, 0x4e);
+        x3 = _mm_shuffle_epi32(x3, 0x93);
+    }
+
+    x[0] = _mm_add_epi32(x[0], x0);
+    x[1] = _mm_add_epi32(x[1], x1);
+    x[2] = _mm_add_epi32(x[2], x2);
+    x[3] = _mm_add_epi32(x[3], x3);
+}
+
+CC_INLINE void ccscrypt_sse2_load(__m128i x[4], const uint8_t *in)
+{
+    for (int k = 0; k < CCSCRYPT_SSE2_BLOCK_NVECS; k++) {
+        x[k] = _mm_loadu_si128((const __m128i *)(const void *)&in[16 * k]);
+    }
+}
+
+CC_INLINE void ccscrypt_sse2_xor(__m128i x[4], const uint8_t *in)
+{
+    for (int k = 0; k < CCSCRYPT_SSE2_BLOCK_NVECS; k++) {
+        x[k] = _mm_xor_si128(x[k], _mm_loadu_si128((const __m128i *)(const void *)&in[16 * k]));
+    }
+}
+
+CC_INLINE void ccscrypt_sse2_store(uint8_t *out, const __m128i x[4])
+{
+    for (int k = 0; k < CCSCRYPT_SSE2_BLOCK_NVECS; k++) {
+        _mm_storeu_si128((__m128i *)(void *)&out[16 * k], x[k]);
+    }
+}
+
+/* scryptBlockMix of in, or of in ^ V when V is not NULL, into out. The
+ * even blocks go to the first half of out and the odd blocks to the
+ * second, so no copy is needed afterwards. in and out must not overlap. */
+CC_INLINE void ccscrypt_blockmix_sse2(const uint8_t *in, const uint8_t *V, uint8_t *out, size_t r)
+{
+    __m128i x[4];
+
+    ccscrypt_sse2_load(x, &in[(2 * r - 1) * 64]);
+    if (V) {
+        ccscrypt_sse2_xor(x, &V[(2 * r - 1) * 64]);
+    }
+
+    for (size_t i = 0; i < 2 * r; i++) {
+        ccscrypt_sse2_xor(x, &in[i * 64]);
+        if (V) {
+            ccscrypt_sse2_xor(x, &V[i * 64]);
+        }
+        ccscrypt_salsa20_8_sse2(x);
+        ccscrypt_sse2_store(&out[((i & 1) * r + i / 2) * 64], x);
+    }
+}
+
+/* Integerify(X) mod N. Words 0 and 1 of the last block are its low 64 bits. */
+static uint64_t ccscrypt_integerify_sse2(const uint8_t *X, size_t r, size_t N)
+{
+    const uint8_t *last = &X[(2 * r - 1) * 64];
+    uint32_t lo, hi;
+
+    cc_memcpy(&lo, &last[4 * CCSCRYPT_SSE2_POS(0)], sizeof(lo));
+    cc_memcpy(&hi, &last[4 * CCSCRYPT_SSE2_POS(1)], sizeof(hi));
+    return (((uint64_t)hi << 32) | lo) & (N - 1);
+}
+
+void ccscrypt_romix_sse2(size_t r, uint8_t *B, size_t N, uint8_t *T, uint8_t *X, uint8_t *Y)
+{
+    const size_t block_len = 128 * r;
+    uint32_t w;
+
+    // Move B to the diagonal layout.
+    for (size_t i = 0; i < 2 * r; i++) {
+        for (size_t k = 0; k < 16; k++) {
+            CC_LOAD32_LE(w, &B[i * 64 + 4 * k]);
+            cc_memcpy(&X[i * 64 + 4 * CCSCRYPT_SSE2_POS(k)], &w, sizeof(w));
+        }
+    }
+
+    // V_i is BlockMix(V_i-1), written straight into T.
+    cc_memcpy(T, X, block_len);
+    for (size_t i = 1; i < N; i++) {
+        ccscrypt_blockmix_sse2(&T[(i - 1) * block_len], NULL, &T[i * block_len], r);
+    }
+    ccscrypt_blockmix_sse2(&T[(N - 1) * block_len], NULL, X, r);
+
+    // BlockMix(X ^ V_j) goes from X to Y, and the two are then swapped.
+    for (size_t i = 0; i < N; i++) {
+        uint8_t *t = X;
+        uint64_t j = ccscrypt_integerify_sse2(X, r, N);
+        ccscrypt_blockmix_sse2(X, &T[j * block_len], Y, r);
+        X = Y;
+        Y = t;
+    }
+
+    for (size_t i = 0; i < 2 * r; i++) {
+        for (size_t k = 0; k < 16; k++) {
+            cc_memcpy(&w, &X[i * 64 + 4 * CCSCRYPT_SSE2_POS(k)], sizeof(w));
+            CC_STORE32_LE(w, &B[i * 64 + 4 * k]);
+        }
+    }
+}
+
+#endif /* CCSCRYPT_SSE2_INTRINSICS */
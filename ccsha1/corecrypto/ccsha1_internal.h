@@ -25,4 +25,16 @@ extern const struct ccdigest_info ccsha1_vng_intel_x86_64_di;   // use Accelerat
 #endif
 #endif
 
+#if CCSHA_SHANI_INTRINSICS
+// SHA-NI implementation through compiler intrinsics. Only use when CC_HAS_SHA_NI().
+void ccsha1_shani_compress(ccdigest_state_t state, size_t nblocks, const void *in);
+extern const struct ccdigest_info ccsha1_shani_di;
+#endif
+
+#if CCSHA_AVX2_INTRINSICS
+// AVX2 message schedule with scalar rounds, through compiler intrinsics. Only use when CC_HAS_AVX2().
+void ccsha1_avx2_compress(ccdigest_state_t state, size_t nblocks, const void *in);
+extern const struct ccdigest_info ccsha1_avx2_di;
+#endif
+
 #endif /* _CORECRYPTO_CCSHA1_INTERNAL_H_ */
@@ -0,0 +1,173 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/ccsha1.h>
+#include "ccsha1_internal.h"
+#include <corecrypto/ccdigest_priv.h>
+#include "ccdigest_internal.h"
+#include <corecrypto/cc_priv.h>
+
+#if CCSHA_AVX2_INTRINSICS
+
+#include <immintrin.h>
+
+/* The message schedule of two consecutive blocks is computed together, one
+ block per 128-bit lane, four words at a time, and stored with the round
+ constants added. The rounds themselves are scalar. */
+
+#define CCSHA1_AVX2_TARGET __attribute__((target("avx2")))
+
+CC_INLINE CCSHA1_AVX2_TARGET
+__m256i ccsha1_avx2_rol(__m256i x, int n)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
+}
+
+/* W[t..t+3] from w0 = W[t-16..t-13], w1 = W[t-12..t-9], w2 = W[t-8..t-5] and
+ w3 = W[t-4..t-1]. W[t+3] depends on W[t]: it is first computed with zero
+ in place of W[t], which is then folded in, rotated once more. */
+CC_INLINE CCSHA1_AVX2_TARGET
+__m256i ccsha1_avx2_schedule(__m256i w0, __m256i w1, __m256i w2, __m256i w3)
+{
+    __m256i t, w;
+
+    t = _mm256_xor_si256(w0, _mm256_alignr_epi8(w1, w0, 8));
+    t = _mm256_xor_si256(t, w2);
+    t = _mm256_xor_si256(t, _mm256_srli_si256(w3, 4));
+
+    w = ccsha1_avx2_rol(t, 1);
+    return _mm256_xor_si256(w, ccsha1_avx2_rol(_mm256_slli_si256(t, 12), 2));
+}
+
+CC_INLINE CCSHA1_AVX2_TARGET
+void ccsha1_avx2_store(uint32_t wk0[80], uint32_t wk1[80], size_t i, __m256i w)
+{
+    static const uint32_t K[4] = { 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6 };
+
+    w = _mm256_add_epi32(w, _mm256_set1_epi32((int)K[i / 20]));
+    _mm_storeu_si128((__m128i *)&wk0[i], _mm256_castsi256_si128(w));
+    _mm_storeu_si128((__m128i *)&wk1[i], _mm256_extracti128_si256(w, 1));
+}
+
+/* W[i] + K[i / 20] for the blocks at p0 and p1. */
+static CCSHA1_AVX2_TARGET
+void ccsha1_avx2_wk(uint32_t wk0[80], uint32_t wk1[80], const uint8_t *p0, const uint8_t *p1)
+{
+    const __m256i bswap = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                            0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m256i w[4];
+
+    for (unsigned j = 0; j < 4; j++) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(p0 + 16 * j));
+        __m128i b = _mm_loadu_si128((const __m128i *)(p1 + 16 * j));
+        w[j] = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1), bswap);
+        ccsha1_avx2_store(wk0, wk1, 4 * j, w[j]);
+    }
+
+    for (size_t i = 16; i < 80; i += 4) {
+        __m256i t = ccsha1_avx2_schedule(w[0], w[1], w[2], w[3]);
+        w[0] = w[1];
+        w[1] = w[2];
+        w[2] = w[3];
+        w[3] = t;
+        ccsha1_avx2_store(wk0, wk1, i, t);
+    }
+}
+
+#define F0(x,y,z)  (z ^ (x & (y ^ z)))
+#define F1(x,y,z)  (x ^ y ^ z)
+#define F2(x,y,z)  ((x & y) | (z & (x | y)))
+#define F3(x,y,z)  (x ^ y ^ z)
+
+#define FF0(a,b,c,d,e,i) e = (CC_ROLc(a, 5) + F0(b,c,d) + e + wk[i]); b = CC_ROLc(b, 30);
+#define FF1(a,b,c,d,e,i) e = (CC_ROLc(a, 5) + F1(b,c,d) + e + wk[i]); b = CC_ROLc(b, 30);
+#define FF2(a,b,c,d,e,i) e = (CC_ROLc(a, 5) + F2(b,c,d) + e + wk[i]); b = CC_ROLc(b, 30);
+#define FF3(a,b,c,d,e,i) e = (CC_ROLc(a, 5) + F3(b,c,d) + e + wk[i]); b = CC_ROLc(b, 30);
+
+static void ccsha1_avx2_rounds(uint32_t *s, const uint32_t wk[80])
+{
+    uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4];
+    unsigned i;
+
+    for (i = 0; i < 20; ) {
+        FF0(a,b,c,d,e,i++);
+        FF0(e,a,b,c,d,i++);
+        FF0(d,e,a,b,c,i++);
+        FF0(c,d,e,a,b,i++);
+        FF0(b,c,d,e,a,i++);
+    }
+
+    for (; i < 40; ) {
+        FF1(a,b,c,d,e,i++);
+        FF1(e,a,b,c,d,i++);
+        FF1(d,e,a,b,c,i++);
+        FF1(c,d,e,a,b,i++);
+        FF1(b,c,d,e,a,i++);
+    }
+
+    for (; i < 60; ) {
+        FF2(a,b,c,d,e,i++);
+        FF2(e,a,b,c,d,i++);
+        FF2(d,e,a,b,c,i++);
+        FF2(c,d,e,a,b,i++);
+        FF2(b,c,d,e,a,i++);
+    }
+
+    for (; i < 80; ) {
+        FF3(a,b,c,d,e,i++);
+        FF3(e,a,b,c,d,i++);
+        FF3(d,e,a,b,c,i++);
+        FF3(c,d,e,a,b,i++);
+        FF3(b,c,d,e,a,i++);
+    }
+
+    s[0] += a;
+    s[1] += b;
+    s[2] += c;
+    s[3] += d;
+    s[4] += e;
+}
+
+void ccsha1_avx2_compress(ccdigest_state_t state, size_t nblocks, const void *in)
+{
+    uint32_t *s = ccdigest_u32(state);
+    const uint8_t *p = in;
+    uint32_t wk[2][80];
+
+    while (nblocks >= 2) {
+        ccsha1_avx2_wk(wk[0], wk[1], p, p + CCSHA1_BLOCK_SIZE);
+        ccsha1_avx2_rounds(s, wk[0]);
+        ccsha1_avx2_rounds(s, wk[1]);
+        p += 2 * CCSHA1_BLOCK_SIZE;
+        nblocks -= 2;
+    }
+
+    // A last odd block fills both lanes.
+    if (nblocks) {
+        ccsha1_avx2_wk(wk[0], wk[1], p, p);
+        ccsha1_avx2_rounds(s, wk[0]);
+    }
+
+    cc_clear(sizeof(wk), wk);
+}
+
+const struct ccdigest_info ccsha1_avx2_di = {
+    .output_size = CCSHA1_OUTPUT_SIZE,
+    .state_size = CCSHA1_STATE_SIZE,
+    .block_size = CCSHA1_BLOCK_SIZE,
+    .oid_size = ccoid_sha1_len,
+    .oid = CC_DIGEST_OID_SHA1,
+    .initial_state = ccsha1_initial_state,
+    .compress = ccsha1_avx2_compress,
+    .final = ccdigest_final_64be,
+};
+
+#endif // CCSHA_AVX2_INTRINSICS
@@ -0,0 +1,161 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/ccsha1.h>
+#include "ccsha1_internal.h"
+#include <corecrypto/ccdigest_priv.h>
+#include "ccdigest_internal.h"
+
+#if CCSHA_SHANI_INTRINSICS
+
+#include <immintrin.h>
+
+// Four rounds with round function f on the message words w. SHA1NEXTE adds
+// to w the E derived from abcd as saved in e by the previous four rounds,
+// and abcd is saved in e_next for the following four rounds.
+#define CCSHA1_SHANI_ROUNDS(e, e_next, w, f)                             \
+    do {                                                                 \
+        e = _mm_sha1nexte_epu32(e, w);                                   \
+        e_next = abcd;                                                   \
+        abcd = _mm_sha1rnds4_epu32(abcd, e, f);                          \
+    } while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void ccsha1_shani_compress(ccdigest_state_t state, size_t nblocks, const void *in)
+{
+    uint32_t *s = ccdigest_u32(state);
+    const uint8_t *p = in;
+    const __m128i bswap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd, abcd_save, e0, e0_save, e1, m0, m1, m2, m3;
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&s[0]), 0x1b);
+    e0 = _mm_set_epi32((int)s[4], 0, 0, 0);
+
+    while (nblocks--) {
+        abcd_save = abcd;
+        e0_save = e0;
+
+        m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), bswap);
+        m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), bswap);
+        m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), bswap);
+        m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), bswap);
+
+        e0 = _mm_add_epi32(e0, m0);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m1, 0);
+        m0 = _mm_sha1msg1_epu32(m0, m1);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m2, 0);
+        m0 = _mm_xor_si128(m0, m2);
+        m1 = _mm_sha1msg1_epu32(m1, m2);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m3, 0);
+        m0 = _mm_sha1msg2_epu32(m0, m3);
+        m1 = _mm_xor_si128(m1, m3);
+        m2 = _mm_sha1msg1_epu32(m2, m3);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m0, 0);
+        m1 = _mm_sha1msg2_epu32(m1, m0);
+        m2 = _mm_xor_si128(m2, m0);
+        m3 = _mm_sha1msg1_epu32(m3, m0);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m1, 1);
+        m2 = _mm_sha1msg2_epu32(m2, m1);
+        m3 = _mm_xor_si128(m3, m1);
+        m0 = _mm_sha1msg1_epu32(m0, m1);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m2, 1);
+        m3 = _mm_sha1msg2_epu32(m3, m2);
+        m0 = _mm_xor_si128(m0, m2);
+        m1 = _mm_sha1msg1_epu32(m1, m2);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m3, 1);
+        m0 = _mm_sha1msg2_epu32(m0, m3);
+        m1 = _mm_xor_si128(m1, m3);
+        m2 = _mm_sha1msg1_epu32(m2, m3);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m0, 1);
+        m1 = _mm_sha1msg2_epu32(m1, m0);
+        m2 = _mm_xor_si128(m2, m0);
+        m3 = _mm_sha1msg1_epu32(m3, m0);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m1, 1);
+        m2 = _mm_sha1msg2_epu32(m2, m1);
+        m3 = _mm_xor_si128(m3, m1);
+        m0 = _mm_sha1msg1_epu32(m0, m1);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m2, 2);
+        m3 = _mm_sha1msg2_epu32(m3, m2);
+        m0 = _mm_xor_si128(m0, m2);
+        m1 = _mm_sha1msg1_epu32(m1, m2);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m3, 2);
+        m0 = _mm_sha1msg2_epu32(m0, m3);
+        m1 = _mm_xor_si128(m1, m3);
+        m2 = _mm_sha1msg1_epu32(m2, m3);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m0, 2);
+        m1 = _mm_sha1msg2_epu32(m1, m0);
+        m2 = _mm_xor_si128(m2, m0);
+        m3 = _mm_sha1msg1_epu32(m3, m0);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m1, 2);
+        m2 = _mm_sha1msg2_epu32(m2, m1);
+        m3 = _mm_xor_si128(m3, m1);
+        m0 = _mm_sha1msg1_epu32(m0, m1);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m2, 2);
+        m3 = _mm_sha1msg2_epu32(m3, m2);
+        m0 = _mm_xor_si128(m0, m2);
+        m1 = _mm_sha1msg1_epu32(m1, m2);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m3, 3);
+        m0 = _mm_sha1msg2_epu32(m0, m3);
+        m1 = _mm_xor_si128(m1, m3);
+        m2 = _mm_sha1msg1_epu32(m2, m3);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m0, 3);
+        m1 = _mm_sha1msg2_epu32(m1, m0);
+        m2 = _mm_xor_si128(m2, m0);
+        m3 = _mm_sha1msg1_epu32(m3, m0);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m1, 3);
+        m2 = _mm_sha1msg2_epu32(m2, m1);
+        m3 = _mm_xor_si128(m3, m1);
+
+        CCSHA1_SHANI_ROUNDS(e0, e1, m2, 3);
+        m3 = _mm_sha1msg2_epu32(m3, m2);
+
+        CCSHA1_SHANI_ROUNDS(e1, e0, m3, 3);
+
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+        p += CCSHA1_BLOCK_SIZE;
+    }
+
+    _mm_storeu_si128((__m128i *)&s[0], _mm_shuffle_epi32(abcd, 0x1b));
+    s[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+const struct ccdigest_info ccsha1_shani_di = {
+    .output_size = CCSHA1_OUTPUT_SIZE,
+    .state_size = CCSHA1_STATE_SIZE,
+    .block_size = CCSHA1_BLOCK_SIZE,
+    .oid_size = ccoid_sha1_len,
+    .oid = CC_DIGEST_OID_SHA1,
+    .initial_state = ccsha1_initial_state,
+    .compress = ccsha1_shani_compress,
+    .final = ccdigest_final_64be,
+};
+
+#endif // CCSHA_SHANI_INTRINSICS
@@ -0,0 +1,227 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include <corecrypto/ccdigest.h>
+#include <corecrypto/ccdigest_priv.h>
+#include <corecrypto/ccsha2.h>
+#include <corecrypto/cc_priv.h>
+#include <corecrypto/cc_runtime_config.h>
+#include "ccdigest_internal.h"
+#include "ccsha2_internal.h"
+
+#include "corecrypto/fipspost_trace.h"
+
+#if CCSHA2_MULTI_INTRINSICS
+
+#define CCDIGEST_MULTI_MAX_BLOCK_SIZE 128
+
+const struct ccdigest_multi_info ccsha256_avx2_multi_info = {
+    .nlanes = CCSHA256_AVX2_NLANES,
+    .min_nlanes = 2,
+    .word_size = sizeof(uint32_t),
+    .compress = ccsha256_avx2_compress_multi,
+    .compress_words = ccsha256_avx2_compress_multi_words,
+};
+
+const struct ccdigest_multi_info ccsha256_avx512_multi_info = {
+    .nlanes = CCSHA256_AVX512_NLANES,
+    .min_nlanes = 2,
+    .word_size = sizeof(uint32_t),
+    .compress = ccsha256_avx512_compress_multi,
+    .compress_words = ccsha256_avx512_compress_multi_words,
+};
+
+#if CCSHA_SHANI_INTRINSICS
+// A 16 lane AVX-512 call costs about as much as eight SHA-NI compressions,
+// so fewer messages are faster on SHA-NI.
+const struct ccdigest_multi_info ccsha256_avx512_shani_multi_info = {
+    .nlanes = CCSHA256_AVX512_NLANES,
+    .min_nlanes = 8,
+    .word_size = sizeof(uint32_t),
+    .compress = ccsha256_avx512_compress_multi,
+    .compress_words = ccsha256_avx512_compress_multi_words,
+};
+#endif
+
+const struct ccdigest_multi_info ccsha512_avx2_multi_info = {
+    .nlanes = CCSHA512_AVX2_NLANES,
+    .min_nlanes = 2,
+    .word_size = sizeof(uint64_t),
+    .compress = ccsha512_avx2_compress_multi,
+    .compress_words = ccsha512_avx2_compress_multi_words,
+};
+
+const struct ccdigest_multi_info ccsha512_avx512_multi_info = {
+    .nlanes = CCSHA512_AVX512_NLANES,
+    .min_nlanes = 2,
+    .word_size = sizeof(uint64_t),
+    .compress = ccsha512_avx512_compress_multi,
+    .compress_words = ccsha512_avx512_compress_multi_words,
+};
+
+// The kernels only depend on the compression function, so any SHA-2
+// variant is recognized by its OID.
+const struct ccdigest_multi_info *ccdigest_multi_info(const struct ccdigest_info *di)
+{
+    if (ccdigest_oid_equal(di, CC_DIGEST_OID_SHA224) || ccdigest_oid_equal(di, CC_DIGEST_OID_SHA256)) {
+#if CCSHA_SHANI_INTRINSICS
+        // One SHA-NI stream is faster than eight AVX2 lanes.
+        if (ccsha256_di() == &ccsha256_shani_di) {
+            return CC_HAS_AVX512F() ? &ccsha256_avx512_shani_multi_info : NULL;
+        }
+#endif
+        if (CC_HAS_AVX512F()) {
+            return &ccsha256_avx512_multi_info;
+        }
+        if (CC_HAS_AVX2()) {
+            return &ccsha256_avx2_multi_info;
+        }
+    }
+
+    if (ccdigest_oid_equal(di, CC_DIGEST_OID_SHA384) || ccdigest_oid_equal(di, CC_DIGEST_OID_SHA512) ||
+        ccdigest_oid_equal(di, CC_DIGEST_OID_SHA512_256)) {
+        if (CC_HAS_AVX512F()) {
+            return &ccsha512_avx512_multi_info;
+        }
+        if (CC_HAS_AVX2()) {
+            return &ccsha512_avx2_multi_info;
+        }
+    }
+
+    return NULL;
+}
+
+// Hash n <= mi->nlanes messages in parallel. Blocks are compressed in all
+// lanes for as long as every message has some left; the rest of the longer
+// messages is then compressed by di->compress, one lane at a time.
+static void ccdigest_multi_batch(const struct ccdigest_info *di,
+                                 const struct ccdigest_multi_info *mi,
+                                 size_t n,
+                                 const size_t *lens,
+                                 const void *const *datas,
+                                 void *const *outs)
+{
+    const size_t bs = di->block_size;
+    const size_t ws = mi->word_size;
+    const size_t nlanes = mi->nlanes;
+
+    ccdigest_multi_words state;
+    uint8_t tails[CCDIGEST_MULTI_MAX_NLANES][2 * CCDIGEST_MULTI_MAX_BLOCK_SIZE];
+    size_t nfull[CCDIGEST_MULTI_MAX_NLANES];
+    size_t ntotal[CCDIGEST_MULTI_MAX_NLANES];
+    const uint8_t *in[CCDIGEST_MULTI_MAX_NLANES];
+    size_t ntail[CCDIGEST_MULTI_MAX_NLANES];
+    size_t nblocks = SIZE_MAX;
+
+    // Pad the last partial block of each message, with the message length
+    // in bits as a big endian integer of 2 words.
+    for (size_t i = 0; i < n; i++) {
+        size_t rem = lens[i] % bs;
+        uint8_t *tail = tails[i];
+
+        ntail[i] = (rem + 1 + 2 * ws <= bs) ? 1 : 2;
+        cc_memset(tail, 0, ntail[i] * bs);
+        if (rem) {
+            cc_memcpy(tail, (const uint8_t *)datas[i] + lens[i] - rem, rem);
+        }
+        tail[rem] = 0x80;
+        if (ws == sizeof(uint64_t)) {
+            CC_STORE64_BE((uint64_t)lens[i] >> 61, tail + ntail[i] * bs - 16);
+        }
+        CC_STORE64_BE((uint64_t)lens[i] << 3, tail + ntail[i] * bs - 8);
+
+        nfull[i] = lens[i] / bs;
+        ntotal[i] = nfull[i] + ntail[i];
+        nblocks = CC_MIN(nblocks, ntotal[i]);
+    }
+
+    for (size_t j = 0; j < 8; j++) {
+        for (size_t i = 0; i < nlanes; i++) {
+            if (ws == sizeof(uint32_t)) {
+                state.u32[j * nlanes + i] = ((const uint32_t *)di->initial_state)[j];
+            } else {
+                state.u64[j * nlanes + i] = ((const uint64_t *)di->initial_state)[j];
+            }
+        }
+    }
+
+    // Unused lanes repeat the first message.
+    for (size_t b = 0; b < nblocks; b++) {
+        for (size_t i = 0; i < nlanes; i++) {
+            size_t l = (i < n) ? i : 0;
+            in[i] = (b < nfull[l]) ? (const uint8_t *)datas[l] + b * bs : tails[l] + (b - nfull[l]) * bs;
+        }
+        mi->compress(&state, in);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t lane[8];
+        ccdigest_state_t st = (ccdigest_state_t)lane;
+        uint8_t *out = outs[i];
+
+        for (size_t j = 0; j < 8; j++) {
+            if (ws == sizeof(uint32_t)) {
+                ccdigest_u32(st)[j] = state.u32[j * nlanes + i];
+            } else {
+                ccdigest_u64(st)[j] = state.u64[j * nlanes + i];
+            }
+        }
+
+        if (nblocks < nfull[i]) {
+            di->compress(st, nfull[i] - nblocks, (const uint8_t *)datas[i] + nblocks * bs);
+        }
+        if (nblocks < ntotal[i]) {
+            size_t b = CC_MAX_EVAL(nblocks, nfull[i]) - nfull[i];
+            di->compress(st, ntail[i] - b, tails[i] + b * bs);
+        }
+
+        for (size_t j = 0; j < di->output_size / ws; j++) {
+            if (ws == sizeof(uint32_t)) {
+                CC_STORE32_BE(ccdigest_u32(st)[j], out + j * ws);
+            } else {
+                CC_STORE64_BE(ccdigest_u64(st)[j], out + j * ws);
+            }
+        }
+
+        cc_clear(sizeof(lane), lane);
+        cc_clear(ntail[i] * bs, tails[i]);
+    }
+
+    cc_clear(8 * nlanes * ws, &state);
+}
+
+#endif // CCSHA2_MULTI_INTRINSICS
+
+void ccdigest_multi(const struct ccdigest_info *di,
+                    size_t n,
+                    const size_t *lens,
+                    const void *const *datas,
+                    void *const *outs)
+{
+    FIPSPOST_TRACE_EVENT;
+
+    size_t i = 0;
+
+#if CCSHA2_MULTI_INTRINSICS
+    const struct ccdigest_multi_info *mi = ccdigest_multi_info(di);
+
+    if (mi) {
+        for (; n - i >= mi->min_nlanes; i += CC_MIN(n - i, mi->nlanes)) {
+            ccdigest_multi_batch(di, mi, CC_MIN(n - i, mi->nlanes), &lens[i], &datas[i], &outs[i]);
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        ccdigest(di, lens[i], datas[i], outs[i]);
+    }
+}
@@ -12,13 +12,41 @@
 #include <corecrypto/ccsha2.h>
 #include "ccsha2_internal.h"
 #include <corecrypto/cc_runtime_config.h>
+#include "cc_internal.h"
 
 #include "corecrypto/fipspost_trace.h"
 
+#if CCSHA_SHANI_INTRINSICS || CCSHA_AVX2_INTRINSICS
+// CPUID is not cheap; pick the compress function once and reuse the answer.
+static const struct ccdigest_info *ccsha224_simd_di;
+
+static void ccsha224_simd_init(void)
+{
+#if CCSHA_SHANI_INTRINSICS
+    if (CC_HAS_SHA_NI()) {
+        ccsha224_simd_di = &ccsha224_shani_di;
+        return;
+    }
+#endif
+#if CCSHA_AVX2_INTRINSICS
+    if (CC_HAS_AVX2()) {
+        ccsha224_simd_di = &ccsha224_avx2_di;
+    }
+#endif
+}
+#endif
+
 const struct ccdigest_info *ccsha224_di(void)
 {
     FIPSPOST_TRACE_EVENT;
 
+#if CCSHA_SHANI_INTRINSICS || CCSHA_AVX2_INTRINSICS
+    CC_DESCRIPTOR_ONCE(ccsha224_simd_init);
+    if (ccsha224_simd_di) {
+        return ccsha224_simd_di;
+    }
+#endif
+
 #if  CCSHA2_VNG_INTEL
 #if defined (__x86_64__)
     if (CC_HAS_AVX512_AND_IN_KERNEL())
@@ -0,0 +1,154 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/ccsha2.h>
+#include <corecrypto/cc_priv.h>
+#include "ccsha2_internal.h"
+
+#if CCSHA_AVX2_INTRINSICS
+
+#include <immintrin.h>
+
+/* The message schedule of two consecutive blocks is computed together, one
+ block per 128-bit lane, four words at a time, and stored with the round
+ constants added. The rounds themselves are scalar. */
+
+#define CCSHA256_AVX2_TARGET __attribute__((target("avx2")))
+
+CC_INLINE CCSHA256_AVX2_TARGET
+__m256i ccsha256_avx2_ror(__m256i x, int n)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+CC_INLINE CCSHA256_AVX2_TARGET
+__m256i ccsha256_avx2_gamma0(__m256i x)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(ccsha256_avx2_ror(x, 7), ccsha256_avx2_ror(x, 18)), _mm256_srli_epi32(x, 3));
+}
+
+CC_INLINE CCSHA256_AVX2_TARGET
+__m256i ccsha256_avx2_gamma1(__m256i x)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(ccsha256_avx2_ror(x, 17), ccsha256_avx2_ror(x, 19)), _mm256_srli_epi32(x, 10));
+}
+
+/* W[t..t+3] from w0 = W[t-16..t-13], w1 = W[t-12..t-9], w2 = W[t-8..t-5] and
+ w3 = W[t-4..t-1]. W[t+2] and W[t+3] depend on W[t] and W[t+1], so
+ Gamma1 is applied to each half in turn. */
+CC_INLINE CCSHA256_AVX2_TARGET
+__m256i ccsha256_avx2_schedule(__m256i w0, __m256i w1, __m256i w2, __m256i w3)
+{
+    const __m256i lo = _mm256_set_epi32(0, 0, -1, -1, 0, 0, -1, -1);
+    __m256i w, t;
+
+    w = _mm256_add_epi32(w0, ccsha256_avx2_gamma0(_mm256_alignr_epi8(w1, w0, 4)));
+    w = _mm256_add_epi32(w, _mm256_alignr_epi8(w3, w2, 4));
+
+    t = ccsha256_avx2_gamma1(_mm256_shuffle_epi32(w3, 0xee));
+    w = _mm256_add_epi32(w, _mm256_and_si256(t, lo));
+    t = ccsha256_avx2_gamma1(_mm256_shuffle_epi32(w, 0x44));
+    return _mm256_add_epi32(w, _mm256_andnot_si256(lo, t));
+}
+
+CC_INLINE CCSHA256_AVX2_TARGET
+void ccsha256_avx2_store(uint32_t wk0[64], uint32_t wk1[64], size_t i, __m256i w)
+{
+    w = _mm256_add_epi32(w, _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&ccsha256_K[i])));
+    _mm_storeu_si128((__m128i *)&wk0[i], _mm256_castsi256_si128(w));
+    _mm_storeu_si128((__m128i *)&wk1[i], _mm256_extracti128_si256(w, 1));
+}
+
+/* W[i] + K[i] for the blocks at p0 and p1. */
+static CCSHA256_AVX2_TARGET
+void ccsha256_avx2_wk(uint32_t wk0[64], uint32_t wk1[64], const uint8_t *p0, const uint8_t *p1)
+{
+    const __m256i bswap = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                            0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m256i w[4];
+
+    for (unsigned j = 0; j < 4; j++) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(p0 + 16 * j));
+        __m128i b = _mm_loadu_si128((const __m128i *)(p1 + 16 * j));
+        w[j] = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1), bswap);
+        ccsha256_avx2_store(wk0, wk1, 4 * j, w[j]);
+    }
+
+    for (size_t i = 16; i < 64; i += 4) {
+        __m256i t = ccsha256_avx2_schedule(w[0], w[1], w[2], w[3]);
+        w[0] = w[1];
+        w[1] = w[2];
+        w[2] = w[3];
+        w[3] = t;
+        ccsha256_avx2_store(wk0, wk1, i, t);
+    }
+}
+
+#define Ch(x, y, z) (z ^ (x & (y ^ z)))
+#define Maj(x, y, z) (((x | y) & z) | (x & y))
+#define S(x, n) CC_RORc(x, n)
+#define Sigma0(x) (S(x, 2) ^ S(x, 13) ^ S(x, 22))
+#define Sigma1(x) (S(x, 6) ^ S(x, 11) ^ S(x, 25))
+
+#define RND(a, b, c, d, e, f, g, h, i)              \
+    t0 = h + Sigma1(e) + Ch(e, f, g) + wk[i];       \
+    t1 = Sigma0(a) + Maj(a, b, c);                  \
+    d += t0;                                        \
+    h = t0 + t1;
+
+static void ccsha256_avx2_rounds(uint32_t *s, const uint32_t wk[64])
+{
+    uint32_t S[8], t0, t1;
+
+    for (unsigned i = 0; i < 8; i++) {
+        S[i] = s[i];
+    }
+
+    for (unsigned i = 0; i < 64; i += 8) {
+        RND(S[0], S[1], S[2], S[3], S[4], S[5], S[6], S[7], i + 0);
+        RND(S[7], S[0], S[1], S[2], S[3], S[4], S[5], S[6], i + 1);
+        RND(S[6], S[7], S[0], S[1], S[2], S[3], S[4], S[5], i + 2);
+        RND(S[5], S[6], S[7], S[0], S[1], S[2], S[3], S[4], i + 3);
+        RND(S[4], S[5], S[6], S[7], S[0], S[1], S[2], S[3], i + 4);
+        RND(S[3], S[4], S[5], S[6], S[7], S[0], S[1], S[2], i + 5);
+        RND(S[2], S[3], S[4], S[5], S[6], S[7], S[0], S[1], i + 6);
+        RND(S[1], S[2], S[3], S[4], S[5], S[6], S[7], S[0], i + 7);
+    }
+
+    for (unsigned i = 0; i < 8; i++) {
+        s[i] += S[i];
+    }
+}
+
+void ccsha256_avx2_compress(ccdigest_state_t state, size_t nblocks, const void *in)
+{
+    uint32_t *s = ccdigest_u32(state);
+    const uint8_t *p = in;
+    uint32_t wk[2][64];
+
+    while (nblocks >= 2) {
+        ccsha256_avx2_wk(wk[0], wk[1], p, p + CCSHA256_BLOCK_SIZE);
+        ccsha256_avx2_rounds(s, wk[0]);
+        ccsha256_avx2_rounds(s, wk[1]);
+        p += 2 * CCSHA256_BLOCK_SIZE;
+        nblocks -= 2;
+    }
+
+    // A last odd block fills both lanes.
+    if (nblocks) {
+        ccsha256_avx2_wk(wk[0], wk[1], p, p);
+        ccsha256_avx2_rounds(s, wk[0]);
+    }
+
+    cc_clear(sizeof(wk), wk);
+}
+
+#endif // CCSHA_AVX2_INTRINSICS
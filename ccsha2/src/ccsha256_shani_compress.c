@@ -0,0 +1,100 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/ccsha2.h>
+#include "ccsha2_internal.h"
+
+#if CCSHA_SHANI_INTRINSICS
+
+#include <immintrin.h>
+
+// Four rounds with the message words w, which hold W[i..i+3] in lanes 0..3.
+#define CCSHA256_SHANI_ROUNDS(w, i)                                      \
+    do {                                                                 \
+        __m128i _wk = _mm_add_epi32(w, _mm_loadu_si128((const __m128i *)&ccsha256_K[i])); \
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, _wk);                    \
+        _wk = _mm_shuffle_epi32(_wk, 0x0e);                              \
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _wk);                    \
+    } while (0)
+
+// Replace W[i-16..i-13], held in w0, with W[i..i+3], where w1, w2 and w3
+// hold the three following groups of message words.
+#define CCSHA256_SHANI_SCHEDULE(w0, w1, w2, w3)                          \
+    do {                                                                 \
+        w0 = _mm_sha256msg1_epu32(w0, w1);                               \
+        w0 = _mm_add_epi32(w0, _mm_alignr_epi8(w3, w2, 4));              \
+        w0 = _mm_sha256msg2_epu32(w0, w3);                               \
+    } while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void ccsha256_shani_compress(ccdigest_state_t state, size_t nblocks, const void *in)
+{
+    uint32_t *s = ccdigest_u32(state);
+    const uint8_t *p = in;
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i abef, cdgh, abef_save, cdgh_save, m0, m1, m2, m3, t;
+
+    // The rounds instructions take the state as ABEF and CDGH.
+    t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&s[0]), 0xb1);
+    cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&s[4]), 0x1b);
+    abef = _mm_alignr_epi8(t, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, t, 0xf0);
+
+    while (nblocks--) {
+        abef_save = abef;
+        cdgh_save = cdgh;
+
+        m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), bswap);
+        m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), bswap);
+        m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), bswap);
+        m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), bswap);
+
+        CCSHA256_SHANI_ROUNDS(m0, 0);
+        CCSHA256_SHANI_ROUNDS(m1, 4);
+        CCSHA256_SHANI_ROUNDS(m2, 8);
+        CCSHA256_SHANI_ROUNDS(m3, 12);
+        CCSHA256_SHANI_SCHEDULE(m0, m1, m2, m3);
+        CCSHA256_SHANI_ROUNDS(m0, 16);
+        CCSHA256_SHANI_SCHEDULE(m1, m2, m3, m0);
+        CCSHA256_SHANI_ROUNDS(m1, 20);
+        CCSHA256_SHANI_SCHEDULE(m2, m3, m0, m1);
+        CCSHA256_SHANI_ROUNDS(m2, 24);
+        CCSHA256_SHANI_SCHEDULE(m3, m0, m1, m2);
+        CCSHA256_SHANI_ROUNDS(m3, 28);
+        CCSHA256_SHANI_SCHEDULE(m0, m1, m2, m3);
+        CCSHA256_SHANI_ROUNDS(m0, 32);
+        CCSHA256_SHANI_SCHEDULE(m1, m2, m3, m0);
+        CCSHA256_SHANI_ROUNDS(m1, 36);
+        CCSHA256_SHANI_SCHEDULE(m2, m3, m0, m1);
+        CCSHA256_SHANI_ROUNDS(m2, 40);
+        CCSHA256_SHANI_SCHEDULE(m3, m0, m1, m2);
+        CCSHA256_SHANI_ROUNDS(m3, 44);
+        CCSHA256_SHANI_SCHEDULE(m0, m1, m2, m3);
+        CCSHA256_SHANI_ROUNDS(m0, 48);
+        CCSHA256_SHANI_SCHEDULE(m1, m2, m3, m0);
+        CCSHA256_SHANI_ROUNDS(m1, 52);
+        CCSHA256_SHANI_SCHEDULE(m2, m3, m0, m1);
+        CCSHA256_SHANI_ROUNDS(m2, 56);
+        CCSHA256_SHANI_SCHEDULE(m3, m0, m1, m2);
+        CCSHA256_SHANI_ROUNDS(m3, 60);
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+        p += CCSHA256_BLOCK_SIZE;
+    }
+
+    t = _mm_shuffle_epi32(abef, 0x1b);
+    cdgh = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128((__m128i *)&s[0], _mm_blend_epi16(t, cdgh, 0xf0));
+    _mm_storeu_si128((__m128i *)&s[4], _mm_alignr_epi8(cdgh, t, 8));
+}
+
+#endif // CCSHA_SHANI_INTRINSICS
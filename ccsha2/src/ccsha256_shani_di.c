@@ -0,0 +1,30 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+#include <corecrypto/ccsha2.h>
+#include <corecrypto/ccdigest_priv.h>
+#include "ccdigest_internal.h"
+#include "ccsha2_internal.h"
+
+#if CCSHA_SHANI_INTRINSICS
+
+const struct ccdigest_info ccsha256_shani_di = {
+    .output_size = CCSHA256_OUTPUT_SIZE,
+    .state_size = CCSHA256_STATE_SIZE,
+    .block_size = CCSHA256_BLOCK_SIZE,
+    .oid_size = ccoid_sha256_len,
+    .oid = CC_DIGEST_OID_SHA256,
+    .initial_state = ccsha256_initial_state,
+    .compress = ccsha256_shani_compress,
+    .final = ccdigest_final_64be,
+};
+
+#endif
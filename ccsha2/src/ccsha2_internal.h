@@ -62,6 +62,41 @@ extern const struct ccdigest_info ccsha512_256_vng_intel_SupplementalSSE3_di;
 void ccsha256_vng_intel_sse3_compress(ccdigest_state_t state, size_t nblocks, const void *in) __asm__("_ccsha256_vng_intel_sse3_compress");
 #endif
 
+#if CCSHA_SHANI_INTRINSICS
+// SHA-NI implementation through compiler intrinsics. Only use when CC_HAS_SHA_NI().
+void ccsha256_shani_compress(ccdigest_state_t state, size_t nblocks, const void *in);
+extern const struct ccdigest_info ccsha224_shani_di;
+extern const struct ccdigest_info ccsha256_shani_di;
+#endif
+
+#if CCSHA_AVX2_INTRINSICS
+// AVX2 message schedule with scalar rounds, through compiler intrinsics. Only use when CC_HAS_AVX2().
+void ccsha256_avx2_compress(ccdigest_state_t state, size_t nblocks, const void *in);
+extern const struct ccdigest_info ccsha224_avx2_di;
+extern const struct ccdigest_info ccsha256_avx2_di;
+#endif
+
+#if CCSHA2_MULTI_INTRINSICS
+// Multi-buffer kernels through compiler intrinsics, compressing one block of
+// each of nlanes independent messages per call. Word j of the state of lane i
+// is at state[j * nlanes + i]. The block of lane i is either read from in[i],
+// or given as host order words with word t at words[t * nlanes + i].
+#define CCSHA256_AVX2_NLANES 8
+#define CCSHA256_AVX512_NLANES 16
+#define CCSHA512_AVX2_NLANES 4
+#define CCSHA512_AVX512_NLANES 8
+
+void ccsha256_avx2_compress_multi(void *state, const uint8_t *const *in);
+void ccsha256_avx512_compress_multi(void *state, const uint8_t *const *in);
+void ccsha512_avx2_compress_multi(void *state, const uint8_t *const *in);
+void ccsha512_avx512_compress_multi(void *state, const uint8_t *const *in);
+
+void ccsha256_avx2_compress_multi_words(void *state, const void *words);
+void ccsha256_avx512_compress_multi_words(void *state, const void *words);
+void ccsha512_avx2_compress_multi_words(void *state, const void *words);
+void ccsha512_avx512_compress_multi_words(void *state, const void *words);
+#endif
+
 extern const uint32_t ccsha256_K[64];
 extern const uint64_t ccsha512_K[80];
 
@@ -0,0 +1,350 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include <corecrypto/ccsha2.h>
+#include "ccsha2_internal.h"
+
+#if CCSHA2_MULTI_INTRINSICS
+
+#include <immintrin.h>
+
+/* The kernels below hold word j of the state and of the message schedule of
+ * every lane in one vector, so that the rounds are the scalar ones applied to
+ * vectors. The vector operations V_xxx are defined by each kernel before
+ * expanding CCSHA2_MULTI_ROUNDS, which runs nrounds rounds on s[8] with the
+ * message words w[16] and adds the result to s. */
+#define CCSHA2_MULTI_ROUNDS(nrounds, K)                                                    \
+    do {                                                                                   \
+        V_TYPE _a = s[0], _b = s[1], _c = s[2], _d = s[3];                                 \
+        V_TYPE _e = s[4], _f = s[5], _g = s[6], _h = s[7];                                 \
+        V_TYPE _t1, _t2;                                                                   \
+        for (unsigned _t = 0; _t < (nrounds); _t++) {                                      \
+            if (_t >= 16) {                                                                \
+                w[_t & 15] = V_ADD(V_ADD(w[_t & 15], V_s0(w[(_t + 1) & 15])),              \
+                                   V_ADD(w[(_t + 9) & 15], V_s1(w[(_t + 14) & 15])));      \
+            }                                                                              \
+            _t1 = V_ADD(V_ADD(_h, V_S1(_e)), V_ADD(V_CH(_e, _f, _g), V_K(K(_t))));         \
+            _t1 = V_ADD(_t1, w[_t & 15]);                                                  \
+            _t2 = V_ADD(V_S0(_a), V_MAJ(_a, _b, _c));                                      \
+            _h = _g;                                                                       \
+            _g = _f;                                                                       \
+            _f = _e;                                                                       \
+            _e = V_ADD(_d, _t1);                                                           \
+            _d = _c;                                                                       \
+            _c = _b;                                                                       \
+            _b = _a;                                                                       \
+            _a = V_ADD(_t1, _t2);                                                          \
+        }                                                                                  \
+        s[0] = V_ADD(s[0], _a);                                                            \
+        s[1] = V_ADD(s[1], _b);                                                            \
+        s[2] = V_ADD(s[2], _c);                                                            \
+        s[3] = V_ADD(s[3], _d);                                                            \
+        s[4] = V_ADD(s[4], _e);                                                            \
+        s[5] = V_ADD(s[5], _f);                                                            \
+        s[6] = V_ADD(s[6], _g);                                                            \
+        s[7] = V_ADD(s[7], _h);                                                            \
+    } while (0)
+
+#if CCSHA2_SHA256_USE_SHA512_K
+#define CCSHA256_K(i) ((uint32_t)(ccsha512_K[i] >> 32))
+#else
+#define CCSHA256_K(i) ccsha256_K[i]
+#endif
+
+/* Message words are gathered with the lane pointers as 64-bit indices, and
+ * the offset of the word in the block as the base address. */
+#define CCSHA2_MULTI_BASE(offset) ((const void *)(uintptr_t)(offset))
+
+#define CCSHA256_BSWAP_MASK _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, \
+                                            12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)
+#define CCSHA512_BSWAP_MASK _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, \
+                                            8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7)
+
+//
+// SHA-256, AVX2
+//
+
+#define V_TYPE __m256i
+#define V_ADD(x, y) _mm256_add_epi32(x, y)
+#define V_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define V_ROR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define V_S0(x) V_XOR3(V_ROR(x, 2), V_ROR(x, 13), V_ROR(x, 22))
+#define V_S1(x) V_XOR3(V_ROR(x, 6), V_ROR(x, 11), V_ROR(x, 25))
+#define V_s0(x) V_XOR3(V_ROR(x, 7), V_ROR(x, 18), _mm256_srli_epi32(x, 3))
+#define V_s1(x) V_XOR3(V_ROR(x, 17), V_ROR(x, 19), _mm256_srli_epi32(x, 10))
+#define V_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define V_MAJ(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_xor_si256(x, y)))
+#define V_K(k) _mm256_set1_epi32((int)(k))
+
+__attribute__((target("avx2")))
+static void ccsha256_avx2_rounds(uint32_t *state, __m256i w[16])
+{
+    __m256i s[8];
+
+    for (unsigned i = 0; i < 8; i++) {
+        s[i] = _mm256_loadu_si256((const __m256i *)&state[i * CCSHA256_AVX2_NLANES]);
+    }
+
+    CCSHA2_MULTI_ROUNDS(64, CCSHA256_K);
+
+    for (unsigned i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)&state[i * CCSHA256_AVX2_NLANES], s[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+void ccsha256_avx2_compress_multi(void *state, const uint8_t *const *in)
+{
+    const __m256i idx0 = _mm256_loadu_si256((const __m256i *)&in[0]);
+    const __m256i idx1 = _mm256_loadu_si256((const __m256i *)&in[4]);
+    __m256i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        __m128i lo = _mm256_i64gather_epi32(CCSHA2_MULTI_BASE(4 * i), idx0, 1);
+        __m128i hi = _mm256_i64gather_epi32(CCSHA2_MULTI_BASE(4 * i), idx1, 1);
+        w[i] = _mm256_shuffle_epi8(_mm256_set_m128i(hi, lo), CCSHA256_BSWAP_MASK);
+    }
+
+    ccsha256_avx2_rounds(state, w);
+}
+
+__attribute__((target("avx2")))
+void ccsha256_avx2_compress_multi_words(void *state, const void *words)
+{
+    const uint32_t *m = words;
+    __m256i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        w[i] = _mm256_loadu_si256((const __m256i *)&m[i * CCSHA256_AVX2_NLANES]);
+    }
+
+    ccsha256_avx2_rounds(state, w);
+}
+
+#undef V_TYPE
+#undef V_ADD
+#undef V_XOR3
+#undef V_ROR
+#undef V_S0
+#undef V_S1
+#undef V_s0
+#undef V_s1
+#undef V_CH
+#undef V_MAJ
+#undef V_K
+
+//
+// SHA-256, AVX-512
+//
+
+#define V_TYPE __m512i
+#define V_ADD(x, y) _mm512_add_epi32(x, y)
+#define V_XOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define V_S0(x) V_XOR3(_mm512_ror_epi32(x, 2), _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22))
+#define V_S1(x) V_XOR3(_mm512_ror_epi32(x, 6), _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25))
+#define V_s0(x) V_XOR3(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x, 3))
+#define V_s1(x) V_XOR3(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10))
+#define V_CH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xca)
+#define V_MAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xe8)
+#define V_K(k) _mm512_set1_epi32((int)(k))
+
+__attribute__((target("avx512f,avx2")))
+static void ccsha256_avx512_rounds(uint32_t *state, __m512i w[16])
+{
+    __m512i s[8];
+
+    for (unsigned i = 0; i < 8; i++) {
+        s[i] = _mm512_loadu_si512((const void *)&state[i * CCSHA256_AVX512_NLANES]);
+    }
+
+    CCSHA2_MULTI_ROUNDS(64, CCSHA256_K);
+
+    for (unsigned i = 0; i < 8; i++) {
+        _mm512_storeu_si512((void *)&state[i * CCSHA256_AVX512_NLANES], s[i]);
+    }
+}
+
+__attribute__((target("avx512f,avx2")))
+void ccsha256_avx512_compress_multi(void *state, const uint8_t *const *in)
+{
+    const __m512i idx0 = _mm512_loadu_si512((const void *)&in[0]);
+    const __m512i idx1 = _mm512_loadu_si512((const void *)&in[8]);
+    __m512i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        __m256i lo = _mm512_i64gather_epi32(idx0, CCSHA2_MULTI_BASE(4 * i), 1);
+        __m256i hi = _mm512_i64gather_epi32(idx1, CCSHA2_MULTI_BASE(4 * i), 1);
+        lo = _mm256_shuffle_epi8(lo, CCSHA256_BSWAP_MASK);
+        hi = _mm256_shuffle_epi8(hi, CCSHA256_BSWAP_MASK);
+        w[i] = _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+    }
+
+    ccsha256_avx512_rounds(state, w);
+}
+
+__attribute__((target("avx512f,avx2")))
+void ccsha256_avx512_compress_multi_words(void *state, const void *words)
+{
+    const uint32_t *m = words;
+    __m512i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        w[i] = _mm512_loadu_si512((const void *)&m[i * CCSHA256_AVX512_NLANES]);
+    }
+
+    ccsha256_avx512_rounds(state, w);
+}
+
+#undef V_TYPE
+#undef V_ADD
+#undef V_XOR3
+#undef V_S0
+#undef V_S1
+#undef V_s0
+#undef V_s1
+#undef V_CH
+#undef V_MAJ
+#undef V_K
+
+//
+// SHA-512, AVX2
+//
+
+#define V_TYPE __m256i
+#define V_ADD(x, y) _mm256_add_epi64(x, y)
+#define V_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define V_ROR(x, n) _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+#define V_S0(x) V_XOR3(V_ROR(x, 28), V_ROR(x, 34), V_ROR(x, 39))
+#define V_S1(x) V_XOR3(V_ROR(x, 14), V_ROR(x, 18), V_ROR(x, 41))
+#define V_s0(x) V_XOR3(V_ROR(x, 1), V_ROR(x, 8), _mm256_srli_epi64(x, 7))
+#define V_s1(x) V_XOR3(V_ROR(x, 19), V_ROR(x, 61), _mm256_srli_epi64(x, 6))
+#define V_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define V_MAJ(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_xor_si256(x, y)))
+#define V_K(k) _mm256_set1_epi64x((long long)(k))
+#define CCSHA512_K(i) ccsha512_K[i]
+
+__attribute__((target("avx2")))
+static void ccsha512_avx2_rounds(uint64_t *state, __m256i w[16])
+{
+    __m256i s[8];
+
+    for (unsigned i = 0; i < 8; i++) {
+        s[i] = _mm256_loadu_si256((const __m256i *)&state[i * CCSHA512_AVX2_NLANES]);
+    }
+
+    CCSHA2_MULTI_ROUNDS(80, CCSHA512_K);
+
+    for (unsigned i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)&state[i * CCSHA512_AVX2_NLANES], s[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+void ccsha512_avx2_compress_multi(void *state, const uint8_t *const *in)
+{
+    const __m256i idx = _mm256_loadu_si256((const __m256i *)&in[0]);
+    __m256i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        w[i] = _mm256_i64gather_epi64(CCSHA2_MULTI_BASE(8 * i), idx, 1);
+        w[i] = _mm256_shuffle_epi8(w[i], CCSHA512_BSWAP_MASK);
+    }
+
+    ccsha512_avx2_rounds(state, w);
+}
+
+__attribute__((target("avx2")))
+void ccsha512_avx2_compress_multi_words(void *state, const void *words)
+{
+    const uint64_t *m = words;
+    __m256i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        w[i] = _mm256_loadu_si256((const __m256i *)&m[i * CCSHA512_AVX2_NLANES]);
+    }
+
+    ccsha512_avx2_rounds(state, w);
+}
+
+#undef V_TYPE
+#undef V_ADD
+#undef V_XOR3
+#undef V_ROR
+#undef V_S0
+#undef V_S1
+#undef V_s0
+#undef V_s1
+#undef V_CH
+#undef V_MAJ
+#undef V_K
+
+//
+// SHA-512, AVX-512
+//
+
+#define V_TYPE __m512i
+#define V_ADD(x, y) _mm512_add_epi64(x, y)
+#define V_XOR3(x, y, z) _mm512_ternarylogic_epi64(x, y, z, 0x96)
+#define V_S0(x) V_XOR3(_mm512_ror_epi64(x, 28), _mm512_ror_epi64(x, 34), _mm512_ror_epi64(x, 39))
+#define V_S1(x) V_XOR3(_mm512_ror_epi64(x, 14), _mm512_ror_epi64(x, 18), _mm512_ror_epi64(x, 41))
+#define V_s0(x) V_XOR3(_mm512_ror_epi64(x, 1), _mm512_ror_epi64(x, 8), _mm512_srli_epi64(x, 7))
+#define V_s1(x) V_XOR3(_mm512_ror_epi64(x, 19), _mm512_ror_epi64(x, 61), _mm512_srli_epi64(x, 6))
+#define V_CH(x, y, z) _mm512_ternarylogic_epi64(x, y, z, 0xca)
+#define V_MAJ(x, y, z) _mm512_ternarylogic_epi64(x, y, z, 0xe8)
+#define V_K(k) _mm512_set1_epi64((long long)(k))
+
+__attribute__((target("avx512f,avx2")))
+static void ccsha512_avx512_rounds(uint64_t *state, __m512i w[16])
+{
+    __m512i s[8];
+
+    for (unsigned i = 0; i < 8; i++) {
+        s[i] = _mm512_loadu_si512((const void *)&state[i * CCSHA512_AVX512_NLANES]);
+    }
+
+    CCSHA2_MULTI_ROUNDS(80, CCSHA512_K);
+
+    for (unsigned i = 0; i < 8; i++) {
+        _mm512_storeu_si512((void *)&state[i * CCSHA512_AVX512_NLANES], s[i]);
+    }
+}
+
+__attribute__((target("avx512f,avx2")))
+void ccsha512_avx512_compress_multi(void *state, const uint8_t *const *in)
+{
+    const __m512i idx = _mm512_loadu_si512((const void *)&in[0]);
+    __m512i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        __m512i x = _mm512_i64gather_epi64(idx, CCSHA2_MULTI_BASE(8 * i), 1);
+        __m256i lo = _mm256_shuffle_epi8(_mm512_castsi512_si256(x), CCSHA512_BSWAP_MASK);
+        __m256i hi = _mm256_shuffle_epi8(_mm512_extracti64x4_epi64(x, 1), CCSHA512_BSWAP_MASK);
+        w[i] = _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+    }
+
+    ccsha512_avx512_rounds(state, w);
+}
+
+__attribute__((target("avx512f,avx2")))
+void ccsha512_avx512_compress_multi_words(void *state, const void *words)
+{
+    const uint64_t *m = words;
+    __m512i w[16];
+
+    for (unsigned i = 0; i < 16; i++) {
+        w[i] = _mm512_loadu_si512((const void *)&m[i * CCSHA512_AVX512_NLANES]);
+    }
+
+    ccsha512_avx512_rounds(state, w);
+}
+
+#endif // CCSHA2_MULTI_INTRINSICS
@@ -574,6 +574,38 @@ void cczp_mm_init_ws(cc_ws_t ws, cczp_t zp, cc_size n, const cc_unit *p);
 CC_NONNULL_ALL
 void cczp_mm_init_precomp(cczp_t zp, cc_size n, const cc_unit *p, cc_unit p0inv, const cc_unit *r1, const cc_unit *r2);
 
+#if CCZP_MM_ADX_ASM
+
+/* Moduli of this many words use the MULX/ADCX/ADOX kernels below when the
+   CPU has BMI2 and ADX. Up to 1024-bit moduli, RSA is no faster with them. */
+#define CCZP_MM_ADX_MIN_N 17
+#define CCZP_MM_ADX_MAX_N 64
+
+/*! @function cczp_mm_mul_adx
+ @abstract Computes r := x * y / R (mod p) by interleaved (CIOS) Montgomery multiplication.
+
+ @param zp  Multiplicative group Z/(p), initialized for Montgomery multiplication
+ @param r   Result
+ @param x   Multiplier
+ @param y   Multiplicand
+ @param t   Temporary storage of n + 3 words
+ */
+CC_NONNULL_ALL
+void cczp_mm_mul_adx(cczp_const_t zp, cc_unit *r, const cc_unit *x, const cc_unit *y, cc_unit *t);
+
+/*! @function cczp_mm_sqr_adx
+ @abstract Computes r := x^2 / R (mod p).
+
+ @param zp  Multiplicative group Z/(p), initialized for Montgomery multiplication
+ @param r   Result
+ @param x   Number to square
+ @param t   Temporary storage of 2 * n words
+ */
+CC_NONNULL_ALL
+void cczp_mm_sqr_adx(cczp_const_t zp, cc_unit *r, const cc_unit *x, cc_unit *t);
+
+#endif // CCZP_MM_ADX_ASM
+
 #define CCZP_MM_POWER_WORKSPACE_N(n, pn)             \
     (cczp_mm_nof_n(n) +                              \
        CC_MAX_EVAL(CCZP_MM_INIT_WORKSPACE_N(n),      \
@@ -576,6 +576,66 @@ static int test_cczp_mod_2n(void)
     return 0;
 }
 
+static int test_cczp_mm_mul_sqr_n(cc_size mn)
+{
+    struct ccrng_state *rng = global_test_rng;
+    CC_DECL_WORKSPACE_OR_FAIL(ws, CC_MAX_EVAL(CCZP_MM_INIT_WORKSPACE_N(mn),
+                                    CC_MAX_EVAL(CCZP_INIT_WORKSPACE_N(mn),
+                                                CCZP_TO_WORKSPACE_N(mn))));
+
+    cc_unit mp[mn], x[mn], y[mn], xm[mn], ym[mn], r[mn], rm[mn];
+
+    // A random odd modulus of full length.
+    ccrng_generate(rng, ccn_sizeof_n(mn), mp);
+    mp[0] |= 1;
+    mp[mn - 1] |= CC_UNIT_C(1) << (CCN_UNIT_BITS - 1);
+
+    cczp_decl_n(mn, zp);
+    CCZP_N(zp) = mn;
+    ccn_set(mn, CCZP_PRIME(zp), mp);
+    cczp_init_ws(ws, zp);
+
+    cczp_mm_decl_n(mn, zpmm);
+    cczp_mm_init_ws(ws, zpmm, mn, mp);
+
+    // x = p - 1 maximizes the carries, then a random x.
+    ccn_sub1(mn, x, mp, 1);
+    for (int i = 0; i < 2; i++) {
+        cczp_generate_non_zero_element(zp, rng, y);
+
+        cczp_to_ws(ws, zpmm, xm, x);
+        cczp_to_ws(ws, zpmm, ym, y);
+
+        cczp_mul_ws(ws, zp, r, x, y);
+        cczp_mul_ws(ws, zpmm, rm, xm, ym);
+        cczp_from_ws(ws, zpmm, rm, rm);
+        ok_ccn_cmp(mn, r, rm, "Montgomery mul mismatch, n = %zu", (size_t)mn);
+
+        cczp_sqr_ws(ws, zp, r, x);
+        cczp_sqr_ws(ws, zpmm, rm, xm);
+        cczp_from_ws(ws, zpmm, rm, rm);
+        ok_ccn_cmp(mn, r, rm, "Montgomery sqr mismatch, n = %zu", (size_t)mn);
+
+        cczp_generate_non_zero_element(zp, rng, x);
+    }
+
+    CC_CLEAR_AND_FREE_WORKSPACE(ws);
+    return 0;
+}
+
+// Sizes around the bounds of the BMI2/ADX kernels, and RSA sizes.
+static const cc_size test_cczp_mm_sizes[] = { 3, 16, 17, 18, 32, 48, 64, 65 };
+
+static int test_cczp_mm_mul_sqr(void)
+{
+    for (size_t i = 0; i < CC_ARRAY_LEN(test_cczp_mm_sizes); i++) {
+        if (test_cczp_mm_mul_sqr_n(test_cczp_mm_sizes[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int cczp_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 {
     int num_tests = 0;
@@ -586,6 +646,7 @@ int cczp_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 
     num_tests += 2 + (2 * (3 * NUM_RANDOM_SQRT_TESTS)); // test_cczp_sqrt_randomized
     num_tests += 1 + (2 * NUM_RANDOM_SQRT_TESTS);       // test_cczp_sqr_vs_mul
+    num_tests += 1 + 4 * 8;                             // test_cczp_mm_mul_sqr
     num_tests += 1 + 2;                                 // test_cczp_add_sub
     num_tests += 1 + 4;                                 // test_cczp_div2
     num_tests += 3 + 3 * 3;                             // test_cczp_modn
@@ -612,6 +673,8 @@ int cczp_tests(TM_UNUSED int argc, TM_UNUSED char *const *argv)
 
     is(test_cczp_sqr_vs_mul(), 0, "test_cczp_sqr_vs_mul failed");
 
+    is(test_cczp_mm_mul_sqr(), 0, "test_cczp_mm_mul_sqr failed");
+
     is(test_cczp_add_sub(), 0, "test_cczp_add_sub failed");
 
     is(test_cczp_div2(), 0, "test_cczp_div2 failed");
@@ -9,6 +9,7 @@
  * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
  */
 
+#include <corecrypto/cc_runtime_config.h>
 #include "ccn_internal.h"
 #include "cczp_internal.h"
 
@@ -194,6 +195,75 @@ cczp_funcs_decl(cczp_montgomery_funcs,
     cczp_mm_from_ws,
     cczp_mm_is_one_ws);
 
+#if CCZP_MM_ADX_ASM
+
+/*! @function cczp_mm_mul_adx_ws
+ @abstract Multiplies two numbers x and y with MULX/ADCX/ADOX.
+
+ @param ws  Workspace
+ @param zp  Multiplicative group Z/(p)
+ @param r   Result
+ @param x   Multiplier
+ @param y   Multiplicand
+ */
+CC_NONNULL_ALL
+static void cczp_mm_mul_adx_ws(cc_ws_t ws, cczp_const_t zp, cc_unit *r, const cc_unit *x, const cc_unit *y)
+{
+    CC_DECL_BP_WS(ws, bp);
+    cc_unit *t = CC_ALLOC_WS(ws, cczp_n(zp) + 3);
+    cczp_mm_mul_adx(zp, r, x, y, t);
+    CC_FREE_BP_WS(ws, bp);
+}
+
+/*! @function cczp_mm_sqr_adx_ws
+ @abstract Squares a number x with MULX/ADCX/ADOX.
+
+ @param ws  Workspace
+ @param zp  Multiplicative group Z/(p)
+ @param r   Result
+ @param x   Number to square
+ */
+CC_NONNULL_ALL
+static void cczp_mm_sqr_adx_ws(cc_ws_t ws, cczp_const_t zp, cc_unit *r, const cc_unit *x)
+{
+    CC_DECL_BP_WS(ws, bp);
+    cc_unit *t = CC_ALLOC_WS(ws, 2 * cczp_n(zp));
+    cczp_mm_sqr_adx(zp, r, x, t);
+    CC_FREE_BP_WS(ws, bp);
+}
+
+// Montgomery multiplication functions for cczp, for CPUs with BMI2 and ADX.
+static cczp_funcs_decl(cczp_montgomery_adx_funcs,
+    cczp_mm_mul_adx_ws,
+    cczp_mm_sqr_adx_ws,
+    cczp_mm_mod_ws,
+    cczp_mm_inv_ws,
+    cczp_mm_sqrt_ws,
+    cczp_mm_to_ws,
+    cczp_mm_from_ws,
+    cczp_mm_is_one_ws);
+
+#endif // CCZP_MM_ADX_ASM
+
+/*! @function cczp_mm_funcs
+ @abstract Selects the Montgomery multiplication functions for moduli of n words on this CPU.
+
+ @param n  Size of p
+
+ @return The cczp functions to use.
+ */
+static const struct cczp_funcs *cczp_mm_funcs(cc_size n)
+{
+#if CCZP_MM_ADX_ASM
+    if (n >= CCZP_MM_ADX_MIN_N && n <= CCZP_MM_ADX_MAX_N && CC_HAS_BMI2() && CC_HAS_ADX()) {
+        return &cczp_montgomery_adx_funcs;
+    }
+#else
+    (void)n;
+#endif
+    return &cczp_montgomery_funcs;
+}
+
 /*! @function cczp_mm_compute_r1r2
  @abstract Computes R (mod p) and R^2 (mod p).
 
@@ -248,7 +318,7 @@ void cczp_mm_init_ws(cc_ws_t ws, cczp_t zp, cc_size n, const cc_unit *p)
     CCZP_N(zp) = n;
     CCZP_BITLEN(zp) = ccn_bitlen(n, p);
     ccn_set(n, CCZP_PRIME(zp), p);
-    CCZP_FUNCS(zp) = &cczp_montgomery_funcs;
+    CCZP_FUNCS(zp) = cczp_mm_funcs(n);
 
     // -m[0]^(-1) (mod 2^w)
     cczp_mm_p0inv(zp) = -ccn_invert(p[0]);
@@ -265,7 +335,7 @@ void cczp_mm_init_precomp(cczp_t zp, cc_size n, const cc_unit *p, cc_unit p0inv,
     CCZP_N(zp) = n;
     CCZP_BITLEN(zp) = ccn_bitlen(n, p);
     ccn_set(n, CCZP_PRIME(zp), p);
-    CCZP_FUNCS(zp) = &cczp_montgomery_funcs;
+    CCZP_FUNCS(zp) = cczp_mm_funcs(n);
 
     // -m[0]^(-1) (mod 2^w)
     cczp_mm_p0inv(zp) = p0inv;
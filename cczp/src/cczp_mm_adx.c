@@ -0,0 +1,144 @@
+/* Copyright (c) (2020) Apple Inc. All rights reserved.
+ *
+ * corecrypto is licensed under Apple Inc.’s Internal Use License Agreement (which
+ * is contained in the License.txt file distributed with corecrypto) and only to
+ * people who accept that license. IMPORTANT:  Any license rights granted to you by
+ * Apple Inc. (if any) are limited to internal use within your organization only on
+ * devices and computers you own or control, for the sole purpose of verifying the
+ * security characteristics and correct functioning of the Apple Software.  You may
+ * not, directly or indirectly, redistribute the Apple Software or any portions thereof.
+ */
+
+
+#include "ccn_internal.h"
+#include "cczp_internal.h"
+
+#if CCZP_MM_ADX_ASM
+
+/* Montgomery multiplication with MULX, which leaves the flags alone, and
+ * ADCX/ADOX, which carry through CF and OF only. Each word of a row adds
+ * the low half of its product on the CF chain and the high half of the
+ * previous product on the OF chain, so the two additions do not wait on
+ * each other.
+ *
+ * The row is written in inline assembly: compilers lower _addcarryx_u64()
+ * to ADC and materialize every carry with SETC, which serializes the two
+ * chains again and is slower than the portable code. The loop only uses
+ * LEA and JRCXZ, which preserve both flags. */
+
+/* r[j] := a[j] + s[j] * v for j < n, returning the carry word. r may be a
+ * or a - 1, to shift the row down by one word. */
+CC_INLINE
+cc_unit cczp_mm_adx_addmul1(cc_size n, cc_unit *r, const cc_unit *a, const cc_unit *s, cc_unit v)
+{
+    cc_unit hi_prev, lo, hi, acc;
+
+    __asm__("shr $1, %[n]\n\t"
+            "jnc 3f\n\t"
+            // Odd n: one word on its own, with both carries clear.
+            "xor %k[hi_prev], %k[hi_prev]\n\t"
+            "mulx (%[s]), %[lo], %[hi]\n\t"
+            "mov (%[a]), %[acc]\n\t"
+            "adcx %[lo], %[acc]\n\t"
+            "mov %[acc], (%[r])\n\t"
+            "mov %[hi], %[hi_prev]\n\t"
+            "lea 8(%[s]), %[s]\n\t"
+            "lea 8(%[a]), %[a]\n\t"
+            "lea 8(%[r]), %[r]\n\t"
+            "jmp 4f\n\t"
+            "3:\n\t"
+            "xor %k[hi_prev], %k[hi_prev]\n\t"
+            "4:\n\t"
+            "jrcxz 2f\n\t"
+            // Two words per iteration.
+            "1:\n\t"
+            "mulx (%[s]), %[lo], %[hi]\n\t"
+            "mov (%[a]), %[acc]\n\t"
+            "adcx %[lo], %[acc]\n\t"
+            "adox %[hi_prev], %[acc]\n\t"
+            "mov %[acc], (%[r])\n\t"
+            "mulx 8(%[s]), %[lo], %[hi_prev]\n\t"
+            "mov 8(%[a]), %[acc]\n\t"
+            "adcx %[lo], %[acc]\n\t"
+            "adox %[hi], %[acc]\n\t"
+            "mov %[acc], 8(%[r])\n\t"
+            "lea 16(%[s]), %[s]\n\t"
+            "lea 16(%[a]), %[a]\n\t"
+            "lea 16(%[r]), %[r]\n\t"
+            "lea -1(%[n]), %[n]\n\t"
+            "jrcxz 2f\n\t"
+            "jmp 1b\n\t"
+            "2:\n\t"
+            "mov $0, %k[lo]\n\t"
+            "adcx %[lo], %[hi_prev]\n\t"
+            "adox %[lo], %[hi_prev]\n\t"
+            : [hi_prev] "=&r"(hi_prev), [lo] "=&r"(lo), [hi] "=&r"(hi), [acc] "=&r"(acc),
+              [s] "+r"(s), [a] "+r"(a), [r] "+r"(r), [n] "+c"(n)
+            : "d"(v)
+            : "cc", "memory");
+
+    return hi_prev;
+}
+
+void cczp_mm_mul_adx(cczp_const_t zp, cc_unit *r, const cc_unit *x, const cc_unit *y, cc_unit *t)
+{
+    cc_size n = cczp_n(zp);
+    const cc_unit *p = cczp_prime(zp);
+    cc_unit p0inv = cczp_mm_p0inv(zp);
+    cc_unit c;
+
+    // t[-1] receives the low word cleared by each reduction.
+    ccn_zero(n + 3, t);
+    t++;
+
+    // CIOS: each round adds x * y[i], then m * p to clear the low word
+    // while shifting t down by one word. t < 2p between rounds.
+    for (cc_size i = 0; i < n; i++) {
+        c = cczp_mm_adx_addmul1(n, t, t, x, y[i]);
+        t[n] += c;
+        t[n + 1] = (t[n] < c);
+
+        c = cczp_mm_adx_addmul1(n, t - 1, t, p, t[0] * p0inv);
+        t[n - 1] = t[n] + c;
+        t[n] = t[n + 1] + (t[n - 1] < c);
+    }
+
+    c = t[n] ^ ccn_sub(n, r, t, p);
+    ccn_mux(n, c, r, t, r);
+}
+
+void cczp_mm_sqr_adx(cczp_const_t zp, cc_unit *r, const cc_unit *x, cc_unit *t)
+{
+    cc_size n = cczp_n(zp);
+    const cc_unit *p = cczp_prime(zp);
+    cc_unit p0inv = cczp_mm_p0inv(zp);
+    cc_unit c = 0;
+
+    ccn_zero(2 * n, t);
+
+    // The products x[i] * x[j] with i < j, once.
+    for (cc_size i = 0; i + 1 < n; i++) {
+        t[i + n] = cczp_mm_adx_addmul1(n - 1 - i, &t[2 * i + 1], &t[2 * i + 1], &x[i + 1], x[i]);
+    }
+
+    // Double them and add the squares x[i]^2.
+    for (cc_size i = 0; i < n; i++) {
+        cc_dunit sq = (cc_dunit)x[i] * x[i];
+        cc_dunit lo = ((cc_dunit)t[2 * i] << 1) + (cc_unit)sq + c;
+        cc_dunit hi = ((cc_dunit)t[2 * i + 1] << 1) + (cc_unit)(sq >> CCN_UNIT_BITS) + (cc_unit)(lo >> CCN_UNIT_BITS);
+        t[2 * i] = (cc_unit)lo;
+        t[2 * i + 1] = (cc_unit)hi;
+        c = (cc_unit)(hi >> CCN_UNIT_BITS);
+    }
+
+    // REDC, keeping the carry of round i in t[i] as cczp_mm_redc() does.
+    for (cc_size i = 0; i < n; i++) {
+        t[i] = cczp_mm_adx_addmul1(n, &t[i], &t[i], p, t[i] * p0inv);
+    }
+
+    c = ccn_add(n, &t[n], &t[n], t);
+    c ^= ccn_sub(n, t, &t[n], p);
+    ccn_mux(n, c, r, &t[n], t);
+}
+
+#endif /* CCZP_MM_ADX_ASM */